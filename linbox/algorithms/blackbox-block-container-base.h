@@ -74,6 +74,26 @@ public:
 		}
 	}
 
+	static void mul (const Field& F,
+			 Block &M1, const SparseMatrix<Field,SparseMatrixFormat::CSR> &M2, const Block& M3) {
+		M2.applyLeft(M1,M3);
+	}
+
+	static void mul (const Field& F,
+			 Block &M1, const SparseMatrix<Field,SparseMatrixFormat::ELL> &M2, const Block& M3) {
+		M2.applyLeft(M1,M3);
+	}
+
+	static void mul (const Field& F,
+			 Block &M1, const SparseMatrix<Field,SparseMatrixFormat::ELL_R> &M2, const Block& M3) {
+		M2.applyLeft(M1,M3);
+	}
+
+	static void mul (const Field& F,
+			 Block &M1, const SparseMatrix<Field,SparseMatrixFormat::COO> &M2, const Block& M3) {
+		M2.applyLeft(M1,M3);
+	}
+
 	static void mul (const Field& F,
 			 Block &M1, const SparseMatrix<Field,SparseMatrixFormat::TPL> &M2, const Block& M3) {
 		M2.applyLeft(M1,M3);
@@ -0,0 +1,570 @@
+/* linbox/algorithms/block-lanczos-gf2.h
+ * Copyright (C) 2016 the LinBox group
+ *
+ * ========LICENCE========
+ * This file is part of the library LinBox.
+ *
+ * LinBox is free software: you can redistribute it and/or modify
+ * it under the terms of the  GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ * ========LICENCE========
+ */
+
+/*! @file algorithms/block-lanczos-gf2.h
+ * @ingroup algorithms
+ * @brief Montgomery's block Lanczos over GF2, on bit-sliced blocks of 64 vectors.
+ *
+ * BlockLanczosSolver stores its \f$n\times N\f$ blocks as BlasMatrix, one
+ * word per entry even over GF2. Here a block of 64 vectors is one
+ * <code>uint64_t</code> per row: the sparse matrix (ZeroOne<GF2>) is
+ * applied to the 64 vectors at once with XORs, and the \f$64\times 64\f$
+ * products \f$V^TW\f$ and \f$VM\f$ go through tables indexed by the bytes
+ * of the words. This is the iteration of the factoring codes.
+ */
+
+#ifndef __LINBOX_block_lanczos_gf2_H
+#define __LINBOX_block_lanczos_gf2_H
+
+#include <algorithm>
+#include <random>
+#include <stdint.h>
+#include <vector>
+
+#include "linbox/field/gf2.h"
+#include "linbox/blackbox/zo-gf2.h"
+#include "linbox/matrix/densematrix/packed-gf2-matrix.h"
+#include "linbox/matrix/matrix-domain.h"
+#include "linbox/util/commentator.h"
+#include "linbox/util/thread-pool.h"
+
+namespace LinBox
+{
+
+	/** @brief Block Lanczos over GF2, 64 vectors per block.
+	 *
+	 * The symmetric iteration of [Montgomery '95] runs on
+	 * \f$B = A^TA\f$ from \f$V_0 = BY\f$, \f$Y\f$ random. When it
+	 * stops on \f$V_m^TBV_m = 0\f$, the combinations of the columns of
+	 * \f$[X-Y \mid V_m]\f$ that \f$A\f$ sends to zero are found by
+	 * elimination: they are (up to 64) vectors of the right nullspace
+	 * of \f$A\f$.
+	 *
+	 * The transpose of \f$A\f$ is stored, so that both products are
+	 * row by row and parallel; it doubles the memory for the matrix.
+	 * Small matrices (less than \c DENSE_THRESHOLD columns) are
+	 * eliminated densely by MatrixDomain<GF2>.
+	 * @bib [Montgomery '95]
+	 */
+	class GF2BlockLanczosSolver {
+	public:
+		typedef GF2                  Field;
+		typedef ZeroOne<GF2>         Blackbox;
+		typedef uint64_t             word_type;
+
+		static const size_t          N = 64;
+		static const size_t          DENSE_THRESHOLD = 512;
+
+		/** @brief Constructor.
+		 * @param F    GF2
+		 * @param seed seed of the random blocks
+		 */
+		GF2BlockLanczosSolver (const GF2 &F, uint64_t seed = 0) :
+			_field(&F), _gen(seed)
+		{}
+
+		/** Vectors of the right nullspace of \p A.
+		 * \p X gets <code>A.coldim()</code> rows and one column per
+		 * vector, linearly independent, at most 64.
+		 * @return the number of vectors.
+		 */
+		size_t sampleNullspace (const Blackbox &A, PackedGF2Matrix &X);
+
+		/** Solve the linear system \p A \p x = \p b.
+		 * A nullspace vector of <code>[A | b]</code> with last
+		 * coordinate 1 gives a random solution.
+		 * @return false if none was found: the system is
+		 * probably inconsistent.
+		 */
+		template <class Vector>
+		bool solve (const Blackbox &A, Vector &x, const Vector &b);
+
+		const Field &field () const { return *_field; }
+
+	private:
+		typedef std::vector<word_type> Block;   // n x 64, one word per row
+		typedef word_type Small[N];             // 64 x 64, one word per row
+
+		// One run: the nullspace vectors found, in Z (two words per
+		// row). false on breakdown.
+		bool iterate (const Blackbox &A, const Blackbox &At, Block &Z, size_t &iter);
+
+		// Y = A^T A X
+		static void applySym (const Blackbox &A, const Blackbox &At, Block &Y, const Block &X, Block &tmp)
+		{
+			A.applyBlock(tmp, X);
+			At.applyBlock(Y, tmp);
+		}
+
+		// C = V^T W, 64 x 64
+		static void innerProduct (Small &C, const Block &V, const Block &W);
+
+		// the byte tables of M: T[8k+b] is the sum of the rows of M
+		// in the bits of b, shifted by 8k.
+		static void tables (std::vector<word_type> &T, const Small &M);
+
+		static word_type tableMul (const std::vector<word_type> &T, word_type v)
+		{
+			word_type w = 0;
+			for (size_t k = 0 ; k < 8 ; ++k, v >>= 8)
+				w ^= T[256*k + (v & 0xff)];
+			return w;
+		}
+
+		// C = A B, 64 x 64
+		static void mul (Small &C, const Small &A, const Small &B);
+
+		// Winv = S (S^T T S)^{-1} S^T, where S contains the columns
+		// outside of the previous S (prevS). Returns S as a mask, 0
+		// on failure.
+		static word_type selectColumns (Small &Winv, const Small &T, word_type prevS);
+
+		// Right nullspace of U (n rows of w words, so 64w columns):
+		// on return, column j of U T is zero for the bits j of the
+		// returned mask. T is 64w rows of w words.
+		static std::vector<word_type> combine (std::vector<word_type> &T, const std::vector<word_type> &U, size_t w);
+
+		// Dense nullspace, for small matrices.
+		size_t denseNullspace (const Blackbox &A, PackedGF2Matrix &X) const;
+
+		// At, coldim x rowdim, gets the transpose of A.
+		static void transpose (Blackbox &At, const Blackbox &A);
+
+		const GF2           *_field;
+		std::mt19937_64      _gen;
+	};
+
+	inline size_t GF2BlockLanczosSolver::sampleNullspace (const Blackbox &A, PackedGF2Matrix &X)
+	{
+		commentator().start ("Block Lanczos over GF2", "GF2BlockLanczosSolver::sampleNullspace");
+		const size_t n = A.coldim();
+
+		if (n < DENSE_THRESHOLD) {
+			size_t k = denseNullspace(A, X);
+			commentator().stop ("done", "dense elimination", "GF2BlockLanczosSolver::sampleNullspace");
+			return k;
+		}
+
+		Blackbox At(field(), A.coldim(), A.rowdim());
+		transpose(At, A);
+
+		// two words per row: [X-Y | V_m] combined
+		Block Z;
+		size_t iter = 0;
+		bool done = false;
+		for (int tries = 0 ; tries < 3 && !done ; ++tries)
+			done = iterate(A, At, Z, iter);
+
+		commentator().report (Commentator::LEVEL_NORMAL, INTERNAL_DESCRIPTION)
+			<< "Block Lanczos: " << iter << " iterations" << (done ? "" : ", breakdown") << std::endl;
+
+		if (!done) {
+			X.resize(n, 0);
+			commentator().stop ("breakdown", NULL, "GF2BlockLanczosSolver::sampleNullspace");
+			return 0;
+		}
+
+		// Z holds up to 128 candidate vectors: keep an independent
+		// subset, whose image by A is checked to be zero.
+		std::vector<word_type> T;
+		std::vector<word_type> dep = combine(T, Z, 2);
+		std::vector<word_type> W(2*n);
+		for (size_t r = 0 ; r < n ; ++r) {
+			word_type w0 = 0, w1 = 0;
+			for (size_t i = 0 ; i < 2*N ; ++i)
+				if ((Z[2*r+i/N] >> (i%N)) & 1) {
+					w0 ^= T[2*i];
+					w1 ^= T[2*i+1];
+				}
+			// pivots of the elimination: independent columns
+			W[2*r]   = w0 & ~dep[0];
+			W[2*r+1] = w1 & ~dep[1];
+		}
+
+		std::vector<word_type> Wlo(n), Whi(n), Alo(A.rowdim()), Ahi(A.rowdim());
+		for (size_t r = 0 ; r < n ; ++r) {
+			Wlo[r] = W[2*r];
+			Whi[r] = W[2*r+1];
+		}
+		A.applyBlock(Alo, Wlo);
+		A.applyBlock(Ahi, Whi);
+		word_type bad[2] = { 0, 0 };
+		for (size_t i = 0 ; i < A.rowdim() ; ++i) {
+			bad[0] |= Alo[i];
+			bad[1] |= Ahi[i];
+		}
+
+		std::vector<size_t> cols;
+		for (size_t j = 0 ; j < 2*N && cols.size() < N ; ++j) {
+			if ((dep[j/N] >> (j%N)) & 1 || (bad[j/N] >> (j%N)) & 1)
+				continue;
+			cols.push_back(j);
+		}
+
+		X.resize(n, cols.size());
+		for (size_t r = 0 ; r < n ; ++r)
+			for (size_t k = 0 ; k < cols.size() ; ++k)
+				if ((W[2*r+cols[k]/N] >> (cols[k]%N)) & 1)
+					X.setEntry(r, k, true);
+
+		commentator().stop ("done", NULL, "GF2BlockLanczosSolver::sampleNullspace");
+		return cols.size();
+	}
+
+	template <class Vector>
+	inline bool GF2BlockLanczosSolver::solve (const Blackbox &A, Vector &x, const Vector &b)
+	{
+		const size_t n = A.coldim();
+		Blackbox Ab(field(), A.rowdim(), n+1);
+		for (size_t i = 0 ; i < A.rowdim() ; ++i) {
+			Ab[i] = A[i];
+			if (b[i])
+				Ab[i].push_back(n);
+		}
+
+		PackedGF2Matrix X(field());
+		size_t k = sampleNullspace(Ab, X);
+		for (size_t j = 0 ; j < k ; ++j)
+			if (X.getEntry(n, j)) {
+				for (size_t i = 0 ; i < n ; ++i)
+					x[i] = X.getEntry(i, j);
+				return true;
+			}
+		return false;
+	}
+
+	inline bool GF2BlockLanczosSolver::iterate (const Blackbox &A, const Blackbox &At, Block &Z, size_t &iter)
+	{
+		const size_t n = A.coldim();
+		Block Y(n), tmp(A.rowdim());
+		for (size_t r = 0 ; r < n ; ++r)
+			Y[r] = _gen();
+
+		Block V0(n), v0(n), v1(n, 0), v2(n, 0), AV(n), X(n, 0);
+		applySym(A, At, V0, Y, tmp);
+		v0 = V0;
+
+		Small vtav0, vta2v0, vtav1, vta2v1, winv0, winv1, winv2, d, e, f, f2, vtV0;
+		for (size_t i = 0 ; i < N ; ++i)
+			vtav1[i] = vta2v1[i] = winv1[i] = winv2[i] = 0;
+		word_type mask0, mask1 = ~word_type(0);
+
+		std::vector<word_type> Td, Te, Tf, Tx;
+		const size_t maxiter = n/(N-4) + 100;
+		bool terminated = false;
+		for (iter = 0 ; iter < maxiter ; ++iter) {
+			applySym(A, At, AV, v0, tmp);
+			innerProduct(vtav0, v0, AV);
+			innerProduct(vta2v0, AV, AV);
+
+			word_type any = 0;
+			for (size_t i = 0 ; i < N ; ++i)
+				any |= vtav0[i];
+			if (any == 0) {
+				terminated = true;
+				break;
+			}
+
+			mask0 = selectColumns(winv0, vtav0, mask1);
+			if (mask0 == 0)
+				return false;
+
+			// D = I - Winv_i (V_i^T B^2 V_i S_i S_i^T + V_i^T B V_i)
+			for (size_t i = 0 ; i < N ; ++i)
+				f2[i] = (vta2v0[i] & mask0) ^ vtav0[i];
+			mul(d, winv0, f2);
+			for (size_t i = 0 ; i < N ; ++i)
+				d[i] ^= word_type(1) << i;
+
+			// E = - Winv_{i-1} V_i^T B V_i S_i S_i^T
+			for (size_t i = 0 ; i < N ; ++i)
+				f2[i] = vtav0[i] & mask0;
+			mul(e, winv1, f2);
+
+			// F = - Winv_{i-2} (I - V_{i-1}^T B V_{i-1} Winv_{i-1})
+			//     (V_{i-1}^T B^2 V_{i-1} S_{i-1} S_{i-1}^T + V_{i-1}^T B V_{i-1}) S_i S_i^T
+			mul(f, vtav1, winv1);
+			for (size_t i = 0 ; i < N ; ++i) {
+				f[i] ^= word_type(1) << i;
+				f2[i] = ((vta2v1[i] & mask1) ^ vtav1[i]) & mask0;
+			}
+			Small g;
+			mul(g, f, f2);
+			mul(f, winv2, g);
+
+			// X += V_i Winv_i V_i^T V_0
+			innerProduct(g, v0, V0);
+			mul(vtV0, winv0, g);
+
+			// V_{i+1} = B V_i S_i S_i^T + V_i D + V_{i-1} E + V_{i-2} F
+			tables(Td, d);
+			tables(Te, e);
+			tables(Tf, f);
+			tables(Tx, vtV0);
+			const size_t chunks = std::min(n, 4*threadPool().size());
+			threadPool().parallelFor(0, chunks, [&](size_t t) {
+				for (size_t r = t*n/chunks ; r < (t+1)*n/chunks ; ++r) {
+					X[r] ^= tableMul(Tx, v0[r]);
+					AV[r] = (AV[r] & mask0) ^ tableMul(Td, v0[r])
+						^ tableMul(Te, v1[r]) ^ tableMul(Tf, v2[r]);
+				}
+			});
+
+			v2.swap(v1);
+			v1.swap(v0);
+			v0.swap(AV);
+			std::copy(winv1, winv1+N, winv2);
+			std::copy(winv0, winv0+N, winv1);
+			std::copy(vtav0, vtav0+N, vtav1);
+			std::copy(vta2v0, vta2v0+N, vta2v1);
+			mask1 = mask0;
+		}
+		if (!terminated)
+			return false;
+
+		// Z = [X - Y | V_m], and A Z
+		Block AX(A.rowdim()), AVm(A.rowdim());
+		for (size_t r = 0 ; r < n ; ++r)
+			X[r] ^= Y[r];
+		A.applyBlock(AX, X);
+		A.applyBlock(AVm, v0);
+		std::vector<word_type> U(2*A.rowdim());
+		for (size_t i = 0 ; i < A.rowdim() ; ++i) {
+			U[2*i]   = AX[i];
+			U[2*i+1] = AVm[i];
+		}
+
+		// the combinations of [X-Y | V_m] in the kernel of A
+		std::vector<word_type> T;
+		std::vector<word_type> live = combine(T, U, 2);
+		Z.assign(2*n, 0);
+		for (size_t r = 0 ; r < n ; ++r) {
+			word_type z0 = 0, z1 = 0;
+			for (size_t i = 0 ; i < N ; ++i) {
+				if ((X[r] >> i) & 1) {
+					z0 ^= T[2*i];
+					z1 ^= T[2*i+1];
+				}
+				if ((v0[r] >> i) & 1) {
+					z0 ^= T[2*(N+i)];
+					z1 ^= T[2*(N+i)+1];
+				}
+			}
+			Z[2*r]   = z0 & live[0];
+			Z[2*r+1] = z1 & live[1];
+		}
+		return true;
+	}
+
+	inline void GF2BlockLanczosSolver::innerProduct (Small &C, const Block &V, const Block &W)
+	{
+		const size_t n = V.size();
+		const size_t chunks = std::max(size_t(1), std::min(n/1024, 4*threadPool().size()));
+		// tables of 8 x 256 words: c[256k + b] is the sum of the W[r]
+		// for which byte k of V[r] is b.
+		std::vector<std::vector<word_type> > c(chunks, std::vector<word_type>(8*256, 0));
+		threadPool().parallelFor(0, chunks, [&](size_t t) {
+			std::vector<word_type> &ct = c[t];
+			for (size_t r = t*n/chunks ; r < (t+1)*n/chunks ; ++r) {
+				word_type v = V[r], w = W[r];
+				for (size_t k = 0 ; k < 8 ; ++k, v >>= 8)
+					ct[256*k + (v & 0xff)] ^= w;
+			}
+		});
+		for (size_t t = 1 ; t < chunks ; ++t)
+			for (size_t l = 0 ; l < 8*256 ; ++l)
+				c[0][l] ^= c[t][l];
+
+		for (size_t k = 0 ; k < 8 ; ++k)
+			for (size_t b = 0 ; b < 8 ; ++b) {
+				word_type s = 0;
+				for (size_t l = 1 ; l < 256 ; ++l)
+					if ((l >> b) & 1)
+						s ^= c[0][256*k + l];
+				C[8*k+b] = s;
+			}
+	}
+
+	inline void GF2BlockLanczosSolver::tables (std::vector<word_type> &T, const Small &M)
+	{
+		T.resize(8*256);
+		for (size_t k = 0 ; k < 8 ; ++k) {
+			word_type *Tk = &T[256*k];
+			Tk[0] = 0;
+			for (size_t b = 0 ; b < 8 ; ++b)
+				for (size_t l = 0 ; l < (size_t(1) << b) ; ++l)
+					Tk[(size_t(1) << b) + l] = Tk[l] ^ M[8*k+b];
+		}
+	}
+
+	inline void GF2BlockLanczosSolver::mul (Small &C, const Small &A, const Small &B)
+	{
+		std::vector<word_type> T;
+		tables(T, B);
+		for (size_t i = 0 ; i < N ; ++i)
+			C[i] = tableMul(T, A[i]);
+	}
+
+	inline GF2BlockLanczosSolver::word_type
+	GF2BlockLanczosSolver::selectColumns (Small &Winv, const Small &T, word_type prevS)
+	{
+		// M = [T | I], one row of two words per row of T
+		word_type M[N][2];
+		for (size_t i = 0 ; i < N ; ++i) {
+			M[i][0] = T[i];
+			M[i][1] = word_type(1) << i;
+		}
+
+		// the columns outside of the previous S first
+		size_t c[N], l = 0;
+		for (size_t j = 0 ; j < N ; ++j)
+			if (!((prevS >> j) & 1))
+				c[l++] = j;
+		for (size_t j = 0 ; j < N ; ++j)
+			if ((prevS >> j) & 1)
+				c[l++] = j;
+
+		word_type S = 0;
+		for (size_t j = 0 ; j < N ; ++j) {
+			const size_t cj = c[j];
+			for (size_t k = j ; k < N ; ++k)
+				if ((M[c[k]][0] >> cj) & 1) {
+					std::swap(M[c[k]][0], M[cj][0]);
+					std::swap(M[c[k]][1], M[cj][1]);
+					break;
+				}
+
+			if ((M[cj][0] >> cj) & 1) {
+				S |= word_type(1) << cj;
+				for (size_t k = 0 ; k < N ; ++k)
+					if (k != j && ((M[c[k]][0] >> cj) & 1)) {
+						M[c[k]][0] ^= M[cj][0];
+						M[c[k]][1] ^= M[cj][1];
+					}
+			}
+			else {
+				for (size_t k = j ; k < N ; ++k)
+					if ((M[c[k]][1] >> cj) & 1) {
+						std::swap(M[c[k]][0], M[cj][0]);
+						std::swap(M[c[k]][1], M[cj][1]);
+						break;
+					}
+				if (!((M[cj][1] >> cj) & 1))
+					return 0;
+				for (size_t k = 0 ; k < N ; ++k)
+					if (k != j && ((M[c[k]][1] >> cj) & 1)) {
+						M[c[k]][0] ^= M[cj][0];
+						M[c[k]][1] ^= M[cj][1];
+					}
+				M[cj][0] = M[cj][1] = 0;
+			}
+		}
+
+		// S must contain all the columns outside of the previous one
+		if (~prevS & ~S)
+			return 0;
+		for (size_t i = 0 ; i < N ; ++i)
+			Winv[i] = M[i][1];
+		return S;
+	}
+
+	inline std::vector<GF2BlockLanczosSolver::word_type>
+	GF2BlockLanczosSolver::combine (std::vector<word_type> &T, const std::vector<word_type> &U, size_t w)
+	{
+		// T = I: row i of T tells which columns of U T contain
+		// column i of U. Rows of U T are computed as the rows of U
+		// arrive, and each nonzero one kills a column.
+		const size_t cols = N*w;
+		T.assign(cols*w, 0);
+		for (size_t i = 0 ; i < cols ; ++i)
+			T[w*i + i/N] = word_type(1) << (i%N);
+		std::vector<word_type> live(w, ~word_type(0)), v(w), flip(w);
+
+		for (size_t r = 0 ; r < U.size()/w ; ++r) {
+			std::fill(v.begin(), v.end(), word_type(0));
+			for (size_t i = 0 ; i < cols ; ++i)
+				if ((U[w*r + i/N] >> (i%N)) & 1)
+					for (size_t l = 0 ; l < w ; ++l)
+						v[l] ^= T[w*i + l];
+			size_t p = cols;
+			for (size_t l = 0 ; l < w ; ++l) {
+				v[l] &= live[l];
+				if (p == cols && v[l])
+					p = N*l + __builtin_ctzll(v[l]);
+			}
+			if (p == cols)
+				continue;
+
+			// column j += column p, for the other columns of v
+			flip = v;
+			flip[p/N] &= ~(word_type(1) << (p%N));
+			for (size_t i = 0 ; i < cols ; ++i)
+				if ((T[w*i + p/N] >> (p%N)) & 1)
+					for (size_t l = 0 ; l < w ; ++l)
+						T[w*i + l] ^= flip[l];
+			live[p/N] &= ~(word_type(1) << (p%N));
+		}
+		return live;
+	}
+
+	inline size_t GF2BlockLanczosSolver::denseNullspace (const Blackbox &A, PackedGF2Matrix &X) const
+	{
+		PackedGF2Matrix P(field(), A.rowdim(), A.coldim());
+		for (size_t i = 0 ; i < A.rowdim() ; ++i)
+			for (Blackbox::Row_t::const_iterator j = A[i].begin() ; j != A[i].end() ; ++j)
+				P.setEntry(i, *j, !P.getEntry(i, *j));
+
+		MatrixDomain<GF2> MD(field());
+		PackedGF2Matrix K(field());
+		size_t k = std::min(MD.nullspaceBasisIn(K, P), N);
+		X.resize(A.coldim(), k);
+		for (size_t i = 0 ; i < A.coldim() ; ++i)
+			for (size_t j = 0 ; j < k ; ++j)
+				X.setEntry(i, j, K.getEntry(i, j));
+		return k;
+	}
+
+	inline void GF2BlockLanczosSolver::transpose (Blackbox &At, const Blackbox &A)
+	{
+		std::vector<size_t> count(A.coldim(), 0);
+		for (size_t i = 0 ; i < A.rowdim() ; ++i)
+			for (Blackbox::Row_t::const_iterator j = A[i].begin() ; j != A[i].end() ; ++j)
+				++count[*j];
+		for (size_t j = 0 ; j < A.coldim() ; ++j)
+			if (count[j] > 2)
+				At[j].reserve(count[j]);
+		for (size_t i = 0 ; i < A.rowdim() ; ++i)
+			for (Blackbox::Row_t::const_iterator j = A[i].begin() ; j != A[i].end() ; ++j)
+				At[*j].push_back(i);
+	}
+
+}
+
+#endif // __LINBOX_block_lanczos_gf2_H
+
+// vim:sts=8:sw=8:ts=8:noet:sr:cino=>s,f0,{0,g0,(0,:0,t0,+0,=s
+// Local Variables:
+// mode: C++
+// tab-width: 8
+// indent-tabs-mode: nil
+// c-basic-offset: 8
+// End:
@@ -60,6 +60,8 @@ namespace LinBox
 	 *
 	 * Currently, only dense vectors are supported for this iteration, and it is
 	 * unlikely any other vector archetypes will be supported in the future.
+	 * Over GF2, GF2BlockLanczosSolver (block-lanczos-gf2.h) packs the
+	 * blocks 64 vectors per word.
 	 * @bib [Montgomery '95]
 	 */
 	template <class Field, class Matrix = BlasMatrix<typename Field::Element> >
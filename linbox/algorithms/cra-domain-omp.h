@@ -1,9 +1,10 @@
 /* linbox/algorithms/cra-domain-omp.h
  * Copyright (C) 1999-2010 The LinBox group
  *
- * Naive parallel chinese remaindering
- * Launch NN iterations in parallel, where NN=omp_get_max_threads()
- * Then synchronization and termintation test.
+ * Parallel chinese remaindering
+ * Workers of the thread pool pull primes and compute residues
+ * continuously, the calling thread folds them in order and tests
+ * termination.
  * Time-stamp: <13 Mar 12 13:49:58 Jean-Guillaume.Dumas@imag.fr>
  *
  * ========LICENCE========
@@ -26,21 +27,41 @@
  */
 
 /*! @file algorithms/cra-domain-omp.h
- * @brief Parallel (OMP) version of \ref CRA
+ * @brief Parallel version of \ref CRA
  * @ingroup CRA
  */
 
 #ifndef __LINBOX_omp_cra_H
 #define __LINBOX_omp_cra_H
-// commentator is not thread safe
-#define DISABLE_COMMENTATOR
-#include <omp.h>
 #include <set>
+#include <map>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <exception>
 #include "linbox/algorithms/cra-domain-seq.h"
+#include "linbox/util/thread-pool.h"
 
 namespace LinBox
 {
 
+	/*! Parallel \ref CRA driver.
+	 * @ingroup CRA
+	 *
+	 * The tasks of the library thread pool (see threadPool()) take the
+	 * next prime from \p primeiter and run \p Iteration on it as soon as
+	 * they are done with the previous one. A task never waits: it ends
+	 * when too many residues are ahead of the folding, and new tasks are
+	 * submitted as residues get folded, so nested CRAs do not hold
+	 * workers. The calling thread folds the residues into the \p CRABase
+	 * builder in the order the primes were taken, tests termination after
+	 * each of them, and computes residues or runs pool tasks itself when
+	 * the next one to fold is not ready. The primes folded are thus
+	 * exactly the ones ChineseRemainderSeq would use, and so is the
+	 * result ; at most one residue per thread is computed in vain.
+	 *
+	 * \p Iteration is called concurrently and must be thread safe.
+	 */
 	template<class CRABase>
 	struct ChineseRemainderOMP : public ChineseRemainderSeq<CRABase> {
 		typedef typename CRABase::Domain	Domain;
@@ -59,193 +80,173 @@ namespace LinBox
 		template<class Function, class PrimeIterator>
 		Integer& operator() (Integer& res, Function& Iteration, PrimeIterator& primeiter)
 		{
-			//! @bug why why why ???
-			/** erreur: ‘omp_get_max_threads’ has not been declared
-			 * ../linbox/algorithms/cra-domain-omp.h:152:16: note: suggested alternative:
-			 * /usr/lib/gcc/x86_64-linux-gnu/4.6/include/omp.h:64:12: note:   ‘Givaro::omp_get_max_threads’
-			 */
-			size_t NN = omp_get_max_threads();
-			//std::cerr << "Blocs: " << NN << " iterations." << std::endl;
-			// commentator().start ("Parallel OMP Givaro::Modular iteration", "mmcrait");
-			if (NN == 1) return Father_t::operator()(res,Iteration,primeiter);
-
-			int coprime =0;
-			int maxnoncoprime = 1000;
+			if (threadPool().size() == 1)
+				return Father_t::operator()(res,Iteration,primeiter);
+			return dynamicCRA<ScalarSlot<Function> >(res,Iteration,primeiter);
+		}
 
-			if (this->IterCounter==0) {
-				std::set<Integer> coprimeset;
-				while(coprimeset.size() < NN) {
-					++primeiter;
-					while(this->Builder_.noncoprime(*primeiter) ) {
-						++primeiter;
-						++coprime;
-						if (coprime > maxnoncoprime) {
-							std::cout << "you are running out of primes. " << maxnoncoprime << " coprime primes found";
-							return this->Builder_.result(res);
-						}
-					}
-					coprime =0;
-					coprimeset.insert(*primeiter);
-				}
-				std::vector<Domain> ROUNDdomains; ROUNDdomains.reserve(NN);
-				std::vector<DomainElement> ROUNDresidues(NN);
-				typename std::vector<DomainElement>::iterator resit=ROUNDresidues.begin();
-				for(std::set<Integer>::const_iterator coprimesetiter = coprimeset.begin(); coprimesetiter != coprimeset.end(); ++coprimesetiter,++resit) {
-					// std::cerr << "With prime: " << *coprimesetiter << std::endl;
-					ROUNDdomains.push_back( Domain(*coprimesetiter) );
-					ROUNDdomains.back().init( *resit );
-				}
+		template<class Container, class Function, class PrimeIterator>
+		Container& operator() (Container& res, Function& Iteration, PrimeIterator& primeiter)
+		{
+			if (threadPool().size() == 1)
+				return Father_t::operator()(res,Iteration,primeiter);
+			return dynamicCRA<VectorSlot<Function> >(res,Iteration,primeiter);
+		}
 
-#pragma omp parallel for
-				for(size_t i=0;i<NN;++i) {
-					Iteration(ROUNDresidues[i], ROUNDdomains[i]);
-				}
-#pragma omp barrier
-				++this->IterCounter;
-				this->Builder_.initialize( ROUNDdomains[0],ROUNDresidues[0]);
-				for(size_t i=1;i<NN;++i) {
-					++this->IterCounter;
-					this->Builder_.progress( ROUNDdomains[i],ROUNDresidues[i]);
-				}
-				// commentator().report(Commentator::LEVEL_IMPORTANT, INTERNAL_DESCRIPTION) << "With prime " << *primeiter << std::endl;
+	protected:
+		//! a prime, its domain and the residue computed there.
+		template<class Function>
+		struct ScalarSlot {
+			Integer       prime ;
+			Domain        D ;
+			DomainElement r ;
+			ScalarSlot(const Integer& p) :
+				prime(p), D(p)
+			{
+				D.init(r);
 			}
+		};
 
-			while( ! this->Builder_.terminated() ) {
-				//std::cerr << "Computed: " << this->IterCounter << " primes." << std::endl;
-				std::set<Integer> coprimeset;
-				while(coprimeset.size() < NN) {
-					++primeiter;
-					while(this->Builder_.noncoprime(*primeiter) ) {
-						++primeiter;
-						++coprime;
-						if (coprime > maxnoncoprime) {
-							std::cout << "you are running out of primes. " << maxnoncoprime << " coprime primes found";
-							return this->Builder_.result(res);
-						}
-					}
-					coprime =0;
-					coprimeset.insert(*primeiter);
-				}
-				std::vector<Domain> ROUNDdomains; ROUNDdomains.reserve(NN);
-				std::vector<DomainElement> ROUNDresidues(NN);
-				typename std::vector<DomainElement>::iterator resit=ROUNDresidues.begin();
-				for(std::set<Integer>::const_iterator coprimesetiter = coprimeset.begin(); coprimesetiter != coprimeset.end(); ++coprimesetiter,++resit) {
-					// std::cerr << "With prime: " << *coprimesetiter << std::endl;
-					ROUNDdomains.push_back( Domain(*coprimesetiter) );
-					ROUNDdomains.back().init( *resit );
-				}
+		template<class Function>
+		struct VectorSlot {
+			typedef typename CRATemporaryVectorTrait<Function, Domain>::Type_t Residue ;
+			Integer prime ;
+			Domain  D ;
+			Residue r ;
+			VectorSlot(const Integer& p) :
+				prime(p), D(p), r(D)
+			{}
+		};
 
-#pragma omp parallel for
-				for(size_t i=0;i<NN;++i) {
-					Iteration(ROUNDresidues[i], ROUNDdomains[i]);
-				}
-#pragma omp barrier
-				for(size_t i=0;i<NN;++i) {
-					++this->IterCounter;
-					this->Builder_.progress( ROUNDdomains[i],ROUNDresidues[i]);
-				}
-			}
-			// commentator().stop ("done", NULL, "mmcrait");
-			//std::cerr << "Used: " << this->IterCounter << " primes." << std::endl;
-			return this->Builder_.result(res);
-		}
-
-		template<class Container, class Function, class PrimeIterator>
-		Container& operator() (Container& res, Function& Iteration, PrimeIterator& primeiter)
+		template<class Slot, class Result, class Function, class PrimeIterator>
+		Result& dynamicCRA(Result& res, Function& Iteration, PrimeIterator& primeiter)
 		{
-			typedef typename CRATemporaryVectorTrait<Function, DomainElement>::Type_t ElementContainer;
-			size_t NN = omp_get_max_threads();
-			//std::cerr << "Blocs: " << NN << " iterations." << std::endl;
-			// commentator().start ("Parallel OMP Givaro::Modular iteration", "mmcrait");
-			if (NN == 1) return Father_t::operator()(res,Iteration,primeiter);
+			ThreadPool & pool = threadPool();
+			const size_t NN = pool.size();
+			// residues computed ahead of the first one not yet folded.
+			const size_t window = 4*NN;
+			const int maxnoncoprime = 1000;
 
-			int coprime =0;
-			int maxnoncoprime = 1000;
+			std::mutex lock ;
+			std::condition_variable cond ;
+			size_t issued = 0, folded = 0, active = 0 ;
+			bool stop = false, exhausted = false ;
+			std::exception_ptr error ;
+			std::set<Integer> used ;
+			std::map<size_t, Slot*> done ;
 
-			if (this->IterCounter==0) {
-				std::set<Integer> coprimeset;
-				while(coprimeset.size() < NN) {
+			// next prime, never twice the same ; called with lock held.
+			auto next = [&](Integer& p, size_t& s) -> bool {
+				if (stop || exhausted || issued >= folded+window)
+					return false;
+				int coprime = 0;
+				while (used.count(*primeiter)) {
 					++primeiter;
-					while(this->Builder_.noncoprime(*primeiter) ) {
-						++primeiter;
-						++coprime;
-						if (coprime > maxnoncoprime) {
-							std::cout << "you are running out of primes. " << maxnoncoprime << " coprime primes found";
-							return this->Builder_.result(res);
-						}
+					if (++coprime > maxnoncoprime) {
+						commentator().report(Commentator::LEVEL_ALWAYS,INTERNAL_ERROR) << "you are running out of primes. " << used.size() << " used and " << maxnoncoprime << " coprime primes tried for a new one.";
+						exhausted = true;
+						return false;
 					}
-					coprime =0;
-					coprimeset.insert(*primeiter);
-				}
-				std::vector<Domain> ROUNDdomains; ROUNDdomains.reserve(NN);
-				std::vector<ElementContainer> ROUNDresidues(NN);
-				typename std::vector<ElementContainer>::iterator resit=ROUNDresidues.begin();
-				for(std::set<Integer>::const_iterator coprimesetiter = coprimeset.begin(); coprimesetiter != coprimeset.end(); ++coprimesetiter,++resit) {
-					// std::cerr << "With prime: " << *coprimesetiter << std::endl;
-					ROUNDdomains.push_back( Domain(*coprimesetiter) );
-					//                     for(typename ElementContainer::iterator reselit = resit->begin();
-					//                         reselit != resit->end(); ++reselit)
-					//                         ROUNDdomains.back().init( *reselit );
 				}
+				p = *primeiter;
+				used.insert(p);
+				++primeiter;
+				s = issued++;
+				return true;
+			};
 
-#pragma omp parallel for
-				for(size_t i=0;i<NN;++i) {
-					Iteration(ROUNDresidues[i], ROUNDdomains[i]);
+			auto compute = [&](const Integer& p, size_t s) {
+				Slot * S = new Slot(p);
+				try {
+					Iteration(S->r, S->D);
 				}
-#pragma omp barrier
-				++this->IterCounter;
-				this->Builder_.initialize( ROUNDdomains[0],ROUNDresidues[0]);
-				for(size_t i=1;i<NN;++i) {
-					++this->IterCounter;
-					this->Builder_.progress( ROUNDdomains[i],ROUNDresidues[i]);
+				catch (...) {
+					delete S;
+					std::lock_guard<std::mutex> guard(lock);
+					if (!error) error = std::current_exception();
+					stop = true;
+					cond.notify_all();
+					return;
 				}
-				// commentator().report(Commentator::LEVEL_IMPORTANT, INTERNAL_DESCRIPTION) << "With prime " << *primeiter << std::endl;
-			}
+				std::lock_guard<std::mutex> guard(lock);
+				done[s] = S;
+				cond.notify_all();
+			};
 
-			while( ! this->Builder_.terminated() ) {
-				//std::cerr << "Computed: " << this->IterCounter << " primes." << std::endl;
-				std::set<Integer> coprimeset;
-				while(coprimeset.size() < NN) {
-					++primeiter;
-					while(this->Builder_.noncoprime(*primeiter) ) {
-						++primeiter;
-						++coprime;
-						if (coprime > maxnoncoprime) {
-							std::cout << "you are running out of primes. " << maxnoncoprime << " coprime primes found";
-							return this->Builder_.result(res);
-						}
-					}
-					coprime =0;
-					coprimeset.insert(*primeiter);
+			// computes residues until the window is full, then ends.
+			auto worker = [&]() {
+				std::unique_lock<std::mutex> guard(lock);
+				Integer p; size_t s;
+				while (next(p,s)) {
+					guard.unlock();
+					compute(p,s);
+					guard.lock();
 				}
-				std::vector<Domain> ROUNDdomains; ROUNDdomains.reserve(NN);
-				std::vector<ElementContainer> ROUNDresidues(NN);
-				typename std::vector<ElementContainer>::iterator resit=ROUNDresidues.begin();
-				for(std::set<Integer>::const_iterator coprimesetiter = coprimeset.begin(); coprimesetiter != coprimeset.end(); ++coprimesetiter,++resit) {
-					// std::cerr << "With prime: " << *coprimesetiter << std::endl;
-					ROUNDdomains.push_back( Domain(*coprimesetiter) );
-					//                     for(typename ElementContainer::iterator reselit = resit->begin();
-					//                         reselit != resit->end(); ++reselit)
-					//                         ROUNDdomains.back().init( *reselit );
+				--active;
+			};
+
+			// one task per other thread, as long as there are primes to
+			// take ; called with lock held.
+			ThreadPool::TaskGroup G;
+			auto spawn = [&]() {
+				while (active+1 < NN && !stop && !exhausted && issued+active < folded+window) {
+					++active;
+					pool.run(G, worker);
 				}
+			};
 
-#pragma omp parallel for
-				for(size_t i=0;i<NN;++i) {
-					Iteration(ROUNDresidues[i], ROUNDdomains[i]);
+			std::unique_lock<std::mutex> guard(lock);
+			spawn();
+			for (;;) {
+				typename std::map<size_t, Slot*>::iterator it = done.find(folded);
+				if (it != done.end()) {
+					Slot * S = it->second;
+					done.erase(it);
+					guard.unlock();
+					if (this->IterCounter == 0) {
+						++this->IterCounter;
+						this->Builder_.initialize(S->D, S->r);
+					}
+					else if (! this->Builder_.noncoprime(S->prime)) {
+						++this->IterCounter;
+						this->Builder_.progress(S->D, S->r);
+					}
+					delete S;
+					bool term = this->Builder_.terminated();
+					guard.lock();
+					++folded;
+					if (term)
+						break;
+					spawn();
+					continue;
 				}
-#pragma omp barrier
-				for(size_t i=0;i<NN;++i) {
-					++this->IterCounter;
-					this->Builder_.progress( ROUNDdomains[i],ROUNDresidues[i]);
+				if (error || ((stop || exhausted) && folded == issued))
+					break;
+				Integer p; size_t s;
+				if (next(p,s)) {
+					guard.unlock();
+					compute(p,s);
+					guard.lock();
+					continue;
 				}
+				// the residue to fold is being computed by a task
+				guard.unlock();
+				bool ran = pool.runPending();
+				guard.lock();
+				if (!ran && !error && done.find(folded) == done.end())
+					cond.wait_for(guard, std::chrono::microseconds(200));
 			}
-			// commentator().stop ("done", NULL, "mmcrait");
-			//std::cerr << "Used: " << this->IterCounter << " primes." << std::endl;
-			return this->Builder_.result(res);
-		}
-
+			stop = true;
+			guard.unlock();
 
+			pool.wait(G);
+			for (typename std::map<size_t, Slot*>::iterator it = done.begin() ; it != done.end() ; ++it)
+				delete it->second;
+			if (error)
+				std::rethrow_exception(error);
 
+			return this->Builder_.result(res);
+		}
 	};
 }
 
@@ -258,4 +259,3 @@ namespace LinBox
 // indent-tabs-mode: nil
 // c-basic-offset: 8
 // End:
-
@@ -0,0 +1,177 @@
+/* linbox/algorithms/cra-full-multip-batch.h
+ * Copyright (C) 2016 the LinBox group
+ *
+ * ========LICENCE========
+ * This file is part of the library LinBox.
+ *
+ * LinBox is free software: you can redistribute it and/or modify
+ * it under the terms of the  GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ * ========LICENCE========
+ */
+
+/*!@file algorithms/cra-full-multip-batch.h
+ * @ingroup algorithms
+ * @ingroup CRA
+ * @brief Chinese remaindering of vectors, in one batch at the end.
+ */
+
+#ifndef __LINBOX_cra_full_multip_batch_H
+#define __LINBOX_cra_full_multip_batch_H
+
+#include <vector>
+#include "linbox/integer.h"
+#include "linbox/algorithms/crt-subproduct-tree.h"
+
+namespace LinBox
+{
+
+	/*! @ingroup CRA
+	 * @brief Chinese Remaindering Algorithm for multiple residues, reconstructed in one batch.
+	 *
+	 * Same interface as FullMultipCRA, but the residues are only stored by
+	 * \c progress. \c result reconstructs all of them at once with a
+	 * CRTSubproductTree shared by the entries of the vector: this is
+	 * quasi-linear in the size of the result, against quadratic for the
+	 * prime by prime combinations of FullMultipCRA. It is the builder of
+	 * choice when the bound is known and requires thousands of primes.
+	 */
+	template<class Domain_Type>
+	struct FullMultipBatchCRA {
+		typedef Domain_Type			Domain;
+		typedef typename Domain::Element	DomainElement;
+		typedef FullMultipBatchCRA<Domain>	Self_t;
+
+	protected:
+		std::vector< Integer >			Primes_;
+		std::vector< std::vector<Integer> >	Residues_;  // Residues_[j][i] is entry i modulo prime j
+		CRTSubproductTree			Tree_;
+		size_t					TreeSize_;  // number of primes in Tree_
+		const double				LOGARITHMIC_UPPER_BOUND;
+		double					totalsize;
+
+	public:
+		// LOGARITHMIC_UPPER_BOUND is the natural logarithm
+		// of an upper bound on the resulting integers
+		FullMultipBatchCRA(const double b=0.0) :
+			TreeSize_(0), LOGARITHMIC_UPPER_BOUND(b), totalsize(0.0)
+		{}
+
+		Integer& getModulus(Integer& m)
+		{
+			return m = tree().modulus();
+		}
+
+		template<class Vect>
+		Vect& getResidue(Vect& r)
+		{
+			return result(r);
+		}
+
+		//! init
+		template<class Vect>
+		void initialize (const Integer& D, const Vect& e)
+		{
+			clear();
+			progress(D, e);
+		}
+
+		template<class Vect>
+		void initialize (const Domain& D, const Vect& e)
+		{
+			clear();
+			progress(D, e);
+		}
+
+		//! progress
+		/* Used in the case where D is a big Integer and Domain cannot be constructed */
+		template<class Vect>
+		void progress (const Integer& D, const Vect& e)
+		{
+			Primes_.push_back(D);
+			Residues_.push_back(std::vector<Integer>(e.size()));
+			std::vector<Integer>::iterator r_it = Residues_.back().begin();
+			for (typename Vect::const_iterator e_it = e.begin(); e_it != e.end(); ++e_it, ++r_it)
+				Integer::mod(*r_it, *e_it, D);
+			totalsize += Givaro::naturallog(D);
+		}
+
+		template<class Vect>
+		void progress (const Domain& D, const Vect& e)
+		{
+			Integer p; D.characteristic(p);
+			Primes_.push_back(p);
+			Residues_.push_back(std::vector<Integer>(e.size()));
+			std::vector<Integer>::iterator r_it = Residues_.back().begin();
+			for (typename Vect::const_iterator e_it = e.begin(); e_it != e.end(); ++e_it, ++r_it)
+				D.convert(*r_it, *e_it);
+			totalsize += Givaro::naturallog(p);
+		}
+
+		//! result, in the symmetric range
+		template<class Vect>
+		Vect& result (Vect &d)
+		{
+			const size_t n = Residues_.front().size();
+			std::vector<Integer> r;
+			tree().reconstruct(r, Residues_, n);
+			d.resize(n);
+			for (size_t i = 0 ; i < n ; ++i)
+				d[i] = Tree_.symmetric(r[i]);
+			return d;
+		}
+
+		bool terminated()
+		{
+			return totalsize > LOGARITHMIC_UPPER_BOUND;
+		}
+
+		bool noncoprime(const Integer& i) const
+		{
+			Integer g;
+			for (std::vector<Integer>::const_iterator p = Primes_.begin(); p != Primes_.end(); ++p)
+				if (gcd(g, i, *p) != 1) return true;
+			return false;
+		}
+
+	protected:
+		void clear()
+		{
+			Primes_.clear();
+			Residues_.clear();
+			TreeSize_ = 0;
+			totalsize = 0.0;
+		}
+
+		//! the tree is built again only if primes were added.
+		const CRTSubproductTree& tree()
+		{
+			if (TreeSize_ != Primes_.size()) {
+				Tree_.build(Primes_);
+				TreeSize_ = Primes_.size();
+			}
+			return Tree_;
+		}
+	};
+
+}
+
+#endif //__LINBOX_cra_full_multip_batch_H
+
+// Local Variables:
+// mode: C++
+// tab-width: 8
+// indent-tabs-mode: nil
+// c-basic-offset: 8
+// End:
+// vim:sts=8:sw=8:ts=8:noet:sr:cino=>s,f0,{0,g0,(0,\:0,t0,+0,=s
@@ -0,0 +1,231 @@
+/* linbox/algorithms/crt-subproduct-tree.h
+ * Copyright (C) 2016 the LinBox group
+ *
+ * ========LICENCE========
+ * This file is part of the library LinBox.
+ *
+ * LinBox is free software: you can redistribute it and/or modify
+ * it under the terms of the  GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ * ========LICENCE========
+ */
+
+/*! @file algorithms/crt-subproduct-tree.h
+ * @ingroup algorithms
+ * @ingroup CRA
+ * @brief Chinese remaindering of many residues at once with a subproduct tree.
+ *
+ * With \c k moduli \c m_j of product \c M, the tree stores the products of
+ * the moduli two by two, level by level, up to \c M. The constants
+ * <code>c_j = (M/m_j)^{-1} mod m_j</code> are obtained going down the same
+ * tree (remainder tree), and the reconstruction
+ * <code>x = sum_j (r_j c_j mod m_j) M/m_j mod M</code> goes up the tree:
+ * a node combines its children as <code>x_L P_R + x_R P_L</code>.
+ * Both are quasi-linear in the size of \c M, where prime by prime
+ * reconstruction is quadratic.
+ *
+ * The tree only depends on the moduli, so it is built once and shared by
+ * all the entries of a result vector. These entries are reconstructed in
+ * parallel on threadPool().
+ */
+
+#ifndef __LINBOX_algorithms_crt_subproduct_tree_H
+#define __LINBOX_algorithms_crt_subproduct_tree_H
+
+#include <algorithm>
+#include <vector>
+#include "linbox/integer.h"
+#include "linbox/util/debug.h"
+#include "linbox/util/thread-pool.h"
+
+namespace LinBox
+{
+
+	/*! Subproduct tree over pairwise coprime moduli.
+	 * @ingroup CRA
+	 */
+	class CRTSubproductTree {
+	public:
+		CRTSubproductTree() {}
+
+		//! Tree over the moduli in \p moduli.
+		template<class Vect>
+		CRTSubproductTree(const Vect & moduli)
+		{
+			build(moduli);
+		}
+
+		//! (re)builds the tree for the moduli in \p moduli.
+		template<class Vect>
+		void build(const Vect & moduli)
+		{
+			_levels.resize(1);
+			_levels[0].resize(moduli.size());
+			for (size_t j = 0 ; j < moduli.size() ; ++j)
+				_levels[0][j] = Integer(moduli[j]);
+			_build();
+		}
+
+		//! number of moduli.
+		size_t size() const
+		{
+			return _levels.empty() ? 0 : _levels[0].size() ;
+		}
+
+		//! the \p j-th modulus.
+		const Integer & modulus(size_t j) const
+		{
+			return _levels[0][j];
+		}
+
+		//! product of all the moduli.
+		const Integer & modulus() const
+		{
+			return _levels.back()[0];
+		}
+
+		/*! Integer in <code>[0, M)</code> congruent to <code>r[j]</code> modulo the \p j-th modulus.
+		 * \p r is random access, with elements convertible to Integer.
+		 */
+		template<class Residues>
+		Integer & reconstruct(Integer & res, const Residues & r) const
+		{
+			std::vector<Integer> w(size());
+			return _reconstruct(res, w, [&r](size_t j) -> Integer { return Integer(r[j]); });
+		}
+
+		/*! Reconstructs a whole vector, sharing the tree among its entries.
+		 * <code>r[j][i]</code> is the \p i-th entry modulo the \p j-th
+		 * modulus, and \p res (of size \p n) gets the entries in
+		 * <code>[0, M)</code>.
+		 */
+		template<class ResidueVectors, class Vect>
+		Vect & reconstruct(Vect & res, const ResidueVectors & r, size_t n) const
+		{
+			res.resize(n);
+			const size_t chunks = std::min(n, 4*threadPool().size());
+			threadPool().parallelFor(0, chunks, [&](size_t t) {
+				std::vector<Integer> w(size());
+				Integer x;
+				for (size_t i = t*n/chunks ; i < (t+1)*n/chunks ; ++i) {
+					_reconstruct(x, w, [&r,i](size_t j) -> Integer { return Integer(r[j][i]); });
+					res[i] = x;
+				}
+			});
+			return res;
+		}
+
+		/*! Maps \p x from <code>[0, M)</code> to <code>(-M/2, M/2]</code>.
+		 */
+		Integer & symmetric(Integer & x) const
+		{
+			Integer y(x);
+			y -= modulus();
+			if (absCompare(x, y) > 0)
+				x = y;
+			return x;
+		}
+
+	private:
+		// _levels[0] are the moduli, _levels.back()[0] is their product.
+		std::vector<std::vector<Integer> > _levels;
+		std::vector<Integer>               _coefs; // (M/m_j)^{-1} mod m_j
+
+		void _build()
+		{
+			linbox_check(size() > 0);
+			while (_levels.back().size() > 1) {
+				const std::vector<Integer> & below = _levels.back();
+				std::vector<Integer> above((below.size()+1)/2);
+				for (size_t i = 0 ; 2*i+1 < below.size() ; ++i)
+					Integer::mul(above[i], below[2*i], below[2*i+1]);
+				if (below.size() & 1)
+					above.back() = below.back();
+				_levels.push_back(above);
+			}
+
+			// remainder tree: rem[i] = (M/P_i) mod P_i for the nodes P_i
+			// of a level, starting from 1 at the root.
+			std::vector<Integer> rem(1, Integer(1));
+			for (size_t h = _levels.size()-1 ; h > 0 ; --h) {
+				const std::vector<Integer> & below = _levels[h-1];
+				std::vector<Integer> next(below.size());
+				for (size_t i = 0 ; i < rem.size() ; ++i) {
+					if (2*i+1 == below.size()) {
+						next[2*i] = rem[i];
+						continue;
+					}
+					_mulmod(next[2*i],   rem[i], below[2*i+1], below[2*i]);
+					_mulmod(next[2*i+1], rem[i], below[2*i],   below[2*i+1]);
+				}
+				rem.swap(next);
+			}
+
+			_coefs.resize(size());
+			for (size_t j = 0 ; j < size() ; ++j)
+				inv(_coefs[j], rem[j], _levels[0][j]);
+		}
+
+		// r <-- (a mod m) (b mod m) mod m
+		static Integer & _mulmod(Integer & r, const Integer & a, const Integer & b, const Integer & m)
+		{
+			Integer ta, tb;
+			Integer::mod(ta, a, m);
+			Integer::mod(tb, b, m);
+			Integer::mul(r, ta, tb);
+			return Integer::modin(r, m);
+		}
+
+		// reconstruction of one entry, w is scratch space of size().
+		template<class Residue>
+		Integer & _reconstruct(Integer & res, std::vector<Integer> & w, const Residue & r) const
+		{
+			const std::vector<Integer> & m = _levels[0];
+			for (size_t j = 0 ; j < m.size() ; ++j) {
+				Integer::mul(w[j], r(j), _coefs[j]);
+				Integer::modin(w[j], m[j]);
+				if (w[j] < 0)
+					w[j] += m[j];
+			}
+			// w[i] <-- w[2i] P_{2i+1} + w[2i+1] P_{2i}, level by level.
+			Integer t;
+			size_t len = m.size();
+			for (size_t h = 0 ; len > 1 ; ++h) {
+				const std::vector<Integer> & P = _levels[h];
+				size_t i = 0;
+				for ( ; 2*i+1 < len ; ++i) {
+					Integer::mul(t, w[2*i], P[2*i+1]);
+					Integer::axpyin(t, w[2*i+1], P[2*i]);
+					w[i] = t;
+				}
+				if (len & 1)
+					w[i] = w[2*i];
+				len = (len+1)/2;
+			}
+			// the root is a sum of size() terms, each less than M.
+			Integer::mod(res, w[0], modulus());
+			return res;
+		}
+	};
+
+}
+
+#endif // __LINBOX_algorithms_crt_subproduct_tree_H
+
+// vim:sts=8:sw=8:ts=8:noet:sr:cino=>s,f0,{0,g0,(0,:0,t0,+0,=s
+// Local Variables:
+// mode: C++
+// tab-width: 8
+// indent-tabs-mode: nil
+// c-basic-offset: 8
+// End:
@@ -38,6 +38,7 @@
 
 #include "linbox/linbox-tags.h"
 #include "linbox/matrix/dense-matrix.h"
+#include "linbox/matrix/matrix-domain.h"
 
 namespace LinBox
 {
@@ -97,6 +98,41 @@ namespace LinBox
 
 
 
+	/*! Nullspace of a packed dense matrix over GF2.
+	 * A is modified. Uses the method of four Russians of MatrixDomain<GF2>.
+	 */
+	inline size_t&
+	NullSpaceBasisIn (const LINBOX_enum(Tag::Side) Side,
+			PackedGF2Matrix & A,
+			PackedGF2Matrix & Ker,
+			size_t & kerdim)
+	{
+		MatrixDomain<GF2> MD(A.field());
+		if (Side == Tag::Side::Right) {
+			kerdim = MD.nullspaceBasisIn(Ker, A);
+			return kerdim;
+		}
+		// the left kernel of A is the transpose of the right kernel of A^T
+		PackedGF2Matrix At(A.field()), K(A.field());
+		MD.transpose(At, A);
+		kerdim = MD.nullspaceBasisIn(K, At);
+		MD.transpose(Ker, K);
+		return kerdim;
+	}
+
+	/*! Nullspace of a packed dense matrix over GF2.
+	 * A is preserved.
+	 */
+	inline size_t&
+	NullSpaceBasis (const LINBOX_enum(Tag::Side) Side,
+			const PackedGF2Matrix & A,
+			PackedGF2Matrix & Ker,
+			size_t & kerdim)
+	{
+		PackedGF2Matrix B(A);
+		return NullSpaceBasisIn(Side, B, Ker, kerdim);
+	}
+
 } // LinBox
 
 #include "dense-nullspace.inl"
@@ -34,7 +34,7 @@ namespace LinBox
 	inline long density(const Vector& v)
 	{
 
-		return density(v, VectorTraits<Vector>::VectorCategory());
+		return density(v, typename VectorTraits<Vector>::VectorCategory());
 	}
 
 	template<class Vector, class VectorCategory>
@@ -49,6 +49,13 @@
 #include "linbox/matrix/sparse-matrix.h"
 #include "linbox/matrix/archetype.h"
 #include "linbox/solutions/methods.h"
+#include "linbox/algorithms/structured-elimination.h"
+#include "linbox/vector/sparse-row-pool.h"
+
+#ifndef __LINBOX_GAUSS_DENSE_SWITCH__
+// Active submatrix denser than 30% --> finished with a dense PLUQ
+#define __LINBOX_GAUSS_DENSE_SWITCH__ 0.3
+#endif
 
 /** @file algorithms/gauss.h
  * @brief  Gauss elimination and applications for sparse matrices.
@@ -73,32 +80,52 @@ namespace LinBox
 
 	private:
 		const Field         *_field;
+		double               _denseSwitch;
 
 	public:
 
 		/** \brief The field parameter is the domain
 		 * over which to perform computations
+		 * @param denseSwitch density of the active submatrix above which
+		 * rank and det elimination is finished densely (1 disables)
 		 */
-		GaussDomain (const Field &F) :
-			_field (&F)
+		GaussDomain (const Field &F, double denseSwitch = __LINBOX_GAUSS_DENSE_SWITCH__) :
+			_field (&F), _denseSwitch (denseSwitch)
 		{}
 
 		//Copy constructor
 		///
 		GaussDomain (const GaussDomain &Mat) :
-			_field (Mat._field)
+			_field (Mat._field), _denseSwitch (Mat._denseSwitch)
 		{}
 
 		/** accessor for the field of computation
 		*/
 		const Field &field () const { return *_field; }
 
+		/** density threshold of the switch to dense elimination
+		*/
+		double denseSwitch () const { return _denseSwitch; }
+		void denseSwitch (double d) { _denseSwitch = d; }
+
+		/** whether a \p nnz entries active submatrix of \p Ni x \p Nj
+		 * is dense enough to be finished densely
+		 */
+		bool isDenseEnough (size_t nnz, size_t Ni, size_t Nj) const
+		{
+			return (Ni > 0) && (Nj > 0) && (_denseSwitch < 1.0)
+				&& ((double)nnz >= _denseSwitch * (double)Ni * (double)Nj);
+		}
+
 		/** @name rank
 		  Callers of the different rank routines\\
 		  -/ The "in" suffix indicates in place computation\\
 		  -/ Without Ni, Nj, the Matrix parameter must be a vector of sparse
 		  row vectors, NOT storing any zero.\\
-		  -/ Calls @link rankinLinearPivoting@endlink (by default) or @link rankinNoReordering@endlink
+		  -/ Calls @link rankinLinearPivoting@endlink (by default) or @link rankinNoReordering@endlink\\
+		  -/ With PIVOT_STRUCTURED, the singleton and weight 2 columns are
+		  first eliminated by StructuredElimination\\
+		  -/ With PIVOT_PARALLEL, calls @link InPlaceParallelPivoting@endlink
 		  */
 		//@{
 		///
@@ -221,6 +248,8 @@ namespace LinBox
 
 		// Sparsest method
 		//   erases elements while computing rank/det.
+		//   Once the active submatrix is denser than denseSwitch(),
+		//   it is finished by a dense PLUQ (finite fields only).
 		template <class Matrix>
 		unsigned long& InPlaceLinearPivoting(unsigned long &rank,
 						     Element& determinant,
@@ -239,6 +268,22 @@ namespace LinBox
 						     unsigned long Ni,
 						     unsigned long Nj) const;
 
+		/** \brief Sparse in place elimination by batches of pivots,
+		 * in parallel.
+		 * Each round picks, by Markowitz cost, pivots whose rows and
+		 * columns do not meet; every other row is then reduced by all of
+		 * them at once, rows being distributed over the thread pool.
+		 * The result does not depend on the number of threads.
+		 * Erases elements while computing rank/det, like
+		 * InPlaceLinearPivoting.
+		 */
+		template <class Matrix>
+		unsigned long& InPlaceParallelPivoting(unsigned long &rank,
+						       Element& determinant,
+						       Matrix        &A,
+						       unsigned long Ni,
+						       unsigned long Nj) const;
+
 
 		/** \brief Sparse Gaussian elimination without reordering.
 
@@ -273,6 +318,30 @@ Using : FindPivot and LU
 
 	protected:
 
+		//-----------------------------------------
+		// Candidate pivot of a row, for parallel
+		// elimination: its sparsest column and the
+		// Markowitz cost (row size-1)(column size-1)
+		//-----------------------------------------
+		struct PivotCandidate {
+			uint64_t cost;
+			size_t   row, col;
+			bool operator< (const PivotCandidate &o) const
+			{
+				return (cost < o.cost) || ((cost == o.cost) && (row < o.row));
+			}
+		};
+
+		// Greedy batch of independent pivots among the
+		// sorted candidates; batchOfCol[c] gets the index
+		// in batch of the pivot of column c
+		template <class Matrix>
+		size_t selectIndependentPivots (std::vector<size_t> &batch,
+						std::vector<long> &batchOfCol,
+						std::vector<PivotCandidate> &C,
+						const Matrix &A,
+						unsigned long Nj) const;
+
 		//-----------------------------------------
 		// Sparse elimination using a pivot row :
 		// lc <-- lc - lc[k]/lp[0] * lp
@@ -368,6 +437,19 @@ Using : FindPivot and LU
 				      unsigned long Nj) const;
 
         
+		// Dense PLUQ of the active rows k..Ni-1,
+		// columns rank..Nj-1, of InPlaceLinearPivoting
+		template <class Matrix>
+		unsigned long& DenseRankContinuation(unsigned long &rank,
+				      Element& determinant,
+				      Matrix        &U,
+				      unsigned long k,
+				      unsigned long Ni,
+				      unsigned long Nj) const;
+
+		template <class Matrix, bool hasFFLAS>
+		struct RankContinuation;
+
 		template <class Matrix, class Perm, bool hasFFLAS>
         struct Continuation {
             unsigned long& operator()(
@@ -392,6 +474,7 @@ Using : FindPivot and LU
 #include "linbox/algorithms/gauss/gauss-nullspace.inl"
 #include "linbox/algorithms/gauss/gauss-rank.inl"
 #include "linbox/algorithms/gauss/gauss-det.inl"
+#include "linbox/algorithms/gauss/gauss-parallel.inl"
 
 #endif // __LINBOX_gauss_H
 
@@ -41,6 +41,8 @@ namespace LinBox
 		unsigned long Rank;
 		if (reord == SparseEliminationTraits::PIVOT_NONE)
 			NoReordering(Rank, determinant, A,  Ni, Nj);
+		else if (reord == SparseEliminationTraits::PIVOT_PARALLEL)
+			InPlaceParallelPivoting(Rank, determinant, A, Ni, Nj);
 		else
 			InPlaceLinearPivoting(Rank, determinant, A, Ni, Nj);
 		return determinant;
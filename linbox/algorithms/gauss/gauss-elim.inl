@@ -181,7 +181,8 @@ namespace LinBox
 					// -------------------------------------------
 					// Elimination
 					unsigned long npiv = lignepivot.size ();
-					Vector construit (nj + npiv);
+					Vector construit;
+					sparseRowPool<Vector>().acquire (construit, nj + npiv);
 
 					// construit : <-- j
 					// courante  : <-- m
@@ -253,7 +254,7 @@ namespace LinBox
 						construit[j++] = lignecourante[m++];
 
 					construit.resize (j);
-					lignecourante = construit;
+					sparseRowPool<Vector>().replace (lignecourante, construit);
 				}
 				else {
 					// -------------------------------------------
@@ -412,7 +413,8 @@ namespace LinBox
 					}
 					// -------------------------------------------
 					// Elimination
-					Vector construit (nj + npiv);
+					Vector construit;
+					sparseRowPool<Vector>().acquire (construit, nj + npiv);
 
 					// construit : <-- j
 					// courante  : <-- m
@@ -487,7 +489,7 @@ namespace LinBox
 						construit[j++] = lignecourante[m++];
 
 					construit.resize (j);
-					lignecourante = construit;
+					sparseRowPool<Vector>().replace (lignecourante, construit);
 				}
 				else {
 					// -------------------------------------------
@@ -623,7 +625,8 @@ namespace LinBox
 					// -------------------------------------------
 					// Elimination
 					unsigned long npiv = lignepivot.size ();
-					Vector construit (nj + npiv);
+					Vector construit;
+					sparseRowPool<Vector>().acquire (construit, nj + npiv);
 					// construit : <-- j
 					// courante  : <-- m
 					// pivot     : <-- l
@@ -686,7 +689,7 @@ namespace LinBox
 						construit[j++] = lignecourante[m++];
 
 					construit.resize (j);
-					lignecourante = construit;
+					sparseRowPool<Vector>().replace (lignecourante, construit);
 				}
 				else {
 					// -------------------------------------------
@@ -0,0 +1,291 @@
+/* linbox/algorithms/gauss/gauss-parallel.inl
+ * Copyright (C) the LinBox group
+ *
+ * ========LICENCE========
+ * This file is part of the library LinBox.
+ *
+ * LinBox is free software: you can redistribute it and/or modify
+ * it under the terms of the  GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ * ========LICENCE========
+ *.
+ *
+ * Sparse elimination by batches of independent pivots
+ */
+#ifndef __LINBOX_gauss_parallel_INL
+#define __LINBOX_gauss_parallel_INL
+
+#include <algorithm>
+#include "linbox/util/thread-pool.h"
+
+namespace LinBox
+{
+	template <class _Field>
+	template <class Matrix> inline size_t
+	GaussDomain<_Field>::selectIndependentPivots (std::vector<size_t>        &batch,
+						      std::vector<long>          &batchOfCol,
+						      std::vector<PivotCandidate> &C,
+						      const Matrix               &LigneA,
+						      unsigned long               Nj) const
+	{
+		batch.resize(0);
+		if (C.empty())
+			return 0;
+		std::sort(C.begin(), C.end());
+
+		// Markowitz bound: the fill-in of a batch stays close
+		// to the one of the best pivot
+		const uint64_t bound = 4*(C[0].cost+1);
+		std::vector<char> blocked(Nj, 0);
+		for (size_t t = 0 ; t < C.size() && C[t].cost <= bound ; ++t) {
+			const size_t r = C[t].row, c = C[t].col;
+			// no other pivot in the column of the row,
+			// no pivot column in the row
+			if (blocked[c])
+				continue;
+			bool independent = true;
+			for (size_t k = 0 ; k < LigneA[r].size() ; ++k)
+				if (batchOfCol[LigneA[r][k].first] >= 0) {
+					independent = false;
+					break;
+				}
+			if (! independent)
+				continue;
+			batchOfCol[c] = (long)batch.size();
+			batch.push_back(r);
+			for (size_t k = 0 ; k < LigneA[r].size() ; ++k)
+				blocked[LigneA[r][k].first] = 1;
+		}
+		return batch.size();
+	}
+
+	template <class _Field>
+	template <class Matrix> inline unsigned long&
+	GaussDomain<_Field>::InPlaceParallelPivoting (unsigned long &Rank,
+						      Element       &determinant,
+						      Matrix        &LigneA,
+						      unsigned long  Ni,
+						      unsigned long  Nj) const
+	{
+		typedef typename Matrix::Row        Vector;
+		typedef typename Vector::value_type E;
+
+		commentator().start ("Parallel Gaussian elimination with independent pivots",
+				     "IPPR", Ni);
+		field().write( commentator().report (Commentator::LEVEL_NORMAL, INTERNAL_DESCRIPTION)
+			       << "Parallel Gaussian elimination on " << Ni << " x " << Nj << " matrix, over: ") << std::endl;
+
+		SparseRowPool<Vector> &pool = sparseRowPool<Vector>();
+		pool.resetCounts();
+
+		field().assign(determinant,field().one);
+		Rank = 0;
+		const bool hasFFLAS = std::is_base_of<Givaro::FiniteRingInterface<Element>,_Field>::value;
+
+		std::vector<size_t> active, rest;
+		for (size_t i = 0 ; i < Ni ; ++i)
+			if (LigneA[i].size())
+				active.push_back(i);
+
+		std::vector<size_t> col_density (Nj);
+		std::vector<long> pivotCol (Ni, -1), batchOfCol (Nj, -1);
+		std::vector<size_t> batch;
+		std::vector<Element> pivots;
+		std::vector<PivotCandidate> C;
+		size_t rounds = 0;
+
+		while (! active.empty()) {
+			++rounds;
+			commentator().progress ((long)Rank);
+
+			size_t nnz = 0;
+			std::fill(col_density.begin(), col_density.end(), 0);
+			for (size_t a = 0 ; a < active.size() ; ++a) {
+				const Vector &row = LigneA[active[a]];
+				nnz += row.size();
+				for (size_t k = 0 ; k < row.size() ; ++k)
+					++col_density[row[k].first];
+			}
+
+			if (hasFFLAS && isDenseEnough(nnz, active.size(), Nj-Rank)) {
+				// Active rows moved to the bottom, free columns
+				// relabeled Rank..Nj-1 in order
+				const size_t k = Ni - active.size();
+				std::vector<size_t> label (Nj);
+				std::vector<char> pivoted (Nj, 0);
+				for (size_t i = 0 ; i < Ni ; ++i)
+					if (pivotCol[i] >= 0)
+						pivoted[(size_t)pivotCol[i]] = 1;
+				std::vector<size_t> freeCols;
+				for (size_t j = 0 ; j < Nj ; ++j)
+					if (! pivoted[j]) {
+						label[j] = Rank + freeCols.size();
+						freeCols.push_back(j);
+					}
+				for (size_t t = active.size() ; t-- > 0 ; ) {
+					const size_t i = active[t];
+					if (i != k+t)
+						std::swap(LigneA[k+t], LigneA[i]);
+					for (size_t l = 0 ; l < LigneA[k+t].size() ; ++l)
+						LigneA[k+t][l].first = label[LigneA[k+t][l].first];
+					if (t < freeCols.size())
+						pivotCol[i] = (long)freeCols[t];
+				}
+				RankContinuation<Matrix, std::is_base_of<Givaro::FiniteRingInterface<Element>,_Field>::value>
+				()(*this, Rank, determinant, LigneA, (unsigned long)k, Ni, Nj);
+				break;
+			}
+
+			// Sparsest column of each row
+			const size_t n = active.size();
+			const size_t chunks = std::min(n, 4*threadPool().size());
+			C.resize(n);
+			threadPool().parallelFor(0, chunks, [&](size_t t) {
+				for (size_t a = t*n/chunks ; a < (t+1)*n/chunks ; ++a) {
+					const Vector &row = LigneA[active[a]];
+					size_t c = row[0].first;
+					for (size_t k = 1 ; k < row.size() ; ++k)
+						if (col_density[row[k].first] < col_density[c])
+							c = row[k].first;
+					C[a].cost = (uint64_t)(row.size()-1) * (uint64_t)(col_density[c]-1);
+					C[a].row  = active[a];
+					C[a].col  = c;
+				}
+			});
+
+			selectIndependentPivots(batch, batchOfCol, C, LigneA, Nj);
+			pivots.resize(batch.size());
+			for (size_t b = 0 ; b < batch.size() ; ++b) {
+				const Vector &row = LigneA[batch[b]];
+				for (size_t k = 0 ; k < row.size() ; ++k)
+					if (batchOfCol[row[k].first] == (long)b) {
+						pivotCol[batch[b]] = (long)row[k].first;
+						field().assign(pivots[b], row[k].second);
+						break;
+					}
+			}
+
+			rest.resize(0);
+			for (size_t a = 0 ; a < n ; ++a)
+				if (pivotCol[active[a]] < 0)
+					rest.push_back(active[a]);
+
+			// Each row is reduced by all the pivots of its columns,
+			// in column order, in a buffer of the thread's row pool:
+			// the pivot rows are independent so that the result does
+			// not depend on the number of threads.
+			const size_t m = rest.size();
+			const size_t chunks2 = std::min(m, 4*threadPool().size());
+			threadPool().parallelFor(0, chunks2, [&](size_t t) {
+				SparseRowPool<Vector> &tpool = sparseRowPool<Vector>();
+				std::vector<std::pair<size_t, Element> > hits;
+				Element h;
+				for (size_t a = t*m/chunks2 ; a < (t+1)*m/chunks2 ; ++a) {
+					Vector &row = LigneA[rest[a]];
+					hits.resize(0);
+					for (size_t k = 0 ; k < row.size() ; ++k)
+						if (batchOfCol[row[k].first] >= 0)
+							hits.push_back(std::pair<size_t, Element>((size_t)batchOfCol[row[k].first], row[k].second));
+					for (size_t u = 0 ; u < hits.size() ; ++u) {
+						const size_t b = hits[u].first;
+						const Vector &prow = LigneA[batch[b]];
+						const size_t c = (size_t)pivotCol[batch[b]];
+						// h = - a_ic / a_pc
+						field().divin(field().neg(h, hits[u].second), pivots[b]);
+						Vector buf;
+						tpool.acquire(buf, row.size() + prow.size());
+						buf.resize(0);
+						size_t x = 0, y = 0;
+						while (x < row.size() || y < prow.size()) {
+							if (y == prow.size() || (x < row.size() && row[x].first < prow[y].first)) {
+								buf.push_back(row[x++]);
+							}
+							else if (x == row.size() || prow[y].first < row[x].first) {
+								E e(prow[y].first, field().zero);
+								field().mul(e.second, h, prow[y++].second);
+								buf.push_back(e);
+							}
+							else {
+								if (row[x].first != c) {
+									E e(row[x]);
+									field().axpyin(e.second, h, prow[y].second);
+									if (! field().isZero(e.second))
+										buf.push_back(e);
+								}
+								++x; ++y;
+							}
+						}
+						tpool.replace(row, buf);
+					}
+				}
+			});
+
+			for (size_t b = 0 ; b < batch.size() ; ++b) {
+				field().mulin(determinant, pivots[b]);
+				++Rank;
+				const Vector &row = LigneA[batch[b]];
+				for (size_t k = 0 ; k < row.size() ; ++k)
+					batchOfCol[row[k].first] = -1;
+				pool.release(LigneA[batch[b]]);
+			}
+
+			active.resize(0);
+			for (size_t a = 0 ; a < m ; ++a)
+				if (LigneA[rest[a]].size())
+					active.push_back(rest[a]);
+		}
+
+		commentator().report (Commentator::LEVEL_NORMAL, PARTIAL_RESULT)
+		<< "Rounds : " << rounds << std::endl;
+		pool.write(commentator().report (Commentator::LEVEL_NORMAL, PARTIAL_RESULT))
+		<< ", peak RSS " << peakResidentSetSize() << " kB" << std::endl;
+		pool.trim();
+
+		// det = sign(row -> pivot column) prod pivots
+		if ((Rank < Ni) || (Rank < Nj) || (Ni == 0) || (Nj == 0))
+			field().assign(determinant,field().zero);
+		else {
+			std::vector<char> seen (Ni, 0);
+			for (size_t i = 0 ; i < Ni ; ++i) {
+				if (seen[i]) continue;
+				for (size_t j = i ; ! seen[j] ; j = (size_t)pivotCol[j]) {
+					seen[j] = 1;
+					if ((size_t)pivotCol[j] != i && ! seen[(size_t)pivotCol[j]])
+						field().negin(determinant);
+				}
+			}
+		}
+
+		integer card;
+		field().write(commentator().report (Commentator::LEVEL_NORMAL, PARTIAL_RESULT)
+			      << "Determinant : ", determinant)
+		<< " over GF (" << field().cardinality (card) << ")" << std::endl;
+
+		commentator().report (Commentator::LEVEL_NORMAL, PARTIAL_RESULT)
+		<< "Rank : " << Rank
+		<< " over GF (" << card << ")" << std::endl;
+		commentator().stop ("done", 0, "IPPR");
+		return Rank;
+	}
+
+} // namespace LinBox
+
+#endif // __LINBOX_gauss_parallel_INL
+
+// vim:sts=8:sw=8:ts=8:noet:sr:cino=>s,f0,{0,g0,(0,:0,t0,+0,=s
+// Local Variables:
+// mode: C++
+// tab-width: 8
+// indent-tabs-mode: nil
+// c-basic-offset: 8
+// End:
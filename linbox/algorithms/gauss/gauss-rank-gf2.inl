@@ -46,6 +46,13 @@ namespace LinBox
 
 		if (reord == SparseEliminationTraits::PIVOT_NONE)
 			return NoReordering(Rank, determinant, A,  Ni, Nj);
+		else if (reord == SparseEliminationTraits::PIVOT_STRUCTURED) {
+			StructuredElimination<GF2> SE(F2);
+			SE.reducein(A, Ni, Nj);
+			unsigned long r;
+			InPlaceLinearPivoting(r, determinant, A, P, SE.rowdim(), SE.coldim());
+			return SE.rank(Rank, r);
+		}
 		else
 			return InPlaceLinearPivoting(Rank, determinant, A, P, Ni, Nj);
 	}
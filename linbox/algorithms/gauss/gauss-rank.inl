@@ -41,6 +41,15 @@ namespace LinBox
 		Element determinant;
 		if (reord == SparseEliminationTraits::PIVOT_NONE)
 			return NoReordering(Rank, determinant, A,  Ni, Nj);
+		else if (reord == SparseEliminationTraits::PIVOT_STRUCTURED) {
+			StructuredElimination<Field> SE(field());
+			SE.reducein(A, Ni, Nj);
+			unsigned long r;
+			InPlaceLinearPivoting(r, determinant, A, SE.rowdim(), SE.coldim());
+			return SE.rank(Rank, r);
+		}
+		else if (reord == SparseEliminationTraits::PIVOT_PARALLEL)
+			return InPlaceParallelPivoting(Rank, determinant, A, Ni, Nj);
 		else
 			return InPlaceLinearPivoting(Rank, determinant, A, Ni, Nj);
 	}
@@ -38,6 +38,7 @@
 #include <givaro/ring-interface.h>
 #include <utility>
 #include <type_traits>
+#include <linbox/matrix/dense-matrix.h>
 
 #ifdef __LINBOX_ALL__
 #define __LINBOX_COUNT__
@@ -46,7 +47,6 @@
 #endif
 
 #ifdef __LINBOX_SpD_SWITCH__
-#include <linbox/matrix/dense-matrix.h>
 #include <numeric>
 #  ifndef __LINBOX_SpD_MAXSPARSITY__
 // Sparsity less than 1% --> switch to dense
@@ -85,6 +85,8 @@ namespace LinBox
                      "IPLR", Ni);
         commentator().report (Commentator::LEVEL_NORMAL, INTERNAL_DESCRIPTION)
         << "Gaussian QLUP elimination on " << Ni << " x " << Nj << " matrix" << std::endl;
+        SparseRowPool<Vector> &pool = sparseRowPool<Vector>();
+        pool.resetCounts();
 
 #ifdef __LINBOX_COUNT__
         long long nbelem = 0;
@@ -269,7 +271,11 @@ namespace LinBox
         LigneL.write(rep << "L:= ", Tag::FileFormat::Maple) << ':' << std::endl;
         LigneA.write(rep << "U:= ", Tag::FileFormat::Maple) << ':' << std::endl;
         P.write(rep << "P:= ", Tag::FileFormat::Maple) << ':' << std::endl;
-        
+
+        pool.write(commentator().report (Commentator::LEVEL_NORMAL, PARTIAL_RESULT))
+        << ", peak RSS " << peakResidentSetSize() << " kB" << std::endl;
+        pool.trim();
+
         commentator().report (Commentator::LEVEL_IMPORTANT, PARTIAL_RESULT)
         << "Rank : " << Rank
         << " over GF (" << card << ")" << std::endl;
@@ -509,7 +515,8 @@ namespace LinBox
 #endif
 
         field().assign(determinant,field().one);
-        Vector Vzer(0) ;
+        SparseRowPool<Vector> &pool = sparseRowPool<Vector>();
+        pool.resetCounts();
 
         // allocation of the column density
         std::vector<size_t> col_density (Nj);
@@ -522,6 +529,8 @@ namespace LinBox
         const long last = (long)Ni - 1;
         long c;
         Rank = 0;
+        const bool hasFFLAS = std::is_base_of<Givaro::FiniteRingInterface<Element>,_Field>::value;
+        long densek = -1;
 
 #ifdef __LINBOX_OFTEN__
         long sstep = last/40;
@@ -532,6 +541,7 @@ namespace LinBox
         // Elimination steps with reordering
         for (long k = 0; k < last; ++k) {
             long p = k, s = (long)LigneA[(size_t)k].size ();
+            size_t nnz = (size_t)s;
 
 #ifdef __LINBOX_FILLIN__
             if ( ! (k % 100) ) {
@@ -559,12 +569,20 @@ namespace LinBox
                 // Row permutation for the sparsest row
                 for (l = (unsigned long)k + 1; l < (unsigned long)Ni; ++l) {
                 long sl;
+                    nnz += LigneA[(size_t)l].size ();
                     if (((sl = (long)LigneA[(size_t)l].size ()) < s) && (sl)) {
                         s = sl;
                         p = (long)l;
                     }
                 }
 
+                // Fill-in monitor: rows k..Ni-1 only have entries
+                // in the columns Rank..Nj-1
+                if (hasFFLAS && isDenseEnough(nnz, Ni-(size_t)k, Nj-Rank)) {
+                    densek = k;
+                    break;
+                }
+
                 if (p != k) {
                     field().negin(determinant);
                     Vector vtm = LigneA[(size_t)k];
@@ -585,12 +603,16 @@ namespace LinBox
 #ifdef __LINBOX_COUNT__
                 nbelem += LigneA[(size_t)k].size ();
 #endif
-                LigneA[(size_t)k] = Vzer;
+                pool.release (LigneA[(size_t)k]);
             }
 
         }//for k
 
-        SparseFindPivot (LigneA[(size_t)last], Rank, c, determinant);
+        if (densek >= 0)
+            RankContinuation<Matrix, std::is_base_of<Givaro::FiniteRingInterface<Element>,_Field>::value>
+                ()(*this, Rank, determinant, LigneA, (unsigned long)densek, Ni, Nj);
+        else
+            SparseFindPivot (LigneA[(size_t)last], Rank, c, determinant);
 
 #ifdef __LINBOX_COUNT__
         nbelem += LigneA[(size_t)last].size ();
@@ -617,6 +639,10 @@ namespace LinBox
                   << "Determinant : ", determinant)
         << " over GF (" << field().cardinality (card) << ")" << std::endl;
 
+        pool.write(commentator().report (Commentator::LEVEL_NORMAL, PARTIAL_RESULT))
+        << ", peak RSS " << peakResidentSetSize() << " kB" << std::endl;
+        pool.trim();
+
         commentator().report (Commentator::LEVEL_NORMAL, PARTIAL_RESULT)
         << "Rank : " << Rank
         << " over GF (" << card << ")" << std::endl;
@@ -626,6 +652,75 @@ namespace LinBox
 
 
 
+    template <class _Field>
+    template <class Matrix> inline unsigned long&
+    GaussDomain<_Field>::DenseRankContinuation (unsigned long &Rank,
+                     Element       &determinant,
+                     Matrix        &LigneA,
+                     unsigned long k,
+                     unsigned long Ni,
+                     unsigned long Nj) const
+    {
+        size_t sNi=Ni-k, sNj=Nj-Rank;
+        commentator().report (Commentator::LEVEL_NORMAL, INTERNAL_DESCRIPTION)
+        << "Dense switch at row " << k << ": " << sNi << 'x' << sNj << std::endl;
+
+        BlasMatrix<_Field> A(this->field(), sNi, sNj);
+        for(size_t di=k;di<Ni;++di) {
+            for(size_t dj=0;dj<LigneA[di].size();++dj)
+                A.setEntry(di-k,LigneA[di][dj].first-Rank, LigneA[di][dj].second);
+            LigneA[di].resize(0);
+        }
+
+        size_t *P2 = FFLAS::fflas_new<size_t>(sNi);
+        size_t *Q2 = FFLAS::fflas_new<size_t>(sNj);
+        size_t R2 = FFPACK::PLUQ(this->field(), FFLAS::FflasNonUnit, sNi, sNj, A.getPointer(), sNj, P2, Q2);
+
+        // det = sign(P2) sign(Q2) prod diag(U2), if of full rank
+        for (size_t i=0;i<sNi;++i)
+            if (i != P2[i]) this->field().negin(determinant);
+        for (size_t j=0;j<sNj;++j)
+            if (j != Q2[j]) this->field().negin(determinant);
+        for(size_t i=0; i<R2; ++i)
+            this->field().mulin(determinant,A.getEntry(i,i));
+
+        FFLAS::fflas_delete(P2);
+        FFLAS::fflas_delete(Q2);
+        return Rank+=(unsigned long)R2;
+    }
+
+    template <class _Field>
+    template<class Matrix>
+    struct GaussDomain<_Field>::RankContinuation<Matrix,false> {
+        unsigned long& operator()(
+            const GaussDomain<_Field>&,
+            unsigned long &Rank,
+            typename GaussDomain<_Field>::Element&,
+            Matrix&,
+            unsigned long, unsigned long, unsigned long) const
+            {
+                // no dense switch without FFLAS
+                return Rank;
+            }
+    };
+
+    template <class _Field>
+    template<class Matrix>
+    struct GaussDomain<_Field>::RankContinuation<Matrix,true> {
+        unsigned long& operator()(
+            const GaussDomain<_Field>& GD,
+            unsigned long &Rank,
+            typename GaussDomain<_Field>::Element       &determinant,
+            Matrix        &LigneA,
+            unsigned long k,
+            unsigned long Ni,
+            unsigned long Nj) const
+            {
+                return GD.DenseRankContinuation(Rank,determinant,LigneA,k,Ni,Nj);
+            }
+    };
+
+
     template <class _Field>
     template <class Matrix, class Perm> inline unsigned long&
     GaussDomain<_Field>::InPlaceLinearPivoting (unsigned long &Rank,
@@ -650,6 +745,8 @@ namespace LinBox
         long long nbelem = 0;
 #endif
 
+        SparseRowPool<Vector> &pool = sparseRowPool<Vector>();
+        pool.resetCounts();
         field().assign(determinant,field().one);
         // allocation of the column density
         std::vector<size_t> col_density (Nj);
@@ -771,6 +868,10 @@ namespace LinBox
                   << "Determinant : ", determinant)
         << " over GF (" << field().cardinality (card) << ")" << std::endl;
 
+        pool.write(commentator().report (Commentator::LEVEL_NORMAL, PARTIAL_RESULT))
+        << ", peak RSS " << peakResidentSetSize() << " kB" << std::endl;
+        pool.trim();
+
         commentator().report (Commentator::LEVEL_NORMAL, PARTIAL_RESULT)
         << "Rank : " << Rank
         << " over GF (" << card << ")" << std::endl;
@@ -803,7 +904,8 @@ namespace LinBox
 #ifdef __LINBOX_COUNT__
         long long nbelem = 0;
 #endif
-        Vector Vzer (0);
+        SparseRowPool<Vector> &pool = sparseRowPool<Vector>();
+        pool.resetCounts();
 
         field().assign(determinant,field().one);
         const long last = (long)Ni - 1;
@@ -826,7 +928,7 @@ namespace LinBox
 #ifdef __LINBOX_COUNT__
                 nbelem += LigneA[(size_t)k].size ();
 #endif
-                LigneA[(size_t)k] = Vzer;
+                pool.release (LigneA[(size_t)k]);
             }
         }
 
@@ -850,6 +952,10 @@ namespace LinBox
                   << "Determinant : ", determinant)
         << " over GF (" << field().cardinality (card) << ")" << std::endl;
 
+        pool.write(commentator().report (Commentator::LEVEL_NORMAL, PARTIAL_RESULT))
+        << ", peak RSS " << peakResidentSetSize() << " kB" << std::endl;
+        pool.trim();
+
         commentator().report (Commentator::LEVEL_NORMAL, PARTIAL_RESULT)
         << "Rank : " << res
         << " over GF (" << card << ")" << std::endl;
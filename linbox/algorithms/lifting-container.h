@@ -31,6 +31,7 @@
 #ifndef __LINBOX_lifting_container_H
 #define __LINBOX_lifting_container_H
 
+#include <algorithm>
 #include <vector>
 
 #include "linbox/linbox-config.h"
@@ -49,6 +50,7 @@
 #include "linbox/field/hom.h"
 #include "linbox/matrix/transpose-matrix.h"
 #include "linbox/blackbox/transpose.h"
+#include "linbox/util/thread-pool.h"
 //#include "linbox/algorithms/vector-hom.h"
 
 namespace LinBox
@@ -722,6 +724,235 @@ namespace LinBox
 
 	}; // end of class DixonLiftingContainerBase
 
+	/** Dixon lifting of a block of right hand sides.
+	 * The \c k systems <code>A x_j = b_j</code> are lifted together: with
+	 * \c R the \c n x \c k matrix of the residues, a digit is
+	 * <code>D = A^{-1} R mod p</code>, computed with one matrix product
+	 * over the field (BlasMatrixDomain), and the residues become
+	 * <code>(R - A D)/p</code>, with one call to
+	 * MatrixApplyDomain::applyM and the subtraction and exact division
+	 * done in parallel on threadPool().
+	 *
+	 * \c IMatrix is a BlasMatrix over \c Ring. The bounds on numerators
+	 * and denominators are the ones of the largest column of \c B.
+	 */
+	template <class _Ring, class _Field, class _IMatrix, class _FMatrix>
+	class BlockDixonLiftingContainer : public LiftingContainer< _Ring> {
+
+	public:
+		typedef _Field                               Field;
+		typedef _Ring                                 Ring;
+		typedef _IMatrix                           IMatrix;
+		typedef _FMatrix                           FMatrix;
+		typedef typename Field::Element            Element;
+		typedef typename Ring::Element           Integer_t;
+		typedef BlasVector<Ring>                   IVector;
+		typedef BlasMatrix<Ring>                    IBlock;
+		typedef BlasMatrix<Field>                   FBlock;
+
+	protected:
+
+		const IMatrix&                     _matA;
+		const FMatrix&                       _Ap;
+		Ring                            _intRing;
+		const Field                      *_field;
+		Integer_t                             _p;
+		IBlock                                _B;
+		size_t                           _length;
+		Integer_t                      _numbound;
+		Integer_t                      _denbound;
+		MatrixApplyDomain<Ring,IMatrix>     _MAD;
+		BlasMatrixDomain<Field>            _BMDF;
+		mutable FBlock                    _res_p;
+		mutable FBlock                  _digit_p;
+
+		// f(i) for the rows i of the block, in parallel.
+		template<class Func>
+		static void forRows(size_t m, const Func & f)
+		{
+			const size_t chunks = std::min(m, 4*threadPool().size());
+			threadPool().parallelFor(0, chunks, [&](size_t t) {
+				for (size_t i = t*m/chunks ; i < (t+1)*m/chunks ; ++i)
+					f(i);
+			});
+		}
+
+	public:
+
+		template <class Prime_Type>
+		BlockDixonLiftingContainer (const Ring&       R,
+					    const Field&      F,
+					    const IMatrix&    A,
+					    const FMatrix&   Ap,
+					    const IBlock&     B,
+					    const Prime_Type& p) :
+			_matA(A), _Ap(Ap), _intRing(R), _field(&F), _B(B), _MAD(R,A), _BMDF(F),
+			_res_p(F,B.rowdim(),B.coldim()), _digit_p(F,A.coldim(),B.coldim())
+		{
+			linbox_check(A.rowdim() == B.rowdim());
+			_intRing.init(_p, p);
+
+			Integer_t had_sq, short_sq;
+			BoundBlackbox(_intRing, had_sq, short_sq, A);
+
+			// largest norm of a column of B
+			Integer_t normb_sq, col_sq;
+			_intRing.assign(normb_sq, _intRing.zero);
+			for (size_t j = 0 ; j < B.coldim() ; ++j) {
+				_intRing.assign(col_sq, _intRing.zero);
+				for (size_t i = 0 ; i < B.rowdim() ; ++i)
+					_intRing.axpyin(col_sq, B.getEntry(i,j), B.getEntry(i,j));
+				if (_intRing.compare(col_sq, normb_sq) > 0)
+					_intRing.assign(normb_sq, col_sq);
+			}
+
+			LinBox::integer had_sqi, short_sqi, normb_sqi, N, D, L, Prime;
+			_intRing.convert(had_sqi, had_sq);
+			_intRing.convert(short_sqi, short_sq);
+			_intRing.convert(normb_sqi, normb_sq);
+			_intRing.convert(Prime,_p);
+			D = sqrt(had_sqi) + 1;
+			N = sqrt(had_sqi * normb_sqi / short_sqi) + 1;
+			L = N * D * 2;
+			_length = (size_t)logp(L,Prime) + 1;   // round up instead of down
+			_intRing.init(_numbound,N);
+			_intRing.init(_denbound,D);
+
+			_MAD.setup( Prime );
+		}
+
+		virtual ~BlockDixonLiftingContainer() {}
+
+		//! D = A^{-1} R mod p
+		IBlock& nextdigit(IBlock& digit, const IBlock& residu) const
+		{
+			linbox_check(digit.coldim() == residu.coldim());
+			const size_t k = residu.coldim();
+
+			forRows(residu.rowdim(), [&](size_t i) {
+				Hom<Ring, Field> hom(_intRing, field());
+				for (size_t j = 0 ; j < k ; ++j)
+					hom.image(_res_p.refEntry(i,j), residu.getEntry(i,j));
+			});
+
+			_BMDF.mul(_digit_p, _Ap, _res_p);
+
+			forRows(digit.rowdim(), [&](size_t i) {
+				Hom<Ring, Field> hom(_intRing, field());
+				for (size_t j = 0 ; j < k ; ++j)
+					hom.preimage(digit.refEntry(i,j), _digit_p.getEntry(i,j));
+			});
+			return digit;
+		}
+
+		class const_iterator {
+		private:
+			IBlock                                _res;
+			const BlockDixonLiftingContainer      &_lc;
+			size_t                           _position;
+		public:
+			const_iterator(const BlockDixonLiftingContainer& lc,size_t end=0) :
+				_res(lc._B), _lc(lc), _position(end)
+			{}
+
+			//! next block of p-adic digits, \p digit is \c n x \c k.
+			bool next (IBlock& digit)
+			{
+				_lc.nextdigit(digit,_res);
+
+				// _res = (_res - A digit) / p
+				IBlock v2 (_lc.ring(), _res.rowdim(), _res.coldim());
+				_lc._MAD.applyM(v2, digit);
+
+				const size_t k = _res.coldim();
+				forRows(_res.rowdim(), [&](size_t i) {
+					for (size_t j = 0 ; j < k ; ++j) {
+						Integer_t & r = _res.refEntry(i,j);
+						_lc._intRing.subin(r, v2.getEntry(i,j));
+						_lc._intRing.divin(r, _lc._p);
+					}
+				});
+
+				++_position;
+				return true;
+			}
+
+			bool operator != (const const_iterator& iterator) const
+			{
+				return _position != iterator._position;
+			}
+
+			bool operator == (const const_iterator& iterator) const
+			{
+				return _position == iterator._position;
+			}
+		};
+
+		const_iterator begin() const
+		{
+			return const_iterator(*this);
+		}
+
+		const_iterator end() const
+		{
+			return const_iterator (*this,_length);
+		}
+
+		virtual size_t length() const
+		{
+			return _length;
+		}
+
+		// return the size of the solution
+		virtual size_t size() const
+		{
+			return _matA.coldim();
+		}
+
+		// return the number of right hand sides
+		size_t blocksize() const
+		{
+			return _B.coldim();
+		}
+
+		// return the ring
+		virtual const Ring& ring() const
+		{
+			return _intRing;
+		}
+
+		// return the field
+		const Field& field() const
+		{
+			return *_field;
+		}
+
+		// return the prime
+		virtual const Integer_t& prime () const
+		{
+			return _p;
+		}
+
+		// return the bound for the numerator
+		const Integer_t numbound() const
+		{
+			return _numbound;
+		}
+
+		// return the bound for the denominator
+		const Integer_t denbound() const
+		{
+			return _denbound;
+		}
+
+		// return the matrix
+		const IMatrix& getMatrix() const
+		{
+			return _matA;
+		}
+
+	}; // end of class BlockDixonLiftingContainer
+
 	/// Wiedemann LiftingContianer.
 	template <class _Ring, class _Field, class _IMatrix, class _FMatrix, class _FPolynomial>
 	class WiedemannLiftingContainer : public LiftingContainerBase<_Ring, _IMatrix> {
@@ -207,7 +207,7 @@ namespace LinBox{
       //size_t n_ta=m*k*pts, n_tb=k*n*pts;
       //std::cout<<"----------------------------------------------"<<std::endl;
       //std::cout<<"MUL FFT RNS: "<<MEMINFO<<std::endl;
-      std::cout<<"MUL FFT RNS: need "<<MB((m*n*pts+n_ta+n_tb)*num_primes*8 + 2*(m*k+k*n)*pts*8)<<"Mo"<<std::endl;
+      std::cout<<"MUL FFT RNS: need "<<MB((m*n*s+n_ta+n_tb)*num_primes*8 + 2*(m*k+k*n)*s*8)<<"Mo"<<std::endl;
       
       //std::cout<<"MUL FFT RNS: RNS -> allocating "<<MB((n_ta+n_tb)*num_primes*8)<<"Mo"<<std::endl;
       double* t_a_mod= new double[n_ta*num_primes];
@@ -220,17 +220,18 @@ namespace LinBox{
       //std::cout<<"MUL FFT RNS: RNS -> allocating "<<MB((m*n*pts)*num_primes*8)<<"Mo"<<std::endl;
       //std::cout<<"MUL FFT RNS: RNS -> allocating "<<MB((2*(m*k+k*n)*pts)*8)<<"Mo"<<std::endl;
 
-      // FFT_PROFILE_START(2);
-      // auto sp=SPLITTER();
-      // PARFOR1D(l,num_primes,sp,
+      // the primes in parallel on the thread pool
+      std::vector<ModField> f_i;
       for (size_t l=0;l<num_primes;l++)
+	f_i.push_back(ModField(RNS._basis[l]));
+      for (size_t l=0;l<num_primes;l++)
+	c_i[l] = new MatrixP_F(f_i[l], m, n, s);
+      threadPool().parallelFor(0, num_primes, [&](size_t l)
 	{
-	  //FFT_PROFILE_START;
-	  ModField f(RNS._basis[l]);
-	  MatrixP_F a_i (f, m, k, pts);
-	  MatrixP_F b_i (f, k, n, pts);
+	  const ModField &f = f_i[l];
+	  MatrixP_F a_i (f, m, k, s);
+	  MatrixP_F b_i (f, k, n, s);
 	
-	  c_i[l] = new MatrixP_F(f, m, n, pts);
 	  // copy reduced data
 	  for (size_t i=0;i<m*k;i++)
 	    for (size_t j=0;j<a.size();j++)
@@ -238,13 +239,10 @@ namespace LinBox{
 	  for (size_t i=0;i<k*n;i++)
 	    for (size_t j=0;j<b.size();j++)
 	      b_i.ref(i,j)=t_b_mod[l*n_tb+j+i*b.size()];	
-	  //FFT_PROFILE_GET(tCopy);
 	  //PolynomialMatrixFFTPrimeMulDomain<ModField> fftdomain (f);
 	  PolynomialMatrixThreePrimesFFTMulDomain<ModField> fftdomain (f);       
 	  fftdomain.mul_fft(lpts, *c_i[l], a_i, b_i);	
-	  //FFT_PROFILE_GET(tMul);
-	}
-      //)
+	});
       FFT_PROFILING(2,"FFTprime mult+copying");
       delete[] t_a_mod;
       delete[] t_b_mod;
@@ -260,12 +258,12 @@ namespace LinBox{
 	size_t n_tc=m*n*s;
 	//std::cout<<"MUL FFT RNS: RNS -> allocating "<<MB(n_tc*num_primes*8)<<"Mo"<<std::endl;
 	double *t_c_mod = new double[n_tc*num_primes];
-	for (size_t l=0;l<num_primes;l++){
-	  for (size_t i=0;i<m*n;i++)
-	    for (size_t j=0;j<s;j++)
-	      t_c_mod[l*n_tc + (j+i*s)]= c_i[l]->get(i,j);
-	  delete c_i[l];
-	}
+	threadPool().parallelFor(0, num_primes, [&](size_t l) {
+	    for (size_t i=0;i<m*n;i++)
+	      for (size_t j=0;j<s;j++)
+		t_c_mod[l*n_tc + (j+i*s)]= c_i[l]->get(i,j);
+	    delete c_i[l];
+	  });
 	FFT_PROFILING(2,"linearization of results mod pi");
 
 	// reconstruct the result in C
@@ -329,10 +327,10 @@ namespace LinBox{
       double* t_a_mod= new double[n_ta*CRT_NBPRIME];
       double* t_b_mod= new double[n_tb*CRT_NBPRIME];
       std::cout<<"MUL FFT RNS: input/output data: "<< MB((n_ta*(maxA.bitsize()+128) +n_tb*(maxB.bitsize()+128) +m*k*s*(bound.bitsize()+128))/8)<<"Mo"<<std::endl;
-      std::cout<<"MUL FFT RNS: initial need "<<MB((m*n*pts+n_ta+n_tb)*num_primes*8 + 2*(m*k+k*n)*pts*8)<<"Mo"<<std::endl;
+      std::cout<<"MUL FFT RNS: initial need "<<MB((m*n*s+n_ta+n_tb)*num_primes*8 + 2*(m*k+k*n)*s*8)<<"Mo"<<std::endl;
       std::cout<<"MUL FFT RNS: RNS  in: "<<MB( (n_ta+n_tb)*CRT_NBPRIME*8)<<"Mo"<<std::endl;
-      std::cout<<"MUL FFT RNS: RNC com: "<<MB(2*(m*k+k*n)*pts*8)<<"Mo"<<std::endl;
-      std::cout<<"MUL FFT RNS: RNS out: "<<MB((m*n*pts)*num_primes*8 )<<"Mo"<<std::endl;
+      std::cout<<"MUL FFT RNS: RNC com: "<<MB(2*(m*k+k*n)*s*8)<<"Mo"<<std::endl;
+      std::cout<<"MUL FFT RNS: RNS out: "<<MB((m*n*s)*num_primes*8 )<<"Mo"<<std::endl;
       
       for(size_t loop=0;loop<num_primes;loop+=CRT_NBPRIME){
 	
@@ -351,14 +349,18 @@ namespace LinBox{
 	//std::cout<<"MUL FFT RNS: RNS -> allocating "<<MB((m*n*pts)*num_primes*8)<<"Mo"<<std::endl;
 	//std::cout<<"MUL FFT RNS: RNS -> allocating "<<MB((2*(m*k+k*n)*pts)*8)<<"Mo"<<std::endl;
 
+	std::vector<ModField> f_i;
 	for (size_t l=0;l<rns_chunk;l++)
+	  f_i.push_back(ModField(smallRNS._basis[l]));
+	for (size_t l=0;l<rns_chunk;l++)
+	  c_i[loop+l] = new MatrixP_F(f_i[l], m, n, s);
+	// the primes of the chunk in parallel on the thread pool
+	threadPool().parallelFor(0, rns_chunk, [&](size_t l)
 	  {	    
-	    //FFT_PROFILE_START;
 	    //std::cout<<"prime: "<<(long)smallRNS._basis[l]<<std::endl;
-	    ModField f(smallRNS._basis[l]);
-	    MatrixP_F a_i (f, m, k, pts);
-	    MatrixP_F b_i (f, k, n, pts);	
-	    c_i[loop+l] = new MatrixP_F(f, m, n, pts);
+	    const ModField &f = f_i[l];
+	    MatrixP_F a_i (f, m, k, s);
+	    MatrixP_F b_i (f, k, n, s);	
 	    // copy reduced data
 	    for (size_t i=0;i<m*k;i++)
 	      for (size_t j=0;j<a.size();j++)
@@ -370,8 +372,7 @@ namespace LinBox{
 	    //PolynomialMatrixFFTPrimeMulDomain<ModField> fftdomain (f);
 	    PolynomialMatrixThreePrimesFFTMulDomain<ModField> fftdomain (f);       
 	    fftdomain.mul_fft(lpts, *c_i[loop+l], a_i, b_i);	
-	    //FFT_PROFILE_GET(tMul);
-	  }      
+	  });
 	FFT_PROFILING(2,"FFTprime mult+copying");
 	//FFT_PROFILE(2,"copying linear reduced matrix",tCopy);
 	//FFT_PROFILE(2,"FFTprime multiplication",tMul);
@@ -390,12 +391,12 @@ namespace LinBox{
 	size_t n_tc=m*n*s;
 	//std::cout<<"MUL FFT RNS: RNS -> allocating "<<MB(n_tc*num_primes*8)<<"Mo"<<std::endl;
 	double *t_c_mod = new double[n_tc*num_primes];
-	for (size_t l=0;l<num_primes;l++){
-	  for (size_t i=0;i<m*n;i++)
-	    for (size_t j=0;j<s;j++)
-	      t_c_mod[l*n_tc + (j+i*s)]= c_i[l]->get(i,j);
-	  delete c_i[l];
-	}
+	threadPool().parallelFor(0, num_primes, [&](size_t l) {
+	    for (size_t i=0;i<m*n;i++)
+	      for (size_t j=0;j<s;j++)
+		t_c_mod[l*n_tc + (j+i*s)]= c_i[l]->get(i,j);
+	    delete c_i[l];
+	  });
 	FFT_PROFILING(2,"linearization of results mod pi");
 
 	// reconstruct the result in C
@@ -454,6 +455,9 @@ namespace LinBox{
       //size_t hdeg= deg/2;
       size_t lpts=0;
       size_t pts  = 1; while (pts < deg) { pts= pts<<1; ++lpts; }
+      // the transforms of length L give the c.size() first coefficients
+      // without wrap around, truncated ones if L < 2^lpts
+      size_t L = std::min(hdeg+c.size()-1, pts);
 
 
       // compute bit size of feasible prime for FFLAS
@@ -476,7 +480,6 @@ namespace LinBox{
       FFPACK::rns_double RNS(basis);
       size_t num_primes = RNS._size;
 #ifdef FFT_PROFILER
-      double tMul=0.,tCopy=0;;
       if (FFT_PROF_LEVEL<3){
 	std::cout << "number of FFT primes :" << num_primes << std::endl;
 	std::cout << "max prime            : "<<prime_max<<" ("<<integer(prime_max).bitsize()<<")"<<std::endl;
@@ -505,37 +508,37 @@ namespace LinBox{
 
       std::vector<MatrixP_F*> c_i (num_primes);
 
-      for (size_t l=0;l<num_primes;l++){
-	FFT_PROFILE_START(2);
-	ModField f(RNS._basis[l]);
-	MatrixP_F a_i (f, m, k, pts);
-	MatrixP_F b_i (f, k, n, pts);
-	c_i[l] = new MatrixP_F(f, m, n, pts);
+      // the primes in parallel on the thread pool
+      std::vector<ModField> f_i;
+      for (size_t l=0;l<num_primes;l++)
+	f_i.push_back(ModField(RNS._basis[l]));
+      for (size_t l=0;l<num_primes;l++)
+	c_i[l] = new MatrixP_F(f_i[l], m, n, L);
+      threadPool().parallelFor(0, num_primes, [&](size_t l) {
+	const ModField &f = f_i[l];
+	MatrixP_F a_i (f, m, k, L);
+	MatrixP_F b_i (f, k, n, L);
 	// copy reduced data and reversed when necessary according to midproduct algo
 	//std::cout<<"hdeg-size: "<<hdeg<<" <-> "<<a.size()<<std::endl;
 	for (size_t i=0;i<m*k;i++)
-	  for (size_t j=0;j<a.size();j++)
+	  for (size_t j=0;j<std::min(a.size(),L);j++)
 	    if (smallLeft)
 	      a_i.ref(i,hdeg-1-j)=t_a_mod[l*n_ta+j+i*a.size()];
 	    else
 	      a_i.ref(i,j)=t_a_mod[l*n_ta+j+i*a.size()];
 	for (size_t i=0;i<k*n;i++)
-	  for (size_t j=0;j<b.size();j++)
+	  for (size_t j=0;j<std::min(b.size(),L);j++)
 	    if (smallLeft)
 	      b_i.ref(i,j)=t_b_mod[l*n_tb+j+i*b.size()];
 	    else
 	      b_i.ref(i,hdeg-1-j)=t_b_mod[l*n_tb+j+i*b.size()];
-	FFT_PROFILE_GET(2,tCopy);
 	//PolynomialMatrixFFTPrimeMulDomain<ModField> fftdomain (f);
 	PolynomialMatrixThreePrimesFFTMulDomain<ModField> fftdomain (f);       
 	fftdomain.midproduct_fft(lpts, *(c_i[l]), a_i, b_i, smallLeft);
-				
-	FFT_PROFILE_GET(2,tMul);
-      }
+      });
       delete[] t_a_mod;
       delete[] t_b_mod;
-      FFT_PROFILE(2,"copying linear reduced matrix",tCopy);
-      FFT_PROFILE(2,"FFTprime multiplication",tMul);
+      FFT_PROFILING(2,"FFTprime mult+copying");
 
       if (num_primes < 2) {
 	FFT_PROFILE_START(2);
@@ -546,12 +549,12 @@ namespace LinBox{
 	double *t_c_mod;
 	size_t n_tc=m*n*c.size();
 	t_c_mod = new double[n_tc*num_primes];
-	for (size_t l=0;l<num_primes;l++){
-	  for (size_t i=0;i<m*n;i++)
-	    for (size_t j=0;j<c.size();j++)
-	      t_c_mod[l*n_tc + (j+i*c.size())]= c_i[l]->get(i,j);
-	  delete c_i[l];
-	}
+	threadPool().parallelFor(0, num_primes, [&](size_t l) {
+	    for (size_t i=0;i<m*n;i++)
+	      for (size_t j=0;j<c.size();j++)
+		t_c_mod[l*n_tc + (j+i*c.size())]= c_i[l]->get(i,j);
+	    delete c_i[l];
+	  });
 	FFT_PROFILING(2,"linearization of results mod pi");
 
 	// reconstruct the result in C
@@ -27,17 +27,26 @@
 #ifndef __LINBOX_matpoly_mult_ftt_wordsize_fast_INL
 #define __LINBOX_matpoly_mult_ftt_wordsize_fast_INL
 
+#include <string>
 #include "givaro/modular.h"
 #include "fflas-ffpack/fflas-ffpack.h"
 #include "linbox/matrix/polynomial-matrix.h"
 #include "linbox/matrix/matrix-domain.h"
 #include "linbox/algorithms/polynomial-matrix/polynomial-fft-transform.h"
+#include "linbox/algorithms/polynomial-matrix/polynomial-tft-transform.h"
 
 namespace LinBox {
 
 	/***********************************************************************************
 	 **** Polynomial Matrix Multiplication over Zp[x] with p (FFTPrime, FFLAS prime) ***
 	 ***********************************************************************************/
+	// The products go through TFT_transform (a FFT when the length is a power of two)
+	// in three passes: the operands are loaded and transformed entry by entry, the
+	// pointwise products are done by blocks of points and the result is transformed
+	// back entry by entry. The transforms are in place and the changes of layout
+	// (polfirst <-> matfirst) are done on the blocks of the pointwise pass, so the
+	// only full size temporaries are the transformed operands, which live in a
+	// FFTWorkspace kept by the domain (or given by its owner).
 	template<class Field>
 	class PolynomialMatrixFFTPrimeMulDomain {
 
@@ -47,153 +56,81 @@ namespace LinBox {
 		typedef PolynomialMatrix<PMType::polfirst,PMStorage::plain,Field> MatrixP;
 		// Polynomial matrix stored as a polynomial of matrix
 		typedef PolynomialMatrix<PMType::matfirst,PMStorage::plain,Field> PMatrix;
+		typedef typename Field::Element                                  Element;
 
 	private:
 		const Field              *_field;  // Read only
 		uint64_t                      _p;
-		BlasMatrixDomain<Field>     _BMD;
+		FFTWorkspace             _own_ws;
+		FFTWorkspace                 *_ws;  // NULL: _own_ws is used
+
+		typedef void (TFT_transform<Field>::*TFTMethod)(Element*, size_t, uint32_t*);
 
 	public:
 		inline const Field & field() const { return *_field; }
 
-		PolynomialMatrixFFTPrimeMulDomain(const Field &F)
-			: _field(&F), _p(field().cardinality()),  _BMD(F){}
+		PolynomialMatrixFFTPrimeMulDomain(const Field &F, FFTWorkspace *ws = NULL)
+			: _field(&F), _p(field().cardinality()), _ws(ws) {}
+
+		FFTWorkspace& workspace() { return (_ws == NULL) ? _own_ws : *_ws; }
 
 		template<typename Matrix1, typename Matrix2, typename Matrix3>
 		void mul (Matrix1 &c, const Matrix2 &a, const Matrix3 &b) {
 			linbox_check(a.coldim()==b.rowdim());
 			size_t deg  = a.size()+b.size()-1;
-			size_t lpts = 0;
-			size_t pts  = 1; while (pts < deg) { pts= pts<<1; ++lpts; }
-			// padd the input a and b to 2^lpts (convert to MatrixP representation)
-			MatrixP a2(field(),a.rowdim(),a.coldim(),pts);
-			MatrixP b2(field(),b.rowdim(),b.coldim(),pts);
-			a2.copy(a,0,a.size()-1);
-			b2.copy(b,0,b.size()-1);
-			MatrixP c2(field(),c.rowdim(),c.coldim(),pts);
-			mul_fft (lpts,c2, a2, b2);
-			c.copy(c2,0,deg-1);
+			size_t m = a.rowdim();
+			size_t k = a.coldim();
+			size_t n = b.coldim();
+			// a and b padded to deg (the transforms of length deg < 2^lpts being
+			// truncated ones), the transformed product overwriting a
+			Element *A = workspace().template get<Element>(0, std::max(m*k, m*n)*deg);
+			Element *B = workspace().template get<Element>(1, k*n*deg);
+			product(deg, m, k, n,
+				A, deg, &TFT_transform<Field>::TFT_DIF, [&](size_t i, Element *p) { load(p, deg, a, i); },
+				B, deg, &TFT_transform<Field>::TFT_DIF, [&](size_t i, Element *p) { load(p, deg, b, i); },
+				A, deg, &TFT_transform<Field>::TFT_DIT, [&](size_t i, const Element *p) {
+					for (size_t j = 0; j < deg; j++)
+						c.ref(i,j) = p[j];
+				});
 		}
 
 		void mul (MatrixP &c, const MatrixP &a, const MatrixP &b) {
 			linbox_check(a.coldim()==b.rowdim());
 			size_t deg  = a.size()+b.size()-1;
-			size_t lpts = 0;
-			size_t pts  = 1; while (pts < deg) { pts= pts<<1; ++lpts; }
-			
-			// padd the input a and b to 2^lpts
-			MatrixP a2(field(),a.rowdim(),a.coldim(),pts);
-			MatrixP b2(field(),b.rowdim(),b.coldim(),pts);
-			a2.copy(a,0,a.size()-1);
-			b2.copy(b,0,b.size()-1);
-			// resize c to 2^lpts
-			c.resize(pts);
-			mul_fft (lpts,c, a2, b2);
-			c.resize(deg);
-		}
-
-		// a,b and c must have size: 2^lpts
-		// -> use TFT to circumvent the padding issue
-		void mul_fft (size_t lpts, MatrixP &c, MatrixP &a, MatrixP &b) {
-			FFT_PROFILE_START(1);
 			size_t m = a.rowdim();
 			size_t k = a.coldim();
 			size_t n = b.coldim();
-			size_t pts=c.size();
-			//std::cout<<"mul : 2^"<<lpts<<std::endl;
-#ifdef FFT_PROFILER
-			Timer totalTime;
-			totalTime.start();
-			if (FFT_PROF_LEVEL==1) std::cout<<"FFT: points "<<pts<<"\n";
-#endif
-
-			if ((_p-1) % pts != 0) {
-				std::cout<<"Error the prime is not a FFTPrime or it has too small power of 2\n";
-				std::cout<<"prime="<<_p<<std::endl;
-				std::cout<<"nbr points="<<pts<<std::endl;
-				throw LinboxError("LinBox ERROR: bad FFT Prime\n");
+			if (&c == &a || &c == &b) {
+				MatrixP c2(field(), m, n, deg);
+				mul(c2, a, b);
+				c.resize(deg);
+				c.copy(c2, 0, deg-1);
+				return;
 			}
-			FFT_transform<Field> FFTer (field(), lpts);
-			FFT_transform<Field> FFTinv (field(), lpts, FFTer.getInvRoot());
-			FFT_PROFILING(1,"init");
-
-			// std::cout<<"FFT Root: "<<FFTer.getRoot()<<std::endl;
-			// std::cout<<"FFT InvRoot: "<<FFTer.getInvRoot()<<std::endl;
-			// std::cout<<a<<std::endl;
-			// std::cout<<b<<std::endl;
-			
-			// FFT transformation on the input matrices
-			for (size_t i = 0; i < m * k; i++)
-				FFTer.FFT_DIF(&(a.ref(i,0)));
-			for (size_t i = 0; i < k * n; i++)
-				FFTer.FFT_DIF(&(b.ref(i,0)));
-			FFT_PROFILING(1,"direct FFT_DIF");
-			
-			//std::cout<<"DIF:  w="<<FFTer._w<<std::endl;
-			//std::cout<<a<<std::endl;
-			//std::cout<<b<<std::endl;
-			
-			
-			// convert the matrix representation to matfirst (with double coefficient)
-			PMatrix vm_c (field(), m, n, pts);
-#ifdef TRY1
-			BlasMatrix<Field> vm_a(field(),m,k);
-			BlasMatrix<Field> vm_b(field(),k,n);
-			FFT_PROFILING(1,"creation of Matfirst");
-
-			// Pointwise multiplication
-			for (size_t i = 0; i < pts; ++i){
-				a.setMatrix(vm_a,i);
-				b.setMatrix(vm_b,i);
-				_BMD.mul(vm_c[i], vm_a, vm_b);
+			c.resize(deg);
+			if (k > n) {
+				mul<MatrixP,MatrixP,MatrixP>(c, a, b);
+				return;
 			}
-			FFT_PROFILING(1,"Pointwise mult");
-			
-#else
-			PMatrix vm_a (field(), m, k, pts);
-			PMatrix vm_b (field(), k, n, pts);
-			FFT_PROFILING(1,"creation of Matfirst");
-			vm_a.copy(a);
-			vm_b.copy(b);
-			FFT_PROFILING(1,"Polfirst to Matfirst");
-
-			// Pointwise multiplication
-			for (size_t i = 0; i < pts; ++i)
-				_BMD.mul(vm_c[i], vm_a[i], vm_b[i]);
-			FFT_PROFILING(1,"Pointwise mult");
-#endif			
-			// Transformation into matrix of polynomials (with int32_t coefficient)
-			c.copy(vm_c);
-			FFT_PROFILING(1,"Matfirst to Polfirst");
-
-			//std::cout<<"pointwise:"<<std::endl;
-			//std::cout<<c<<std::endl;			
-			
-			// Inverse FFT on the output matrix
-			for (size_t i = 0; i < m * n; i++)
-				FFTinv.FFT_DIT(&(c.ref(i,0)));
-			FFT_PROFILING(1,"inverse FFT_DIT");
-
-			// std::cout<<"DIT:"<<std::endl;
-			// std::cout<<c<<std::endl;
-
-			// Divide by pts = 2^lpts
-			typename Field::Element inv_pts;
-			field().init(inv_pts, pts);
-			field().invin(inv_pts);
-			// for (size_t i = 0; i < m * n; i++)
-			// 	for (size_t j = 0; j < pts; j++)
-			// 		field().mulin(c.ref(i,j), inv_pts);
-			FFLAS::fscalin(field(),c.rowdim()*c.coldim()*c.size(), inv_pts,  c.getWritePointer(),1);
-
-			// std::cout<<"SCALIN:"<<std::endl;
-			// std::cout<<c<<std::endl;
+			// a is padded and transformed in the storage of c, which gets
+			// the product: b is the only temporary
+			Element *C = c.getWritePointer();
+			size_t   sc= c.storage();
+			Element *B = workspace().template get<Element>(1, k*n*deg);
+			product(deg, m, k, n,
+				C, sc , &TFT_transform<Field>::TFT_DIF, [&](size_t i, Element *p) { load(p, deg, a, i); },
+				B, deg, &TFT_transform<Field>::TFT_DIF, [&](size_t i, Element *p) { load(p, deg, b, i); },
+				C, sc , &TFT_transform<Field>::TFT_DIT, [](size_t, const Element*) {});
+		}
 
-			FFT_PROFILING(1,"scaling the result");
-#ifdef FFT_PROFILER
-			totalTime.stop();
-			//std::cout<<"FFT(1): total time : "<<totalTime<<std::endl;
-#endif
+		// a,b and c must have the same size, at most 2^lpts
+		// -> a and b are overwritten by their transforms
+		void mul_fft (size_t lpts, MatrixP &c, MatrixP &a, MatrixP &b) {
+			linbox_check(a.size()==c.size() && b.size()==c.size() && c.size() <= (1ULL << lpts));
+			product(c.size(), a.rowdim(), a.coldim(), b.coldim(),
+				a.getWritePointer(), a.storage(), &TFT_transform<Field>::TFT_DIF, [](size_t, Element*) {},
+				b.getWritePointer(), b.storage(), &TFT_transform<Field>::TFT_DIF, [](size_t, Element*) {},
+				c.getWritePointer(), c.storage(), &TFT_transform<Field>::TFT_DIT, [](size_t, const Element*) {});
 		}
 
 		// compute  c= (a*b x^(-n0-1)) mod x^n1
@@ -211,99 +148,157 @@ namespace LinBox {
 			else
 				linbox_check(a.size()<hdeg+deg);
 
-			size_t lpts = 0;
-			size_t pts  = 1; while (pts < deg) { pts= pts<<1; ++lpts; }
-			// padd the input a and b to 2^lpts (use MatrixP representation)
-			MatrixP a2(field(),a.rowdim(),a.coldim(),pts);
-			MatrixP b2(field(),b.rowdim(),b.coldim(),pts);
-			MatrixP c2(field(),c.rowdim(),c.coldim(),pts);
-			a2.copy(a,0,a.size()-1);
-			b2.copy(b,0,b.size()-1);
-
-			// reverse the element of the smallest polynomial according to h(x^-1)*x^(hdeg)
-			if (smallLeft)
-				for (size_t j=0;j<a2.rowdim()*a2.coldim();j++)
-					for (size_t i=0;i<hdeg/2;i++)
-						std::swap(a2.ref(j,i),a2.ref(j,hdeg-1-i));
-			else
-				for (size_t j=0;j<b2.rowdim()*b2.coldim();j++)
-					for (size_t i=0;i<hdeg/2;i++)
-						std::swap(b2.ref(j,i),b2.ref(j,hdeg-1-i));
-
-			midproduct_fft (lpts,c2, a2, b2, smallLeft);
-			c.copy(c2,0,c.size()-1);
+			size_t pts  = 1; while (pts < deg) { pts= pts<<1; }
+			// the transforms of length L give the c.size() first coefficients
+			// without wrap around, truncated ones if L < 2^lpts
+			size_t L = std::min(hdeg+c.size()-1, pts);
+			size_t m = a.rowdim();
+			size_t k = a.coldim();
+			size_t n = b.coldim();
+			// a and b padded to L, the smallest one being reversed according
+			// to h(x^-1)*x^(hdeg), and the transformed product overwriting a
+			Element *A = workspace().template get<Element>(0, std::max(m*k, m*n)*L);
+			Element *B = workspace().template get<Element>(1, k*n*L);
+			size_t ra = smallLeft ? hdeg : 0, rb = smallLeft ? 0 : hdeg;
+			size_t sc = std::min(c.size(), L);
+			product(L, m, k, n,
+				A, L, smallLeft ? &TFT_transform<Field>::TFT_DIF : &TFT_transform<Field>::TFT_DIT_transposed,
+				[&](size_t i, Element *p) { load(p, L, a, i, ra); },
+				B, L, smallLeft ? &TFT_transform<Field>::TFT_DIT_transposed : &TFT_transform<Field>::TFT_DIF,
+				[&](size_t i, Element *p) { load(p, L, b, i, rb); },
+				A, L, &TFT_transform<Field>::TFT_DIF_transposed, [&](size_t i, const Element *p) {
+					for (size_t j = 0; j < sc; j++)
+						c.ref(i,j) = p[j];
+				});
 		}
 
-		// a,b and c must have size: 2^lpts
+		// a,b and c must have the same size, at most 2^lpts
 		// -> a must have been already reversed according to the midproduct algorithm
+		// -> a and b are overwritten by their transforms
+		// with s the reversed operand and t the other one, c = TFT_DIF^T (TFT_DIF(s) . TFT_DIT^T(t))
+		// is the transposed of the product by s, i.e. c[j] = sum_i s[i] t[i+j] for j <= L-s.size()
 		void midproduct_fft (size_t lpts, MatrixP &c, MatrixP &a, MatrixP &b,
 				     bool smallLeft=true) {
-			FFT_PROFILE_START(1);
-			size_t m = a.rowdim();
-			size_t k = a.coldim();
-			size_t n = b.coldim();
-			size_t pts=c.size();
-			//cout<<"mid : "<<pts<<endl;
-#ifdef FFT_PROFILER
-			if (FFT_PROF_LEVEL==1) std::cout<<"FFT: points "<<pts<<"\n";
-#endif
+			linbox_check(a.size()==c.size() && b.size()==c.size() && c.size() <= (1ULL << lpts));
+			product(c.size(), a.rowdim(), a.coldim(), b.coldim(),
+				a.getWritePointer(), a.storage(),
+				smallLeft ? &TFT_transform<Field>::TFT_DIF : &TFT_transform<Field>::TFT_DIT_transposed,
+				[](size_t, Element*) {},
+				b.getWritePointer(), b.storage(),
+				smallLeft ? &TFT_transform<Field>::TFT_DIT_transposed : &TFT_transform<Field>::TFT_DIF,
+				[](size_t, Element*) {},
+				c.getWritePointer(), c.storage(), &TFT_transform<Field>::TFT_DIF_transposed,
+				[](size_t, const Element*) {});
+		}
+
+	private:
+		void checkFFTPrime (size_t pts) const {
 			if ((_p-1) % pts != 0) {
 				std::cout<<"Error the prime is not a FFTPrime or it has too small power of 2\n";
 				std::cout<<"prime="<<_p<<std::endl;
 				std::cout<<"nbr points="<<pts<<std::endl;
 				throw LinboxError("LinBox ERROR: bad FFT Prime\n");
 			}
-			FFT_transform<Field> FFTer (field(), lpts);
-			FFT_transform<Field> FFTinv(field(), lpts, FFTer.getInvRoot());
-			FFT_PROFILING(1,"init");
-
-			// FFT transformation on the input matrices
-			if (smallLeft){
-				for (size_t i = 0; i < m * k; i++)
-					FFTer.FFT_DIF(&(a(i)[0]));
-				for (size_t i = 0; i < k * n; i++)
-					FFTinv.FFT_DIF(&(b(i)[0]));
-			}
-			else {
-				for (size_t i = 0; i < m * k; i++)
-					FFTinv.FFT_DIF(&(a(i)[0]));
-				for (size_t i = 0; i < k * n; i++)
-					FFTer.FFT_DIF(&(b(i)[0]));
-			}
-			FFT_PROFILING(1,"direct FFT_DIF");
+		}
 
-			// convert the matrix representation to matfirst (with double coefficient)
-			PMatrix vm_c (field(), m, n, pts);
-			PMatrix vm_a (field(), m, k, pts);
-			PMatrix vm_b (field(), k, n, pts);
-			FFT_PROFILING(1,"creation of Matfirst");
-			vm_a.copy(a);
-			vm_b.copy(b);
-			FFT_PROFILING(1,"Polfirst to Matfirst");
+		// p[0..L) = coefficients of the i-th entry of x padded with zeros,
+		// the first r ones in reverse order
+		template<typename Matrix>
+		void load (Element *p, size_t L, const Matrix &x, size_t i, size_t r = 0) const {
+			size_t s = std::min(x.size(), L);
+			for (size_t j = 0; j < r; j++)
+				p[j] = (r-1-j < s) ? x.get(i,r-1-j) : field().zero;
+			for (size_t j = r; j < s; j++)
+				p[j] = x.get(i,j);
+			std::fill(p+std::max(r,s), p+L, field().zero);
+		}
 
-			// Pointwise multiplication
-			for (size_t i = 0; i < pts; ++i)
-				_BMD.mul(vm_c[i], vm_a[i], vm_b[i]);
+		// The product of length L <= 2^lpts of the m x k matrix A by the k x n
+		// matrix B into the m x n matrix C, their entries being stored with
+		// the strides sa, sb and sc. Each stage runs in parallel on the thread
+		// pool: the entries, or the points, are independent.
+		//  - the i-th entry of A is set by loadA(i,p) then transformed by ta
+		//    (the same for B),
+		//  - C may be A or B if it fits in their storage,
+		//  - the i-th entry of C is transformed by tc then given to storeC(i,p).
+		template<typename LoadA, typename LoadB, typename StoreC>
+		void product (size_t L, size_t m, size_t k, size_t n,
+			      Element *A, size_t sa, TFTMethod ta, const LoadA &loadA,
+			      Element *B, size_t sb, TFTMethod tb, const LoadB &loadB,
+			      Element *C, size_t sc, TFTMethod tc, const StoreC &storeC) {
+			FFT_PROFILE_START(1);
+			size_t lpts = 0;
+			while ((1ULL << lpts) < L) lpts++;
+#ifdef FFT_PROFILER
+			if (FFT_PROF_LEVEL==1) std::cout<<"FFT: points "<<L<<" (2^"<<lpts<<")\n";
+#endif
+			checkFFTPrime(1ULL << lpts);
+#ifdef FFT_PROFILER
+			FFT_tables_cache &cache = FFT_tables_cache::instance();
+			uint64_t hits = cache.hits(), misses = cache.misses();
+#endif
+			TFT_transform<Field> T (field(), lpts);
+			FFT_PROFILING(1,"init (twiddles: "+std::to_string(cache.hits()-hits)+" cached, "
+				      +std::to_string(cache.misses()-misses)+" computed)");
+
+			size_t na = m*k, nb = k*n;
+			size_t cost = L*std::max(lpts,(size_t)1);
+			fftParallelRanges(na+nb, cost, [&](size_t first, size_t last) {
+					// working buffer of the task, of size 2^lpts
+					typename TFT_transform<Field>::VECT data(T.size());
+					for (size_t i = first; i < last; i++) {
+						if (i < na) {
+							loadA(i, A+i*sa);
+							(T.*ta)(A+i*sa, L, &data[0]);
+						}
+						else {
+							loadB(i-na, B+(i-na)*sb);
+							(T.*tb)(B+(i-na)*sb, L, &data[0]);
+						}
+					}
+				});
+			FFT_PROFILING(1,"direct transform");
+
+			pointwise(L, m, k, n, A, sa, B, sb, C, sc);
 			FFT_PROFILING(1,"pointwise mult");
 
-			// Transformation into matrix of polynomials (with int32_t coefficient)
-			c.copy(vm_c);
-			FFT_PROFILING(1,"Matfirst to Polfirst");
-
-			// Inverse FFT on the output matrix
-			for (size_t i = 0; i < m * n; i++)
-				FFTer.FFT_DIT(&(c(i)[0]));
-			FFT_PROFILING(1,"inverse FFT_DIT");
+			fftParallelRanges(m*n, cost, [&](size_t first, size_t last) {
+					typename TFT_transform<Field>::VECT data(T.size());
+					for (size_t i = first; i < last; i++) {
+						(T.*tc)(C+i*sc, L, &data[0]);
+						storeC(i, C+i*sc);
+					}
+				});
+			FFT_PROFILING(1,"inverse transform");
+		}
 
-			// Divide by pts = 2^ltps
-			typename Field::Element inv_pts;
-			field().init(inv_pts, pts);
-			field().invin(inv_pts);
-			// for (size_t i = 0; i < m * n; i++)
-			// 	for (size_t j = 0; j < pts; j++)
-			// 		field().mulin(c.ref(i,j), inv_pts);
-			FFLAS::fscalin(field(),c.rowdim()*c.coldim()*c.size(), inv_pts,  c.getWritePointer(),1);
-			FFT_PROFILING(1,"scaling the result");
+		// one matrix product per evaluation point, by blocks of points: the
+		// entries of a block are gathered (polfirst to matfirst), multiplied
+		// and scattered back, so C may share the storage of A or B
+		void pointwise (size_t L, size_t m, size_t k, size_t n,
+				const Element *A, size_t sa, const Element *B, size_t sb,
+				Element *C, size_t sc) {
+			size_t mk = m*k, kn = k*n, mn = m*n;
+			size_t blk = std::max(FFT_PARALLEL_GRAIN / (mk+kn+mn), (size_t)1);
+			fftParallelRanges(L, mk*n, [&](size_t first, size_t last) {
+					std::vector<Element> va(mk*blk), vb(kn*blk), vc(mn*blk);
+					for (size_t i0 = first; i0 < last; i0 += blk) {
+						size_t nbp = std::min(blk, last-i0);
+						for (size_t e = 0; e < mk; e++)
+							for (size_t t = 0; t < nbp; t++)
+								va[t*mk+e] = A[e*sa+i0+t];
+						for (size_t e = 0; e < kn; e++)
+							for (size_t t = 0; t < nbp; t++)
+								vb[t*kn+e] = B[e*sb+i0+t];
+						for (size_t t = 0; t < nbp; t++)
+							FFLAS::fgemm(field(), FFLAS::FflasNoTrans, FFLAS::FflasNoTrans, m, n, k,
+								     field().one, &va[t*mk], k, &vb[t*kn], n,
+								     field().zero, &vc[t*mn], n);
+						for (size_t e = 0; e < mn; e++)
+							for (size_t t = 0; t < nbp; t++)
+								C[e*sc+i0+t] = vc[t*mn+e];
+					}
+				});
 		}
 	}; // end of class special FFT mul domain
 
@@ -70,12 +70,13 @@ namespace LinBox {
 			size_t deg  = a.size()+b.size()-1;
 			size_t lpts = 0;
 			size_t pts  = 1; while (pts < deg) { pts= pts<<1; ++lpts; }
-			// padd the input a and b to 2^lpts (convert to MatrixP representation)
-			MatrixP a2(field(),a.rowdim(),a.coldim(),pts);
-			MatrixP b2(field(),b.rowdim(),b.coldim(),pts);
+			// padd the input a and b to deg (convert to MatrixP representation),
+			// the transforms of length deg < 2^lpts being truncated ones
+			MatrixP a2(field(),a.rowdim(),a.coldim(),deg);
+			MatrixP b2(field(),b.rowdim(),b.coldim(),deg);
 			a2.copy(a,0,a.size()-1);
 			b2.copy(b,0,b.size()-1);
-			MatrixP c2(field(),c.rowdim(),c.coldim(),pts);
+			MatrixP c2(field(),c.rowdim(),c.coldim(),deg);
 			mul_fft (lpts,c2, a2, b2);
 			c.copy(c2,0,deg-1);
 		}
@@ -85,20 +86,19 @@ namespace LinBox {
 			size_t deg  = a.size()+b.size()-1;
 			size_t lpts = 0;
 			size_t pts  = 1; while (pts < deg) { pts= pts<<1; ++lpts; }
-			// padd the input a and b to 2^lpts
-			MatrixP a2(field(),a.rowdim(),a.coldim(),pts);
-			MatrixP b2(field(),b.rowdim(),b.coldim(),pts);
+			// padd the input a and b to deg
+			MatrixP a2(field(),a.rowdim(),a.coldim(),deg);
+			MatrixP b2(field(),b.rowdim(),b.coldim(),deg);
 			a2.copy(a,0,a.size()-1);
 			b2.copy(b,0,b.size()-1);
-			// resize c to 2^lpts
-			c.resize(pts);
-			mul_fft (lpts,c, a2, b2);
 			c.resize(deg);
+			mul_fft (lpts,c, a2, b2);
 		}
 
+		// a,b and c must have the same size, at most 2^lpts
 		void mul_fft (size_t lpts, MatrixP &c, MatrixP &a, MatrixP &b) {
 			size_t pts=c.size();
-			if ((_p-1) % pts == 0){
+			if ((_p-1) % (1ULL << lpts) == 0){
 				PolynomialMatrixFFTPrimeMulDomain<ModField> fftprime_domain (field());
 				fftprime_domain.mul_fft(lpts,c,a,b);
 				return;
@@ -136,36 +136,43 @@ namespace LinBox {
 			for (size_t l=0;l<num_primes;l++)
 				f[l]=ModField(basis[l]);
 	    
-			for (size_t l=0;l<num_primes;l++){
-				PolynomialMatrixFFTPrimeMulDomain<ModField> fftdomain (f[l]);
-				MatrixP ai(f[l],m,k,pts);
-				MatrixP bi(f[l],k,n,pts);
-				FFLAS::fassign(f[l],m*k*pts,a.getPointer(),1,ai.getWritePointer(),1);
-				FFLAS::fassign(f[l],k*n*pts,b.getPointer(),1,bi.getWritePointer(),1);
+			// one product per prime, the primes in parallel
+			for (size_t l=0;l<num_primes;l++)
 				c_i[l] = new MatrixP(f[l], m, n, pts);
-				fftdomain.mul_fft(lpts, *c_i[l], ai, bi);				
-				//std::cout<<"pi:="<<(uint64_t)basis[l]<<std::endl;
-				//std::cout<<"ci:="<<*c_i[l]<<std::endl;
-			}
-	    
-			// reconstruct the result with MRS
-			typename Field::Element alpha;
-			typename Field::Element beta=field().one;
-			FFLAS::freduce(field(),m*n*c.size(),c_i[0]->getPointer(),1,c.getWritePointer(),1);
-			for (size_t i=1;i<num_primes;i++){
+			threadPool().parallelFor(0, num_primes, [&](size_t l) {
+					PolynomialMatrixFFTPrimeMulDomain<ModField> fftdomain (f[l]);
+					MatrixP ai(f[l],m,k,pts);
+					MatrixP bi(f[l],k,n,pts);
+					FFLAS::fassign(f[l],m*k*pts,a.getPointer(),1,ai.getWritePointer(),1);
+					FFLAS::fassign(f[l],k*n*pts,b.getPointer(),1,bi.getWritePointer(),1);
+					fftdomain.mul_fft(lpts, *c_i[l], ai, bi);
+				});
+
+			// reconstruct the result with MRS, by ranges of entries
+			std::vector<typename ModField::Element> alpha(num_primes*num_primes);
+			for (size_t i=1;i<num_primes;i++)
 				for(size_t j=0;j<i;j++){
-					f[i].init(alpha,basis[j]);
-					f[i].invin(alpha);
-					FFLAS::fsubin (f[i],m*n*pts,c_i[j]->getPointer(),1,c_i[i]->getWritePointer(),1);
-					FFLAS::fscalin(f[i],m*n*pts,alpha,c_i[i]->getWritePointer(),1);
+					f[i].init(alpha[i*num_primes+j],basis[j]);
+					f[i].invin(alpha[i*num_primes+j]);
 				}
-				field().mulin(beta,basis[i-1]);
-				FFLAS::faxpy(field(),m*n*pts,beta,c_i[i]->getPointer(),1,c.getWritePointer(),1);
-			}
+			std::vector<typename Field::Element> beta(num_primes,field().one);
+			for (size_t i=1;i<num_primes;i++)
+				field().mul(beta[i],beta[i-1],basis[i-1]);
+			fftParallelRanges(m*n*pts, num_primes*num_primes, [&](size_t first, size_t last) {
+					size_t len=last-first;
+					FFLAS::freduce(field(),len,c_i[0]->getPointer()+first,1,c.getWritePointer()+first,1);
+					for (size_t i=1;i<num_primes;i++){
+						for(size_t j=0;j<i;j++){
+							FFLAS::fsubin (f[i],len,c_i[j]->getPointer()+first,1,c_i[i]->getWritePointer()+first,1);
+							FFLAS::fscalin(f[i],len,alpha[i*num_primes+j],c_i[i]->getWritePointer()+first,1);
+						}
+						FFLAS::faxpy(field(),len,beta[i],c_i[i]->getPointer()+first,1,c.getWritePointer()+first,1);
+					}
+				});
 
 			//std::cout<<"c:="<<c<<std::endl;
 			
-			for (size_t i=1;i<num_primes;i++)
+			for (size_t i=0;i<num_primes;i++)
 				delete c_i[i];
 		}
 
@@ -186,12 +193,15 @@ namespace LinBox {
 
 			size_t lpts = 0;
 			size_t pts  = 1; while (pts < deg) { pts= pts<<1; ++lpts; }
-			// padd the input a and b to 2^lpts (use MatrixP representation)
-			MatrixP a2(field(),a.rowdim(),a.coldim(),pts);
-			MatrixP b2(field(),b.rowdim(),b.coldim(),pts);
-			MatrixP c2(field(),c.rowdim(),c.coldim(),pts);
-			a2.copy(a,0,a.size()-1);
-			b2.copy(b,0,b.size()-1);
+			// the transforms of length L give the c.size() first coefficients
+			// without wrap around, truncated ones if L < 2^lpts
+			size_t L = std::min(hdeg+c.size()-1, pts);
+			// padd the input a and b to L (use MatrixP representation)
+			MatrixP a2(field(),a.rowdim(),a.coldim(),L);
+			MatrixP b2(field(),b.rowdim(),b.coldim(),L);
+			MatrixP c2(field(),c.rowdim(),c.coldim(),L);
+			a2.copy(a,0,std::min(a.size(),L)-1);
+			b2.copy(b,0,std::min(b.size(),L)-1);
 
 			// reverse the element of the smallest polynomial according to h(x^-1)*x^(hdeg)
 			if (smallLeft)
@@ -208,12 +218,12 @@ namespace LinBox {
 		}
 
 		
-		// a,b and c must have size: 2^lpts
+		// a,b and c must have the same size, at most 2^lpts
 		// -> a must have been already reversed according to the midproduct algorithm
 		void midproduct_fft (size_t lpts, MatrixP &c, MatrixP &a, MatrixP &b,
 				     bool smallLeft=true) {
 			size_t pts=c.size();			
-			if ((_p-1) % pts == 0){
+			if ((_p-1) % (1ULL << lpts) == 0){
 				PolynomialMatrixFFTPrimeMulDomain<ModField> fftprime_domain (field());
 				fftprime_domain.midproduct_fft(lpts,c,a,b,smallLeft);
 				return;
@@ -251,36 +261,43 @@ namespace LinBox {
 			for (size_t l=0;l<num_primes;l++)
 				f[l]=ModField(basis[l]);
 	    
-			for (size_t l=0;l<num_primes;l++){
-				PolynomialMatrixFFTPrimeMulDomain<ModField> fftdomain (f[l]);
-				MatrixP ai(f[l],m,k,pts);
-				MatrixP bi(f[l],k,n,pts);
-				FFLAS::fassign(f[l],m*k*pts,a.getPointer(),1,ai.getWritePointer(),1);
-				FFLAS::fassign(f[l],k*n*pts,b.getPointer(),1,bi.getWritePointer(),1);
+			// one product per prime, the primes in parallel
+			for (size_t l=0;l<num_primes;l++)
 				c_i[l] = new MatrixP(f[l], m, n, pts);
-				fftdomain.midproduct_fft(lpts, *c_i[l], ai, bi,smallLeft);				
-				//std::cout<<"pi:="<<(uint64_t)basis[l]<<std::endl;
-				//std::cout<<"ci:="<<*c_i[l]<<std::endl;
-			}
-	    
-			// reconstruct the result with MRS
-			typename Field::Element alpha;
-			typename Field::Element beta=field().one;
-			FFLAS::freduce(field(),m*n*pts,c_i[0]->getPointer(),1,c.getWritePointer(),1);
-			for (size_t i=1;i<num_primes;i++){
+			threadPool().parallelFor(0, num_primes, [&](size_t l) {
+					PolynomialMatrixFFTPrimeMulDomain<ModField> fftdomain (f[l]);
+					MatrixP ai(f[l],m,k,pts);
+					MatrixP bi(f[l],k,n,pts);
+					FFLAS::fassign(f[l],m*k*pts,a.getPointer(),1,ai.getWritePointer(),1);
+					FFLAS::fassign(f[l],k*n*pts,b.getPointer(),1,bi.getWritePointer(),1);
+					fftdomain.midproduct_fft(lpts, *c_i[l], ai, bi,smallLeft);
+				});
+
+			// reconstruct the result with MRS, by ranges of entries
+			std::vector<typename ModField::Element> alpha(num_primes*num_primes);
+			for (size_t i=1;i<num_primes;i++)
 				for(size_t j=0;j<i;j++){
-					f[i].init(alpha,basis[j]);
-					f[i].invin(alpha);
-					FFLAS::fsubin (f[i],m*n*pts,c_i[j]->getPointer(),1,c_i[i]->getWritePointer(),1);
-					FFLAS::fscalin(f[i],m*n*pts,alpha,c_i[i]->getWritePointer(),1);
+					f[i].init(alpha[i*num_primes+j],basis[j]);
+					f[i].invin(alpha[i*num_primes+j]);
 				}
-				field().mulin(beta,basis[i-1]);
-				FFLAS::faxpy(field(),m*n*pts,beta,c_i[i]->getPointer(),1,c.getWritePointer(),1);
-			}
+			std::vector<typename Field::Element> beta(num_primes,field().one);
+			for (size_t i=1;i<num_primes;i++)
+				field().mul(beta[i],beta[i-1],basis[i-1]);
+			fftParallelRanges(m*n*pts, num_primes*num_primes, [&](size_t first, size_t last) {
+					size_t len=last-first;
+					FFLAS::freduce(field(),len,c_i[0]->getPointer()+first,1,c.getWritePointer()+first,1);
+					for (size_t i=1;i<num_primes;i++){
+						for(size_t j=0;j<i;j++){
+							FFLAS::fsubin (f[i],len,c_i[j]->getPointer()+first,1,c_i[i]->getWritePointer()+first,1);
+							FFLAS::fscalin(f[i],len,alpha[i*num_primes+j],c_i[i]->getWritePointer()+first,1);
+						}
+						FFLAS::faxpy(field(),len,beta[i],c_i[i]->getPointer()+first,1,c.getWritePointer()+first,1);
+					}
+				});
 
 			//std::cout<<"c:="<<c<<std::endl;
 			
-			for (size_t i=1;i<num_primes;i++)
+			for (size_t i=0;i<num_primes;i++)
 				delete c_i[i];
 		
 		}
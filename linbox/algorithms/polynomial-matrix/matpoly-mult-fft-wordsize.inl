@@ -49,16 +49,19 @@ namespace LinBox {
         private:
                 const Field            *_field;  // Read only
                 uint64_t                    _p;
+                FFTWorkspace               _ws;  // reused by the FFT prime products only
         public:
                 inline const Field & field() const { return *_field; }
 
                 PolynomialMatrixFFTMulDomain (const Field& F) : _field(&F), _p(F.cardinality()) {}
 
+                FFTWorkspace& workspace() { return _ws; }
+
                 template<typename Matrix1, typename Matrix2, typename Matrix3>
                 void mul (Matrix1 &c, const Matrix2 &a, const Matrix3 &b) {
                         uint64_t pts= 1<<(integer((uint64_t)a.size()+b.size()-1).bitsize());
                         if ( _p< 536870912ULL  &&  ((_p-1) % pts)==0){
-				PolynomialMatrixFFTPrimeMulDomain<Field> MulDom(field());
+				PolynomialMatrixFFTPrimeMulDomain<Field> MulDom(field(), &_ws);
                                 MulDom.mul(c,a,b);
                         }
                         else {
@@ -91,7 +94,7 @@ namespace LinBox {
                         uint64_t pts= 1<<(integer((uint64_t)a.size()+b.size()-1).bitsize());
                         if (_p< 536870912ULL  &&  ((_p-1) % pts)==0){
 				//std::cout<<"MIDP: Staying with FFT Prime Field"<<std::endl;
-                                PolynomialMatrixFFTPrimeMulDomain<Field> MulDom(field());
+                                PolynomialMatrixFFTPrimeMulDomain<Field> MulDom(field(), &_ws);
                                 MulDom.midproduct(c,a,b,smallLeft,n0,n1);
                         }
 			else {
@@ -32,6 +32,9 @@
 #include "linbox/util/error.h"
 #include "linbox/util/debug.h"
 #include "linbox/util/timer.h"
+#include "linbox/util/thread-pool.h"
+#include <algorithm>
+#include <vector>
 
 #include "linbox/integer.h"
 #include <givaro/zring.h>
@@ -43,7 +46,8 @@
 #ifndef FFT_PROF_LEVEL
 int  FFT_PROF_LEVEL=1;
 #endif
-Givaro::Timer mychrono[3];
+// per thread: the per-prime products run in parallel, each with its timers
+thread_local Givaro::Timer mychrono[3];
 #define FFT_PROF_MSG_SIZE 35
 #define FFT_PROFILE_START(lvl)  mychrono[lvl].clear();mychrono[lvl].start();
 
@@ -80,8 +84,80 @@ if ((lvl)>=FFT_PROF_LEVEL) {					\
 #define FFT_DEG_THRESHOLD   4
 #endif
 
+#ifndef FFT_PARALLEL_GRAIN
+// least number of element operations of a parallel task
+#define FFT_PARALLEL_GRAIN  16384
+#endif
+
 namespace LinBox
 {
+	// calls f(first,last) on contiguous ranges covering [0,n), in parallel
+	// on the thread pool; a range holds at least FFT_PARALLEL_GRAIN/cost
+	// indices, where cost is the number of element operations per index
+	template<class Func>
+	inline void fftParallelRanges(size_t n, size_t cost, const Func& f) {
+		if (n == 0)
+			return;
+		size_t grain = std::max(FFT_PARALLEL_GRAIN / std::max(cost, (size_t)1), (size_t)1);
+		size_t nt = std::min((n + grain - 1) / grain, 4 * threadPool().size());
+		if (nt <= 1 || threadPool().size() == 1) {
+			f((size_t)0, n);
+			return;
+		}
+		threadPool().parallelFor(0, nt, [&](size_t t) {
+				f(n * t / nt, n * (t+1) / nt);
+			});
+	}
+
+	// buffers of the FFT products kept from one call to the next: a buffer
+	// only grows, so the products of a recursive algorithm (e.g.
+	// OrderBasis::PM_Basis) stop allocating once the largest one is done.
+	// Only the products over a FFT prime use it: the three primes and the
+	// multiprecision ones still allocate their operands modulo each prime.
+	// A workspace must not be used by two products at the same time.
+	class FFTWorkspace {
+	private:
+		std::vector<std::pair<void*,size_t> > _buf; // (memory, size in bytes)
+
+	public:
+		FFTWorkspace () {}
+		// a copy starts with its own (empty) buffers
+		FFTWorkspace (const FFTWorkspace&) {}
+		FFTWorkspace& operator= (const FFTWorkspace&) { return *this; }
+		~FFTWorkspace () { release(); }
+
+		// buffer number slot, of at least count elements of type T
+		// (uninitialized, its previous content is not kept when it grows)
+		template<class T>
+		T* get (size_t slot, size_t count) {
+			if (_buf.size() <= slot)
+				_buf.resize(slot+1, std::pair<void*,size_t>(NULL,0));
+			size_t bytes = count*sizeof(T);
+			if (_buf[slot].second < bytes) {
+				::operator delete(_buf[slot].first);
+				_buf[slot].first = NULL;
+				_buf[slot].second = 0;
+				_buf[slot].first = ::operator new(bytes);
+				_buf[slot].second = bytes;
+			}
+			return static_cast<T*>(_buf[slot].first);
+		}
+
+		// memory held, in bytes
+		size_t memory () const {
+			size_t s = 0;
+			for (size_t i = 0; i < _buf.size(); i++)
+				s += _buf[i].second;
+			return s;
+		}
+
+		void release () {
+			for (size_t i = 0; i < _buf.size(); i++)
+				::operator delete(_buf[i].first);
+			_buf.clear();
+		}
+	};
+
 	// generic handler for multiplication using FFT
 	template <class Field>
 	class PolynomialMatrixFFTMulDomain {
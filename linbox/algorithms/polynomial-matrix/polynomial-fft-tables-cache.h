@@ -0,0 +1,153 @@
+/* -*- mode: C++; tab-width: 8; indent-tabs-mode: t; c-basic-offset: 8 -*- */
+/*
+ * Copyright (C) the LinBox group
+ *
+ * ========LICENCE========
+ * This file is part of the library LinBox.
+ *
+ * LinBox is free software: you can redistribute it and/or modify
+ * it under the terms of the  GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ * ========LICENCE========
+ */
+
+#ifndef __LINBOX_polynomial_fft_tables_cache_H
+#define __LINBOX_polynomial_fft_tables_cache_H
+
+#include <cstdint>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <tuple>
+#include <vector>
+#include "fflas-ffpack/utils/align-allocator.h"
+
+#ifndef FFT_TABLES_CACHE_LOG
+// log of the largest transform whose tables fit in the default cap
+#define FFT_TABLES_CACHE_LOG 21
+#endif
+
+#ifndef FFT_TABLES_CACHE_SIZE
+// default memory cap of the cache of twiddle tables, in bytes: a
+// TFT_transform of 2^ln points caches at most 12*2^ln words (its tables,
+// the ones of its sub-transforms and the scaled ones), i.e. 96MB for the
+// products of 2^21 points. The three primes products hold three of them,
+// larger products keep working but miss the cache (see setMaxMemory).
+#define FFT_TABLES_CACHE_SIZE (48ULL << FFT_TABLES_CACHE_LOG)
+#endif
+
+namespace LinBox {
+
+	// twiddle table of a transform of size 2^ln over Fp with the root w
+	// (see FFT_transform::pow_w) and its Shoup precomputations
+	struct FFT_tables {
+		typedef std::vector<uint32_t,AlignedAllocator<uint32_t, Alignment::DEFAULT> > VECT;
+		uint32_t    w, invw;
+		VECT  pow_w, pow_wp;
+
+		FFT_tables (size_t s) : w(0), invw(0), pow_w(s), pow_wp(s) {}
+		size_t memory () const { return (pow_w.size()+pow_wp.size())*sizeof(uint32_t); }
+	};
+
+	// Process-wide cache of the FFT_tables, keyed by (prime, log size,
+	// root, kind), with a LRU eviction when the tables held go over the
+	// memory cap. The kind tells apart the tables derived from the same
+	// twiddles (e.g. the scaled ones of TFT_transform). A table in use is
+	// shared: evicting it only drops the reference of the cache.
+	class FFT_tables_cache {
+	public:
+		enum Kind { Twiddles = 0, Doubled = 1, Halved = 2 };
+		typedef std::tuple<uint64_t,size_t,uint32_t,int>   Key;
+		typedef std::shared_ptr<FFT_tables>             Tables;
+
+	private:
+		typedef std::list<std::pair<Key,Tables> > List;
+		std::mutex                 _mutex;
+		List                         _lru; // most recently used first
+		std::map<Key,List::iterator> _map;
+		size_t            _memory, _maxmem;
+		uint64_t            _hits, _misses;
+
+		FFT_tables_cache () : _memory(0), _maxmem(FFT_TABLES_CACHE_SIZE), _hits(0), _misses(0) {}
+
+		void evict () {
+			while (_memory > _maxmem && !_lru.empty()) {
+				_memory -= _lru.back().second->memory();
+				_map.erase(_lru.back().first);
+				_lru.pop_back();
+			}
+		}
+
+	public:
+		static FFT_tables_cache& instance () {
+			static FFT_tables_cache cache;
+			return cache;
+		}
+
+		// the tables of key k if they are cached (counted as a hit), NULL otherwise (a miss)
+		Tables find (const Key &k) {
+			std::lock_guard<std::mutex> lock(_mutex);
+			std::map<Key,List::iterator>::iterator it = _map.find(k);
+			if (it == _map.end()) {
+				_misses++;
+				return Tables();
+			}
+			_hits++;
+			_lru.splice(_lru.begin(), _lru, it->second);
+			return it->second->second;
+		}
+
+		// caches t under the key k and returns it, or the tables cached
+		// meanwhile by another thread
+		Tables insert (const Key &k, const Tables &t) {
+			std::lock_guard<std::mutex> lock(_mutex);
+			std::map<Key,List::iterator>::iterator it = _map.find(k);
+			if (it != _map.end())
+				return it->second->second;
+			_lru.push_front(std::make_pair(k, t));
+			_map[k] = _lru.begin();
+			_memory += t->memory();
+			evict();
+			return t;
+		}
+
+		void setMaxMemory (size_t bytes) {
+			std::lock_guard<std::mutex> lock(_mutex);
+			_maxmem = bytes;
+			evict();
+		}
+
+		void clear () {
+			std::lock_guard<std::mutex> lock(_mutex);
+			_lru.clear();
+			_map.clear();
+			_memory = 0;
+		}
+
+		size_t   memory () { std::lock_guard<std::mutex> lock(_mutex); return _memory; }
+		uint64_t   hits () { std::lock_guard<std::mutex> lock(_mutex); return _hits; }
+		uint64_t misses () { std::lock_guard<std::mutex> lock(_mutex); return _misses; }
+	};
+
+} // end of namespace LinBox
+
+#endif // __LINBOX_polynomial_fft_tables_cache_H
+
+// vim:sts=8:sw=8:ts=8:noet:sr:cino=>s,f0,{0,g0,(0,:0,t0,+0,=s
+// Local Variables:
+// mode: C++
+// tab-width: 8
+// indent-tabs-mode: t
+// c-basic-offset: 8
+// End:
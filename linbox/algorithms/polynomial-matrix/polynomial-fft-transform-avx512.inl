@@ -0,0 +1,292 @@
+/* -*- mode: C++; tab-width: 8; indent-tabs-mode: t; c-basic-offset: 8 -*- */
+/*
+ * Copyright (C) the LinBox group
+ *
+ * ========LICENCE========
+ * This file is part of the library LinBox.
+ *
+ * LinBox is free software: you can redistribute it and/or modify
+ * it under the terms of the  GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ * ========LICENCE========
+ */
+
+
+#ifndef __LINBOX_polynomial_fft_transform_avx512_INL
+#define __LINBOX_polynomial_fft_transform_avx512_INL
+
+#include "linbox/algorithms/polynomial-matrix/simd.h"
+
+namespace LinBox {
+
+
+	/******************************************************************************************************************
+	 ******************************************************************************************************************
+	 ***********************************   FFT with AVX-512 CODE  *****************************************************
+	 ******************************************************************************************************************
+	 ******************************************************************************************************************/
+
+	// The four butterfly steps of width 8, 4, 2 and 1 are done on blocks
+	// of 32 entries held in two registers [0..15] [16..31]: for each step,
+	// the first and second entries of the butterflies are gathered in two
+	// registers (lo, hi), then scattered back (merge1, merge2).
+	// AVX512_STEP_IDX[s] holds lo, hi, merge1, merge2 for the width 8>>s.
+	struct FFT_AVX512_Permutations {
+		uint32_t idx[4][4][16];
+
+		FFT_AVX512_Permutations() {
+			for (size_t s = 0; s < 4; s++) {
+				size_t w = 8 >> s;
+				for (size_t t = 0; t < 16; t++) {
+					idx[s][0][t] = (uint32_t)(2*(t/w)*w + t%w);
+					idx[s][1][t] = (uint32_t)(2*(t/w)*w + t%w + w);
+				}
+				for (size_t x = 0; x < 32; x++) {
+					size_t t = (x/(2*w))*w + x%w;
+					bool fromHi = (x % (2*w)) >= w;
+					idx[s][2+x/16][x%16] = (uint32_t)(t + (fromHi ? 16 : 0));
+				}
+			}
+		}
+
+		static const FFT_AVX512_Permutations& get() {
+			static const FFT_AVX512_Permutations perm;
+			return perm;
+		}
+	};
+
+	template <class Field>
+	__LINBOX_AVX512_TARGET
+	inline void FFT_transform<Field>::reduce512_modp(uint32_t* ABCD, const _vect512_t& P) {
+		_vect512_t V1;
+		VEC512_LOADU(V1,ABCD);
+		VEC512_MOD_P(V1,V1,P);
+		VEC512_STOREU(ABCD,V1);
+	}
+
+	// twiddles of the steps of width 8, 4, 2, 1, lane t using tab[t % w],
+	// the tables of the steps being at tab_w[s], tab_wp[s]
+	template <class Field>
+	__LINBOX_AVX512_TARGET
+	inline void FFT_transform<Field>::twiddles_AVX512(_vect512_t* W, _vect512_t* Wp,
+							   const uint32_t* const* tab_w, const uint32_t* const* tab_wp) {
+		alignas(64) uint32_t tmp[16];
+		for (size_t s = 0; s < 4; s++) {
+			size_t w = 8 >> s;
+			for (size_t t = 0; t < 16; t++) tmp[t] = tab_w[s][t % w];
+			VEC512_LOAD(W[s],tmp);
+			for (size_t t = 0; t < 16; t++) tmp[t] = tab_wp[s][t % w];
+			VEC512_LOAD(Wp[s],tmp);
+		}
+	}
+
+	/*---------------------------------------------------*/
+	/*--  implementation of DIF with 512-bits AVX    ----*/
+	/*---------------------------------------------------*/
+
+	template <class Field>
+	__LINBOX_AVX512_TARGET
+	inline void FFT_transform<Field>::Butterfly_DIF_mod2p_16x1_AVX512(uint32_t* A, uint32_t* B,
+									   const uint32_t* alpha,
+									   const uint32_t* alphap,
+									   const _vect512_t& P, const _vect512_t& P2) {
+		_vect512_t V1,V2,V3,V4,W,Wp,T,Q,T1,T2;
+		// V1=A[0..15], V2=B[0..15]
+		VEC512_LOADU(V1,A);
+		VEC512_LOADU(V2,B);
+		VEC512_LOADU(W ,alpha);
+		VEC512_LOADU(Wp,alphap);
+
+		// V3 = V1 + V2 mod 2P
+		VEC512_ADD_MOD(V3,V1,V2,P2);
+		VEC512_STOREU(A,V3);
+
+		// V4 = (V1+(2P-V2))alpha mod 2P
+		VEC512_SUB_32(T,V2,P2);
+		VEC512_SUB_32(V4,V1,T);
+		VEC512_MUL_MOD(T,V4,W,P,Wp,Q,T1,T2);
+		VEC512_STOREU(B,T);
+	}
+
+	template <class Field>
+	__LINBOX_AVX512_TARGET
+	inline void FFT_transform<Field>::Butterfly_DIF_mod2p_16x4_AVX512_last4step(uint32_t* A, uint32_t* B,
+										     const _vect512_t* W, const _vect512_t* Wp,
+										     const _vect512_t& P, const _vect512_t& P2) {
+		const FFT_AVX512_Permutations& perm = FFT_AVX512_Permutations::get();
+		_vect512_t V1,V2,X,Y,S,D,I,Q,T1,T2;
+		// V1=A[0..15], V2=A[16..31] (B = A+16)
+		VEC512_LOADU(V1,A);
+		VEC512_LOADU(V2,B);
+		for (size_t s = 0; s < 4; s++) {
+			// X, Y = first and second entries of the butterflies of width 8>>s
+			VEC512_LOADU(I,perm.idx[s][0]);
+			VEC512_PERMUTE2_32(X,V1,I,V2);
+			VEC512_LOADU(I,perm.idx[s][1]);
+			VEC512_PERMUTE2_32(Y,V1,I,V2);
+			// S = X + Y mod 2P
+			VEC512_ADD_MOD(S,X,Y,P2);
+			// D = (X+(2P-Y))alpha mod 2P
+			VEC512_SUB_32(T1,Y,P2);
+			VEC512_SUB_32(T2,X,T1);
+			VEC512_MUL_MOD(D,T2,W[s],P,Wp[s],Q,T1,X);
+			// back to the order of the entries
+			VEC512_LOADU(I,perm.idx[s][2]);
+			VEC512_PERMUTE2_32(V1,S,I,D);
+			VEC512_LOADU(I,perm.idx[s][3]);
+			VEC512_PERMUTE2_32(V2,S,I,D);
+		}
+		VEC512_STOREU(A,V1);
+		VEC512_STOREU(B,V2);
+	}
+
+	template <class Field>
+	__LINBOX_AVX512_TARGET
+	void FFT_transform<Field>::FFT_DIF_Harvey_mod2p_iterative16x1_AVX512 (uint32_t *fft) {
+		_vect512_t P,P2;
+		VEC512_SET_32(P,_pl);
+		VEC512_SET_32(P2,_dpl);
+
+		uint32_t * tab_w = &pow_w [0];
+		uint32_t * tab_wp= &pow_wp[0];
+		size_t w, f;
+		for (w = n >> 1, f = 1; w >= 16; tab_w+=w, tab_wp+=w, w >>= 1, f <<= 1){
+			// w : witdh of butterflies
+			// f : # families of butterflies
+			for (size_t i = 0; i < f; i++)
+				for (size_t j = 0; j < w; j+=16)
+#define A0 &fft[0] +  (i << 1)   *w+ j
+#define A4 &fft[0] + ((i << 1)+1)*w+ j
+					Butterfly_DIF_mod2p_16x1_AVX512(A0,A4, tab_w+j,tab_wp+j,P,P2);
+#undef A0
+#undef A4
+		}
+		// Last four steps (w=8,4,2,1), on blocks of 32 entries
+		const uint32_t* step_w [4] = {tab_w , tab_w +8, tab_w +12, tab_w +14};
+		const uint32_t* step_wp[4] = {tab_wp, tab_wp+8, tab_wp+12, tab_wp+14};
+		_vect512_t W[4],Wp[4];
+		twiddles_AVX512(W,Wp,step_w,step_wp);
+		for (size_t i = 0; i < n; i+=32)
+			Butterfly_DIF_mod2p_16x4_AVX512_last4step(&fft[i],&fft[i+16],W,Wp,P,P2);
+
+		// mod 2P -> mod P
+		for (size_t i = 0; i < n; i += 16)
+			reduce512_modp(fft+i,P);
+	}
+
+	/*---------------------------------------------------*/
+	/*--  implementation of DIT with 512-bits AVX    ----*/
+	/*---------------------------------------------------*/
+
+	template <class Field>
+	__LINBOX_AVX512_TARGET
+	inline void FFT_transform<Field>::Butterfly_DIT_mod4p_16x1_AVX512(uint32_t* A, uint32_t* B,
+									   const uint32_t* alpha,
+									   const uint32_t* alphap,
+									   const _vect512_t& P, const _vect512_t& P2) {
+		_vect512_t V1,V2,V3,V4,W,Wp,Q,T1,T2;
+		// V1=A[0..15], V2=B[0..15]
+		VEC512_LOADU(V1,A);
+		VEC512_LOADU(V2,B);
+		VEC512_LOADU(W ,alpha);
+		VEC512_LOADU(Wp,alphap);
+
+		// V3 = V1 mod 2P
+		VEC512_MOD_P(V3,V1,P2);
+
+		// V4 = V2 * W mod P
+		VEC512_MUL_MOD(V4,V2,W,P,Wp,Q,T1,T2);
+
+		// V1 = V3 + V4
+		VEC512_ADD_32(V1,V3,V4);
+		VEC512_STOREU(A,V1);
+
+		// V2 = V3 - (V4 - 2P)
+		VEC512_SUB_32(T1,V4,P2);
+		VEC512_SUB_32(V2,V3,T1);
+		VEC512_STOREU(B,V2);
+	}
+
+	template <class Field>
+	__LINBOX_AVX512_TARGET
+	inline void FFT_transform<Field>::Butterfly_DIT_mod4p_16x4_AVX512_first4step(uint32_t* A, uint32_t* B,
+										      const _vect512_t* W, const _vect512_t* Wp,
+										      const _vect512_t& P, const _vect512_t& P2) {
+		const FFT_AVX512_Permutations& perm = FFT_AVX512_Permutations::get();
+		_vect512_t V1,V2,X,Y,S,D,I,Q,T1,T2;
+		// V1=A[0..15], V2=A[16..31] (B = A+16)
+		VEC512_LOADU(V1,A);
+		VEC512_LOADU(V2,B);
+		for (size_t s = 4; s-- > 0; ) {
+			// X, Y = first and second entries of the butterflies of width 8>>s
+			VEC512_LOADU(I,perm.idx[s][0]);
+			VEC512_PERMUTE2_32(X,V1,I,V2);
+			VEC512_LOADU(I,perm.idx[s][1]);
+			VEC512_PERMUTE2_32(Y,V1,I,V2);
+			// X = X mod 2P
+			VEC512_MOD_P(X,X,P2);
+			// Y = Y * alpha mod P
+			VEC512_MUL_MOD(D,Y,W[s],P,Wp[s],Q,T1,T2);
+			// S = X + Y, D = X - (Y - 2P)
+			VEC512_ADD_32(S,X,D);
+			VEC512_SUB_32(T1,D,P2);
+			VEC512_SUB_32(D,X,T1);
+			// back to the order of the entries
+			VEC512_LOADU(I,perm.idx[s][2]);
+			VEC512_PERMUTE2_32(V1,S,I,D);
+			VEC512_LOADU(I,perm.idx[s][3]);
+			VEC512_PERMUTE2_32(V2,S,I,D);
+		}
+		VEC512_STOREU(A,V1);
+		VEC512_STOREU(B,V2);
+	}
+
+	template <class Field>
+	__LINBOX_AVX512_TARGET
+	void FFT_transform<Field>::FFT_DIT_Harvey_mod4p_iterative16x1_AVX512 (uint32_t *fft) {
+		_vect512_t P,P2;
+		VEC512_SET_32(P,_pl);
+		VEC512_SET_32(P2,_dpl);
+
+		// first four steps (w=1,2,4,8), on blocks of 32 entries
+		const uint32_t* step_w [4] = {&pow_w [n-16], &pow_w [n-8], &pow_w [n-4], &pow_w [n-2]};
+		const uint32_t* step_wp[4] = {&pow_wp[n-16], &pow_wp[n-8], &pow_wp[n-4], &pow_wp[n-2]};
+		_vect512_t W[4],Wp[4];
+		twiddles_AVX512(W,Wp,step_w,step_wp);
+		for (size_t i = 0; i < n; i+=32)
+			Butterfly_DIT_mod4p_16x4_AVX512_first4step(&fft[i],&fft[i+16],W,Wp,P,P2);
+
+		uint32_t * tab_w = &pow_w [n-32];
+		uint32_t * tab_wp= &pow_wp[n-32];
+		for (size_t w = 16, f = n >> 5; f >= 1; w <<= 1, f >>= 1, tab_w-=w, tab_wp-=w){
+			// w : witdh of butterflies
+			// f : # families of butterflies
+			for (size_t i = 0; i < f; i++)
+				for (size_t j = 0; j < w; j+=16)
+#define A0 &fft[0] +  (i << 1)   *w+ j
+#define A4 &fft[0] + ((i << 1)+1)*w+ j
+					Butterfly_DIT_mod4p_16x1_AVX512(A0,A4, tab_w+j,tab_wp+j,P,P2);
+#undef A0
+#undef A4
+		}
+
+		// mod 4P -> mod P
+		for (size_t i = 0; i < n; i += 16){
+			reduce512_modp(fft+i,P2);
+			reduce512_modp(fft+i,P);
+		}
+	}
+
+} // end of namespace LinBox
+
+#endif //end of file
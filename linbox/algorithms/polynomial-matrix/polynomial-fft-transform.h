@@ -33,6 +33,7 @@
 #include "linbox/algorithms/polynomial-matrix/simd.h"
 #include "linbox/util/debug.h"
 #include "givaro/givinteger.h"
+#include "linbox/algorithms/polynomial-matrix/polynomial-fft-tables-cache.h"
 
 // template<typename T>
 // std::ostream& operator<<(std::ostream& os, const std::vector<T> &x){
@@ -61,9 +62,10 @@ namespace LinBox {
 		//double                    _pinv;
 		uint32_t                      _w;
 		uint32_t                   _invw;
-		typedef std::vector<uint32_t,AlignedAllocator<uint32_t, Alignment::DEFAULT> > VECT;
-		VECT    pow_w;
-		VECT   pow_wp; // Precomputations in shoup
+		typedef FFT_tables::VECT VECT;
+		FFT_tables_cache::Tables _tables; // shared with FFT_tables_cache
+		VECT   &pow_w;
+		VECT  &pow_wp; // Precomputations in shoup
 		VECT    _data;
 		Element                      _p;
 		//   pow_w = table of roots of unity. If w = primitive K-th root, then the table is:
@@ -103,14 +105,25 @@ namespace LinBox {
 		}
 
 		FFT_transform (const Field& fld2, size_t ln2, Element w = 0)
-			: fld (&fld2), n ((1U << ln2)), ln (ln2), pow_w(n - 1), pow_wp(n - 1), _data(n) {
-			_pl = fld->characteristic();
-			_p  = fld->characteristic();
+			: fld (&fld2), _pl(fld2.characteristic()), _dpl(_pl << 1), n ((1U << ln2)), ln (ln2),
+			  _tables(tables((uint32_t)w)), pow_w(_tables->pow_w), pow_wp(_tables->pow_wp), _data(n),
+			  _p(fld2.characteristic()) {
+			_w    = _tables->w;
+			_invw = _tables->invw;
+		}
 
+		// the twiddle tables for the root w (0: a root is chosen), from
+		// FFT_tables_cache if they are there
+		FFT_tables_cache::Tables tables (uint32_t w) {
 			linbox_check((_pl >> 29) == 0 ); // 8*p < 2^31 for Harvey's butterflies
-			_dpl = (_pl << 1);
 			//_pinv = 1 / (double) _pl;
-							
+
+			FFT_tables_cache &cache = FFT_tables_cache::instance();
+			FFT_tables_cache::Key key(_pl, ln, w, FFT_tables_cache::Twiddles);
+			FFT_tables_cache::Tables T = cache.find(key);
+			if (T)
+				return T;
+			T = std::make_shared<FFT_tables>(n - 1);
 			if (w == 0){   // find a pseudo 2^lpts-th primitive root of unity
 				uint64_t _val2p = 0;
 				uint64_t     _m = _pl;
@@ -126,24 +139,24 @@ namespace LinBox {
 				}
 				//_I = (1L << (_logp << 1)) / _pl;
 				uint64_t _gen = find_gen (_m, _val2p);
-				_w = Givaro::powmod(_gen, 1<<(_val2p-ln), _pl);
+				T->w = Givaro::powmod(_gen, 1<<(_val2p-ln), _pl);
 			}
 			else {
-				_w = (uint32_t)w;
+				T->w = w;
 			}
-			
+
 			// compute w^(-1) mod p = w^(2^lpts - 1)
-			_invw = Givaro::powmod(_w, (1<<ln) - 1, _pl);
-			
+			T->invw = Givaro::powmod(T->w, (1<<ln) - 1, _pl);
+
 			size_t pos = 0;
 			uint64_t wi = 1;
-			uint64_t __w = _w;
+			uint64_t __w = T->w;
 			if (ln>0){
 				size_t tpts = 1 << (ln - 1);
 				while (tpts > 0) {
 					for (size_t i = 0; i < tpts; i++, pos++) {
-						pow_w[pos] = wi;
-						pow_wp[pos] = ((uint64_t) pow_w[pos] << 32UL) / _pl;
+						T->pow_w[pos] = wi;
+						T->pow_wp[pos] = ((uint64_t) T->pow_w[pos] << 32UL) / _pl;
 						wi= (wi*__w)%_pl;
 						//field().mulin(wi, __w);
 					}
@@ -153,6 +166,7 @@ namespace LinBox {
 					tpts >>= 1;
 				}
 			}
+			return cache.insert(key, T);
 		}
 
 
@@ -161,6 +175,12 @@ namespace LinBox {
 
 		
 		void FFT_DIF_Harvey (uint32_t *fft) {			
+#ifdef __LINBOX_FFT_AVX512_DISPATCH
+			if (n >= 32 && simd512Available()) {
+				FFT_DIF_Harvey_mod2p_iterative16x1_AVX512(fft);
+				return;
+			}
+#endif
 #ifdef __LINBOX_USE_SIMD
 #ifdef __AVX2__
 			FFT_DIF_Harvey_mod2p_iterative8x1_AVX(fft);
@@ -194,6 +214,12 @@ namespace LinBox {
 		}
 		
 		void FFT_DIT_Harvey (uint32_t *fft) {
+#ifdef __LINBOX_FFT_AVX512_DISPATCH
+			if (n >= 32 && simd512Available()) {
+				FFT_DIT_Harvey_mod4p_iterative16x1_AVX512(fft);
+				return;
+			}
+#endif
 #ifdef __LINBOX_USE_SIMD
 #ifdef __AVX2__
 			FFT_DIT_Harvey_mod4p_iterative8x1_AVX(fft);
@@ -245,28 +271,51 @@ namespace LinBox {
 		FFT_DIT (T *fft) {
 			FFT_DIT_Harvey(fft);
 		}
-		
-		// FFT with conversion from Element to uint32_t		
+		template <class T=Element>
+		typename std::enable_if<std::is_same<T,uint32_t>::value>::type
+		FFT_DIF (T *fft, uint32_t *) {
+			FFT_DIF_Harvey(fft);
+		}
+		template <class T=Element>
+		typename std::enable_if<std::is_same<T,uint32_t>::value>::type
+		FFT_DIT (T *fft, uint32_t *) {
+			FFT_DIT_Harvey(fft);
+		}
+
+		// FFT with conversion from Element to uint32_t
+		// (through _data: one transform at a time)
 		template <typename T=Element>
 		typename std::enable_if<!std::is_same<T,uint32_t>::value>::type
 		FFT_DIF (T *fft) {
+			FFT_DIF(fft, &_data[0]);
+		}
+		template <typename T=Element>
+		typename std::enable_if<!std::is_same<T,uint32_t>::value>::type
+		FFT_DIT (T *fft) {
+			FFT_DIT(fft, &_data[0]);
+		}
+
+		// FFT with conversion from Element to uint32_t through data,
+		// an aligned buffer of n words owned by the calling thread
+		template <typename T=Element>
+		typename std::enable_if<!std::is_same<T,uint32_t>::value>::type
+		FFT_DIF (T *fft, uint32_t *data) {
 			for(uint64_t i=0;i<n;i++)
-				_data[i]=fft[i];
-			FFT_DIF_Harvey(&_data[0]);
+				data[i]=fft[i];
+			FFT_DIF_Harvey(data);
 			for(uint64_t i=0;i<n;i++)
-				fft[i]=_data[i];
-			
+				fft[i]=data[i];
 		}
 		template <typename T=Element>
 		typename std::enable_if<!std::is_same<T,uint32_t>::value>::type
-		FFT_DIT (T *fft) {
+		FFT_DIT (T *fft, uint32_t *data) {
 			for(uint64_t i=0;i<n;i++)
-				_data[i]=fft[i];
-			FFT_DIT_Harvey(&_data[0]);
+				data[i]=fft[i];
+			FFT_DIT_Harvey(data);
 			for(uint64_t i=0;i<n;i++)
-				fft[i]=_data[i];			
+				fft[i]=data[i];
 		}
-				
+
 		/*
 		 * Different implementations for the butterfly operations
 		 */
@@ -299,6 +348,19 @@ namespace LinBox {
 								   const __m256i& beta ,const __m256i& betap, const __m256i& P    ,const __m256i& P2);
 
 
+#endif
+#ifdef __LINBOX_FFT_AVX512_DISPATCH
+		__LINBOX_AVX512_TARGET inline void reduce512_modp(uint32_t*, const _vect512_t&);
+		__LINBOX_AVX512_TARGET inline void twiddles_AVX512(_vect512_t* W, _vect512_t* Wp,
+								   const uint32_t* const* tab_w, const uint32_t* const* tab_wp);
+		__LINBOX_AVX512_TARGET inline void Butterfly_DIF_mod2p_16x1_AVX512(uint32_t* A, uint32_t* B, const uint32_t* alpha,const uint32_t* alphap,
+										   const _vect512_t& P, const _vect512_t& P2);
+		__LINBOX_AVX512_TARGET inline void Butterfly_DIF_mod2p_16x4_AVX512_last4step(uint32_t* A, uint32_t* B, const _vect512_t* W, const _vect512_t* Wp,
+											     const _vect512_t& P, const _vect512_t& P2);
+		__LINBOX_AVX512_TARGET inline void Butterfly_DIT_mod4p_16x1_AVX512(uint32_t* A, uint32_t* B, const uint32_t* alpha,const uint32_t* alphap,
+										   const _vect512_t& P, const _vect512_t& P2);
+		__LINBOX_AVX512_TARGET inline void Butterfly_DIT_mod4p_16x4_AVX512_first4step(uint32_t* A, uint32_t* B, const _vect512_t* W, const _vect512_t* Wp,
+											      const _vect512_t& P, const _vect512_t& P2);
 #endif
 
 		/*
@@ -318,6 +380,11 @@ namespace LinBox {
 		void FFT_DIF_Harvey_mod2p_iterative8x1_AVX (uint32_t *fft);
 		void FFT_DIT_Harvey_mod4p_iterative8x1_AVX (uint32_t *fft);
 #endif
+#ifdef __LINBOX_FFT_AVX512_DISPATCH
+		// output reduced mod p, n >= 32
+		__LINBOX_AVX512_TARGET void FFT_DIF_Harvey_mod2p_iterative16x1_AVX512 (uint32_t *fft);
+		__LINBOX_AVX512_TARGET void FFT_DIT_Harvey_mod4p_iterative16x1_AVX512 (uint32_t *fft);
+#endif
 
 	};
 } // end of namespace LinBox
@@ -326,6 +393,9 @@ namespace LinBox {
 #ifdef __LINBOX_USE_SIMD
 #include "linbox/algorithms/polynomial-matrix/polynomial-fft-transform-simd.inl"
 #endif
+#ifdef __LINBOX_FFT_AVX512_DISPATCH
+#include "linbox/algorithms/polynomial-matrix/polynomial-fft-transform-avx512.inl"
+#endif
 #endif // __LINBOX_FFT_H
 
 
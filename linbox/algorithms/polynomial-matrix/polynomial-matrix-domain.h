@@ -41,6 +41,7 @@ namespace LinBox
 	class PolynomialMatrixMulDomain {
 	public:
 		PolynomialMatrixKaraDomain<Field>       _kara;
+		// keeps the workspace of the FFT products from one call to the next
 		PolynomialMatrixFFTMulDomain<Field>      _fft;
 		PolynomialMatrixNaiveMulDomain<Field>  _naive;
 		const Field*                           _field;
@@ -0,0 +1,437 @@
+/* -*- mode: C++; tab-width: 8; indent-tabs-mode: t; c-basic-offset: 8 -*- */
+/*
+ * Copyright (C) the LinBox group
+ *
+ * ========LICENCE========
+ * This file is part of the library LinBox.
+ *
+ * LinBox is free software: you can redistribute it and/or modify
+ * it under the terms of the  GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ * ========LICENCE========
+ */
+
+#ifndef __LINBOX_polynomial_tft_transform_H
+#define __LINBOX_polynomial_tft_transform_H
+
+#include <vector>
+#include "linbox/algorithms/polynomial-matrix/polynomial-fft-transform.h"
+
+#ifndef TFT_FULL_LOG
+// full transforms of size 2^TFT_FULL_LOG and more go through FFT_transform
+#define TFT_FULL_LOG 5
+#endif
+
+namespace LinBox {
+
+	// class to handle the truncated Fourier transform (TFT, van der Hoeven)
+	// of length L <= 2^ln over wordsize prime field Fp (p < 2^29).
+	//
+	// The L evaluation points are the first L points of FFT_transform::FFT_DIF
+	// of size n=2^ln (bit-reversed order). The transforms are pruned FFTs:
+	// a step of width n/2 is followed by a full FFT on the first half and a
+	// TFT of length L-n/2 on the second half, so the cost is O(L log L + n)
+	// instead of O(n log n). The full FFTs are done by FFT_transform objects
+	// of size 2^k sharing the root of unity.
+	//
+	// All the transforms work in a buffer data of n words, aligned as
+	// FFT_transform::VECT and owned by the calling thread.
+	template <class Field>
+	class TFT_transform {
+	public:
+		typedef typename Field::Element Element;
+		typedef typename FFT_transform<Field>::VECT VECT;
+
+	private:
+		const Field                 *fld;
+		uint64_t                     _pl;
+		uint64_t                       n;
+		uint64_t                      ln;
+		// transforms of size n with root w and 1/w: their tables hold
+		// the twiddles of all the steps
+		FFT_transform<Field>        _fwd;
+		FFT_transform<Field>        _inv;
+		// transforms of size 2^k, TFT_FULL_LOG <= k < ln, with root w^(n/2^k)
+		std::vector<FFT_transform<Field> > _sub_fwd, _sub_inv;
+		// 2w_M^i and w_M^-i/2 laid out as the twiddles of FFT_transform
+		// (and their Shoup precomputations), shared through FFT_tables_cache
+		FFT_tables_cache::Tables _w2, _wi2;
+		std::vector<uint32_t>    _inv2k, _inv2kp; // 1/2^k mod p
+
+	public:
+		inline const Field & field() const { return *fld; }
+
+		TFT_transform (const Field& fld2, size_t ln2, Element w = 0)
+			: fld(&fld2), _pl(fld2.characteristic()), n(1ULL << ln2), ln(ln2),
+			  _fwd(fld2, ln2, w), _inv(fld2, ln2, _fwd.getInvRoot()),
+			  _inv2k(ln2+1), _inv2kp(ln2+1) {
+			if (ln > TFT_FULL_LOG) {
+				_sub_fwd.reserve(ln - TFT_FULL_LOG);
+				_sub_inv.reserve(ln - TFT_FULL_LOG);
+			}
+			for (size_t k = TFT_FULL_LOG; k < ln; k++) {
+				_sub_fwd.emplace_back(fld2, k, (Element)Givaro::powmod(_fwd.getRoot()   , 1ULL << (ln-k), _pl));
+				_sub_inv.emplace_back(fld2, k, (Element)Givaro::powmod(_fwd.getInvRoot(), 1ULL << (ln-k), _pl));
+			}
+			uint64_t inv2 = (_pl + 1) >> 1;
+			_inv2k[0] = 1;
+			for (size_t k = 1; k <= ln; k++)
+				_inv2k[k] = (uint32_t)(_inv2k[k-1] * inv2 % _pl);
+			for (size_t k = 0; k <= ln; k++)
+				_inv2kp[k] = (uint32_t)(((uint64_t)_inv2k[k] << 32) / _pl);
+			_w2  = scaled(_fwd, 2, FFT_tables_cache::Doubled);
+			_wi2 = scaled(_inv, (uint32_t)inv2, FFT_tables_cache::Halved);
+		}
+
+		size_t size() const { return n; }
+		uint32_t getRoot() const { return _fwd.getRoot(); }
+		uint32_t getInvRoot() const { return _fwd.getInvRoot(); }
+
+		// x[0..L) : coefficients of a polynomial of length at most L -> its values at the L points
+		void TFT_DIF (Element *x, size_t L, uint32_t *data) {
+			load(data, x, L);
+			tft(data, n, L);
+			store(x, data, L);
+		}
+
+		// inverse of TFT_DIF (scaling included): values at the L points -> coefficients
+		void TFT_DIT (Element *x, size_t L, uint32_t *data) {
+			load(data, x, L);
+			itft(data, n, L);
+			store(x, data, L);
+		}
+
+		// transposed of TFT_DIF and TFT_DIT, for the middle product
+		void TFT_DIF_transposed (Element *x, size_t L, uint32_t *data) {
+			load(data, x, L);
+			tft_t(data, n, L);
+			store(x, data, L);
+		}
+
+		void TFT_DIT_transposed (Element *x, size_t L, uint32_t *data) {
+			load(data, x, L);
+			itft_t(data, n, L);
+			store(x, data, L);
+		}
+
+	private:
+		void load (uint32_t *data, const Element *x, size_t L) const {
+			linbox_check(L <= n);
+			for (size_t i = 0; i < L; i++)
+				data[i] = (uint32_t)x[i];
+			std::fill(data+L, data+n, 0);
+		}
+
+		void store (Element *x, const uint32_t *data, size_t L) const {
+			for (size_t i = 0; i < L; i++)
+				x[i] = data[i];
+		}
+
+		// the twiddles of T times c
+		FFT_tables_cache::Tables scaled (const FFT_transform<Field> &T, uint32_t c, FFT_tables_cache::Kind kind) const {
+			FFT_tables_cache &cache = FFT_tables_cache::instance();
+			FFT_tables_cache::Key key(_pl, ln, (uint32_t)T.getRoot(), kind);
+			FFT_tables_cache::Tables S = cache.find(key);
+			if (S)
+				return S;
+			S = std::make_shared<FFT_tables>(T.pow_w.size());
+			S->w    = (uint32_t)T.getRoot();
+			S->invw = (uint32_t)T.getInvRoot();
+			for (size_t i = 0; i < T.pow_w.size(); i++) {
+				S->pow_w [i] = (uint32_t)((uint64_t)T.pow_w[i] * c % _pl);
+				S->pow_wp[i] = (uint32_t)(((uint64_t)S->pow_w[i] << 32) / _pl);
+			}
+			return cache.insert(key, S);
+		}
+
+		inline uint32_t addmod (uint32_t a, uint32_t b) const {
+			uint32_t c = a + b;
+			return (c >= _pl) ? c - (uint32_t)_pl : c;
+		}
+		inline uint32_t submod (uint32_t a, uint32_t b) const {
+			return (a >= b) ? a - b : a + (uint32_t)_pl - b;
+		}
+		// a*b mod p, bp being the Shoup precomputation of b
+		inline uint32_t mulmod (uint32_t a, uint32_t b, uint32_t bp) const {
+			uint32_t q = (uint32_t)(((uint64_t)a * bp) >> 32);
+			uint32_t r = a * b - q * (uint32_t)_pl;
+			return (r >= _pl) ? r - (uint32_t)_pl : r;
+		}
+
+		/* Linear passes of the pruned transforms, on cnt entries of x and y
+		 * (all values mod p). With AVX2 they go 8 entries at a time, the
+		 * remaining ones being done by the scalar code.
+		 */
+#if defined(__LINBOX_USE_SIMD) && defined(__AVX2__)
+#define TFT_AVX2_LOOP(...)						\
+		size_t i = 0;						\
+		{							\
+			_vect256_t P, T1;				\
+			VEC256_SET_32(P, (uint32_t)_pl);		\
+			for (; i + 8 <= cnt; i += 8) { __VA_ARGS__ }	\
+		}
+// C = A-B mod P
+#define TFT_AVX2_SUB_MOD(C,A,B)			\
+		VEC256_SUB_32(C,A,B); VEC256_ADD_32(C,C,P); VEC256_MOD_P(C,C,P,T1);
+// C = A*W mod P
+#define TFT_AVX2_MUL_MOD(C,A)					\
+		VEC256_MUL_MOD(C,A,W,P,Wp,Q,T1,T2); VEC256_MOD_P(C,C,P,T1);
+#else
+#define TFT_AVX2_LOOP(...) size_t i = 0;
+#endif
+
+		// x, y = x+y, (x-y)w
+		void butterfly_dif (uint32_t *x, uint32_t *y, size_t cnt, const uint32_t *w, const uint32_t *wp) const {
+			TFT_AVX2_LOOP(
+				_vect256_t A, B, C, W, Wp, Q, T2;
+				VEC256_LOADU(A, x+i); VEC256_LOADU(B, y+i);
+				VEC256_LOADU(W, w+i); VEC256_LOADU(Wp, wp+i);
+				VEC256_ADD_MOD(C, A, B, P, T1); VEC256_STOREU(x+i, C);
+				TFT_AVX2_SUB_MOD(A, A, B); TFT_AVX2_MUL_MOD(C, A); VEC256_STOREU(y+i, C);
+				)
+			for (; i < cnt; i++) {
+				uint32_t a = x[i], b = y[i];
+				x[i] = addmod(a, b);
+				y[i] = mulmod(submod(a, b), w[i], wp[i]);
+			}
+		}
+
+		// x, y = x+yw, x-yw
+		void butterfly_dit (uint32_t *x, uint32_t *y, size_t cnt, const uint32_t *w, const uint32_t *wp) const {
+			TFT_AVX2_LOOP(
+				_vect256_t A, B, C, W, Wp, Q, T2;
+				VEC256_LOADU(A, x+i); VEC256_LOADU(B, y+i);
+				VEC256_LOADU(W, w+i); VEC256_LOADU(Wp, wp+i);
+				TFT_AVX2_MUL_MOD(B, B);
+				VEC256_ADD_MOD(C, A, B, P, T1); VEC256_STOREU(x+i, C);
+				TFT_AVX2_SUB_MOD(C, A, B); VEC256_STOREU(y+i, C);
+				)
+			for (; i < cnt; i++) {
+				uint32_t a = x[i], t = mulmod(y[i], w[i], wp[i]);
+				x[i] = addmod(a, t);
+				y[i] = submod(a, t);
+			}
+		}
+
+		// y = (x-y)w
+		void diff_mul (const uint32_t *x, uint32_t *y, size_t cnt, const uint32_t *w, const uint32_t *wp) const {
+			TFT_AVX2_LOOP(
+				_vect256_t A, B, C, W, Wp, Q, T2;
+				VEC256_LOADU(A, x+i); VEC256_LOADU(B, y+i);
+				VEC256_LOADU(W, w+i); VEC256_LOADU(Wp, wp+i);
+				TFT_AVX2_SUB_MOD(A, A, B); TFT_AVX2_MUL_MOD(C, A); VEC256_STOREU(y+i, C);
+				)
+			for (; i < cnt; i++)
+				y[i] = mulmod(submod(x[i], y[i]), w[i], wp[i]);
+		}
+
+		// x, y = x+yw, -yw (transposed of diff_mul)
+		void mul_spread (uint32_t *x, uint32_t *y, size_t cnt, const uint32_t *w, const uint32_t *wp) const {
+			TFT_AVX2_LOOP(
+				_vect256_t A, B, C, W, Wp, Q, T2;
+				VEC256_LOADU(A, x+i); VEC256_LOADU(B, y+i);
+				VEC256_LOADU(W, w+i); VEC256_LOADU(Wp, wp+i);
+				TFT_AVX2_MUL_MOD(B, B);
+				VEC256_ADD_MOD(C, A, B, P, T1); VEC256_STOREU(x+i, C);
+				VEC256_SUB_32(C, P, B); VEC256_MOD_P(C, C, P, T1); VEC256_STOREU(y+i, C);
+				)
+			for (; i < cnt; i++) {
+				uint32_t t = mulmod(y[i], w[i], wp[i]);
+				x[i] = addmod(x[i], t);
+				y[i] = submod(0, t);
+			}
+		}
+
+		// x = x+y
+		void add_in (uint32_t *x, const uint32_t *y, size_t cnt) const {
+			TFT_AVX2_LOOP(
+				_vect256_t A, B, C;
+				VEC256_LOADU(A, x+i); VEC256_LOADU(B, y+i);
+				VEC256_ADD_MOD(C, A, B, P, T1); VEC256_STOREU(x+i, C);
+				)
+			for (; i < cnt; i++)
+				x[i] = addmod(x[i], y[i]);
+		}
+
+		// x = x-y
+		void sub_in (uint32_t *x, const uint32_t *y, size_t cnt) const {
+			TFT_AVX2_LOOP(
+				_vect256_t A, B, C;
+				VEC256_LOADU(A, x+i); VEC256_LOADU(B, y+i);
+				TFT_AVX2_SUB_MOD(C, A, B); VEC256_STOREU(x+i, C);
+				)
+			for (; i < cnt; i++)
+				x[i] = submod(x[i], y[i]);
+		}
+
+		// x[0..cnt) = x[0..cnt)/D
+		void scale (uint32_t *x, size_t cnt, size_t D) const {
+			size_t k = 0;
+			while ((1ULL << k) < D) k++;
+			const uint32_t c = _inv2k[k], cp = _inv2kp[k];
+			TFT_AVX2_LOOP(
+				_vect256_t A, C, W, Wp, Q, T2;
+				VEC256_LOADU(A, x+i); VEC256_SET_32(W, c); VEC256_SET_32(Wp, cp);
+				TFT_AVX2_MUL_MOD(C, A); VEC256_STOREU(x+i, C);
+				)
+			for (; i < cnt; i++)
+				x[i] = mulmod(x[i], c, cp);
+		}
+#undef TFT_AVX2_LOOP
+#undef TFT_AVX2_SUB_MOD
+#undef TFT_AVX2_MUL_MOD
+
+		// twiddles w_M^i (or w_M^-i), i < M/2, of the step of width M/2
+		// and their Shoup precomputations
+		const uint32_t* twiddles (size_t M, bool inverse) const {
+			return inverse ? &_inv.pow_w[n-M] : &_fwd.pow_w[n-M];
+		}
+		const uint32_t* twiddlesp (size_t M, bool inverse) const {
+			return inverse ? &_inv.pow_wp[n-M] : &_fwd.pow_wp[n-M];
+		}
+
+		FFT_transform<Field>& full (size_t M, bool inverse) {
+			size_t k = 0;
+			while ((1ULL << k) < M) k++;
+			if (k == ln)
+				return inverse ? _inv : _fwd;
+			return inverse ? _sub_inv[k-TFT_FULL_LOG] : _sub_fwd[k-TFT_FULL_LOG];
+		}
+
+		// full FFT of size M (natural order -> bit-reversed order), output mod p
+		void dif (uint32_t *x, size_t M, bool inverse) {
+			if (M >= (1ULL << TFT_FULL_LOG)) {
+				full(M, inverse).FFT_DIF_Harvey(x);
+				return;
+			}
+			if (M == 1) return;
+			size_t h = M >> 1;
+			butterfly_dif(x, x+h, h, twiddles(M, inverse), twiddlesp(M, inverse));
+			dif(x, h, inverse);
+			dif(x+h, h, inverse);
+		}
+
+		// full FFT of size M (bit-reversed order -> natural order), output mod p
+		void dit (uint32_t *x, size_t M, bool inverse) {
+			if (M >= (1ULL << TFT_FULL_LOG)) {
+				full(M, inverse).FFT_DIT_Harvey(x);
+				return;
+			}
+			if (M == 1) return;
+			size_t h = M >> 1;
+			dit(x, h, inverse);
+			dit(x+h, h, inverse);
+			butterfly_dit(x, x+h, h, twiddles(M, inverse), twiddlesp(M, inverse));
+		}
+
+		// x[0..M): coefficients -> x[0..L): values at the first L points
+		void tft (uint32_t *x, size_t M, size_t L) {
+			if (L == 0) return;
+			if (L == M) {
+				dif(x, M, false);
+				return;
+			}
+			size_t h = M >> 1;
+			if (L <= h) {
+				// only the values of x mod X^h-1 are needed
+				add_in(x, x+h, h);
+				tft(x, h, L);
+				return;
+			}
+			butterfly_dif(x, x+h, h, twiddles(M, false), twiddlesp(M, false));
+			dif(x, h, false);
+			tft(x+h, h, L-h);
+		}
+
+		// transposed of tft: x[0..L) -> x[0..M)
+		void tft_t (uint32_t *x, size_t M, size_t L) {
+			if (L == 0) {
+				std::fill(x, x+M, 0);
+				return;
+			}
+			if (L == M) {
+				dit(x, M, false);
+				return;
+			}
+			size_t h = M >> 1;
+			if (L <= h) {
+				tft_t(x, h, L);
+				std::copy(x, x+h, x+h);
+				return;
+			}
+			dit(x, h, false);
+			tft_t(x+h, h, L-h);
+			butterfly_dit(x, x+h, h, twiddles(M, false), twiddlesp(M, false));
+		}
+
+		// x[0..L): values at the first L points, x[L..M): known coefficients
+		// -> x[0..L): coefficients, x[L..M) unchanged
+		void itft (uint32_t *x, size_t M, size_t L) {
+			if (L == 0) return;
+			if (L == M) {
+				dit(x, M, true);
+				scale(x, M, M);
+				return;
+			}
+			size_t h = M >> 1;
+			if (L <= h) {
+				// values of u = x mod X^h-1, whose coefficients in [L,h) are known
+				add_in(x+L, x+h+L, h-L);
+				itft(x, h, L);
+				sub_in(x, x+h, h);
+				return;
+			}
+			// u/2 with u = x mod X^h-1, from its h values
+			dit(x, h, true);
+			scale(x, h, M);
+			// v = (x mod X^h+1)(wX): its coefficients in [L-h,h) are known
+			diff_mul(x+L-h, x+L, M-L, &_w2->pow_w[n-M]+L-h, &_w2->pow_wp[n-M]+L-h);
+			itft(x+h, h, L-h);
+			// x = (u + v(X/w))/2 + X^h (u - v(X/w))/2
+			butterfly_dit(x, x+h, h, &_wi2->pow_w[n-M], &_wi2->pow_wp[n-M]);
+		}
+
+		// transposed of itft, as a linear map on x[0..M)
+		void itft_t (uint32_t *x, size_t M, size_t L) {
+			if (L == 0) return;
+			if (L == M) {
+				dif(x, M, true);
+				scale(x, M, M);
+				return;
+			}
+			size_t h = M >> 1;
+			if (L <= h) {
+				sub_in(x+h, x, h);
+				itft_t(x, h, L);
+				add_in(x+h+L, x+L, h-L);
+				return;
+			}
+			butterfly_dif(x, x+h, h, &_wi2->pow_w[n-M], &_wi2->pow_wp[n-M]);
+			itft_t(x+h, h, L-h);
+			mul_spread(x+L-h, x+L, M-L, &_w2->pow_w[n-M]+L-h, &_w2->pow_wp[n-M]+L-h);
+			dif(x, h, true);
+			scale(x, h, M);
+		}
+	};
+
+} // end of namespace LinBox
+
+#endif // __LINBOX_polynomial_tft_transform_H
+
+// vim:sts=8:sw=8:ts=8:noet:sr:cino=>s,f0,{0,g0,(0,:0,t0,+0,=s
+// Local Variables:
+// mode: C++
+// tab-width: 8
+// indent-tabs-mode: t
+// c-basic-offset: 8
+// End:
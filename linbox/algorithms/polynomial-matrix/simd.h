@@ -229,6 +229,95 @@ typedef __m128i  _vect128_t;
 
 // END OF 128 BITS CODE
 
+/* 512 bits CODE HERE */
+
+// The AVX-512 code is compiled whatever the compiler flags, with the
+// target attribute, and chosen at run time (see simd512Available)
+#if !defined(LINBOX_FFT_NO_AVX512) && defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__)) && !defined(__INTEL_COMPILER)
+#define __LINBOX_FFT_AVX512_DISPATCH
+#include <immintrin.h>
+
+#define __LINBOX_AVX512_TARGET __attribute__((target("avx512f")))
+
+// define 512 bits simd vector type
+typedef __m512i  _vect512_t;
+
+// C=A*B (8 op 32x32->64)
+#define VEC512_MUL_32(C,A,B)			\
+	C= _mm512_mul_epu32(A,B);
+
+// C=A*B (16 op 32x32->32 low product)
+#define VEC512_MUL_LO_32(C,A,B)			\
+	C= _mm512_mullo_epi32(A,B);
+
+// C=A+B
+#define VEC512_ADD_32(C,A,B)			\
+	C= _mm512_add_epi32(A,B);
+
+// C=A-B
+#define VEC512_SUB_32(C,A,B)			\
+	C= _mm512_sub_epi32(A,B);
+
+// C = A mod P (A must lie in [0 2P[ )
+#define VEC512_MOD_P(C,A,P)						\
+	C=_mm512_mask_sub_epi32(A,_mm512_cmpge_epu32_mask(A,P),A,P);
+
+// C = A >> X
+#define VEC512_RSHIFT_64(C,A,X)			\
+	C=_mm512_srli_epi64 (A,X);
+
+// C = A[I] with I indexing the 32 lanes of A:B
+#define VEC512_PERMUTE2_32(C,A,I,B)			\
+	C=_mm512_permutex2var_epi32(A,I,B);
+
+// C=X[0..15]
+#define VEC512_LOAD(C,X)							\
+	C=_mm512_load_si512(reinterpret_cast<const void*>(X));
+#define VEC512_LOADU(C,X)							\
+	C=_mm512_loadu_si512(reinterpret_cast<const void*>(X));
+// C[0..15]=X
+#define VEC512_STORE(C,X)						\
+	_mm512_store_si512(reinterpret_cast<void*>(C),X);
+#define VEC512_STOREU(C,X)						\
+	_mm512_storeu_si512(reinterpret_cast<void*>(C),X);
+#define VEC512_SET_32(C,X)						\
+	C=_mm512_set1_epi32(X);
+
+// C=A*B (16 op 32x32->32 high product), the odd lanes from a second
+// 32x32->64 product on the operands shifted by 32
+#define VEC512_MUL_HI_32(C,A,B,A1,B1)			\
+	VEC512_MUL_32(C,A,B);				\
+	VEC512_RSHIFT_64(A1,A,32);			\
+	VEC512_RSHIFT_64(B1,B,32);			\
+	VEC512_MUL_32(A1,A1,B1);			\
+	VEC512_RSHIFT_64(C,C,32);			\
+	C=_mm512_mask_blend_epi32(0xAAAA,C,A1);
+
+// C= A+B mod P
+#define VEC512_ADD_MOD(C,A,B,P)			\
+	VEC512_ADD_32(C,A,B); VEC512_MOD_P(C,C,P);
+
+// C= A*X mod P using T1, T2 as temporaries (Shoup, result in [0 2P[ )
+#define VEC512_MUL_MOD(C,A,X,P,Xp,Q,T1,T2)		\
+	VEC512_MUL_HI_32(Q,A,Xp,T1,T2);			\
+	VEC512_MUL_LO_32(C,A,X);			\
+	VEC512_MUL_LO_32(T1,Q,P);			\
+	VEC512_SUB_32(C,C,T1);
+
+namespace LinBox {
+	// true if the running CPU has AVX-512F (detected once)
+	inline bool simd512Available() {
+		static const bool available = [](){
+			__builtin_cpu_init();
+			return __builtin_cpu_supports("avx512f") != 0;
+		}();
+		return available;
+	}
+}
+#endif
+
+// END OF 512 BITS CODE
+
  
 // C=A*B (4 op 32x32->32 high product) // A and with a mask can be used to remove the last two shift with C
 #define VEC128_MUL_HI_32(C,A,B,A1,B1)			\
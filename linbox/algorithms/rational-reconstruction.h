@@ -34,7 +34,10 @@
 #define __LINBOX_reconstruction_H
 
 #include "linbox/linbox-config.h"
+#include <algorithm>
+#include <vector>
 #include "linbox/util/debug.h"
+#include "linbox/util/thread-pool.h"
 
 
 #include "linbox/algorithms/rational-reconstruction-base.h"
@@ -126,6 +129,9 @@ namespace LinBox
 		// store early termination threshold.
 		int _threshold;
 
+		// digits used by the last getRationalBatched
+		mutable size_t _lifted;
+
 	public:
 		RatRecon RR;
 
@@ -136,7 +142,7 @@ namespace LinBox
 		 *  @param THRESHOLD  NO DOC
 		 */
 		RationalReconstruction (const LiftingContainer& lcontainer, const Ring& r = Ring(), int THRESHOLD =DEF_THRESH) :
-			_lcontainer(lcontainer), _r(r), _threshold(THRESHOLD), RR(_r)
+			_lcontainer(lcontainer), _r(r), _threshold(THRESHOLD), _lifted(0), RR(_r)
 		{
 
 			//if ( THRESHOLD < DEF_THRESH) _threshold = DEF_THRESH;
@@ -149,6 +155,14 @@ namespace LinBox
 			return _lcontainer;
 		}
 
+		/** \brief Number of digits lifted by the last getRationalBatched
+		 * (at most the length of the container).
+		 */
+		size_t lifted() const
+		{
+			return _lifted;
+		}
+
 		/** Handler to switch between different rational
 		 * reconstruction strategy.
 		 *  Allow  early termination and direct fast method Switch is
@@ -156,6 +170,7 @@ namespace LinBox
 		 *  set to that of constructor THRESHOLD
 		 *  - \f$0\f$   -> direct method
 		 *  - \f$>0\f$  -> early termination with
+		 *  - \f$<0\f$  -> early termination on a random combination, with a shared denominator (getRationalBatched)
 		 *  .
 		 */
 		template <class Vector>
@@ -163,6 +178,8 @@ namespace LinBox
 		{
 			if ( switcher == 0)
 				return getRational3 (num, den);
+			if ( switcher < 0)
+				return getRationalBatched (num, den);
 			//{getRational1(num,den); print (num); std::cout << "Denominator: " << den << "\n";
 			//getRational3(num, den);print (num); std::cout << "Denominator: " << den << "\n";}
 
@@ -847,6 +864,93 @@ namespace LinBox
 #ifdef RSTIMING
 			tRecon.start();
 #endif
+			int counter=0;
+			bool ok = reconstructDigits(num, den, digit_approximation, counter);
+#ifdef RSTIMING
+			tRecon.stop();
+			ttRecon += tRecon;
+			_num_rec=counter;
+#endif
+			return ok;
+
+		} // end of getRational3
+
+		/** Reconstruct a block of rational vectors from the block
+		 * p-adic lifting of BlockDixonLiftingContainer.
+		 * Column \c j of \p num over \p den[j] is the solution for the
+		 * column \c j of the right hand side. The digits are all
+		 * computed first, then the columns are reconstructed in parallel.
+		 */
+		template<class Matrix1, class Vector1>
+		bool getRationalBlock(Matrix1& num, Vector1& den) const
+		{
+			const size_t length = _lcontainer.length();
+			const size_t size   = _lcontainer.size();
+			const size_t k      = _lcontainer.blocksize();
+			linbox_check(num.rowdim() == size);
+			linbox_check(num.coldim() == k);
+			linbox_check(den.size() == k);
+
+			typedef typename LiftingContainer::IBlock IBlock;
+			std::vector<IBlock> digits(length, IBlock(_r, size, k));
+
+			typename LiftingContainer::const_iterator iter = _lcontainer.begin();
+			for (size_t i=0 ; iter != _lcontainer.end() && iter.next(digits[i]);++i) ;
+			if (iter!= _lcontainer.end()){
+				commentator().report()
+				<< "ERROR in lifting container. (block)" << std::endl;
+				return false;
+			}
+
+			std::vector<int> ok(k); // not vector<bool>, written concurrently
+			threadPool().parallelFor(0, k, [&](size_t j) {
+				Vector zero_digit(_r,size,_r.zero);
+				std::vector<Vector> column(length,zero_digit);
+				for (size_t i = 0 ; i < length ; ++i)
+					for (size_t l = 0 ; l < size ; ++l)
+						_r.assign(column[i][l], digits[i].getEntry(l,j));
+				Vector numj(_r,size);
+				Integer denj;
+				int counter = 0;
+				ok[j] = reconstructDigits(numj, denj, column, counter);
+				for (size_t l = 0 ; l < size ; ++l)
+					_r.assign(num.refEntry(l,j), numj[l]);
+				den[j] = denj;
+			});
+			return std::find(ok.begin(), ok.end(), 0) == ok.end();
+		}
+
+		/** Rational reconstruction from all the p-adic digits of a
+		 * vector with a common denominator.
+		 * \p counter is the number of coordinates that needed a full
+		 * rational reconstruction.
+		 */
+		template<class Vector1>
+		bool reconstructDigits(Vector1& num, Integer& den,
+				       const std::vector<Vector>& digit_approximation, int& counter) const
+		{
+			const size_t length = digit_approximation.size();
+			const size_t size   = _lcontainer.size();
+
+			// prime
+			Integer prime = _lcontainer.prime();
+
+			// store real approximation
+			Vector real_approximation(_r,size,_r.zero);
+
+			// store modulus
+			Integer modulus;
+			_r.assign(modulus, _r.one);
+			for (size_t i=0 ; i < length ; ++i)
+				_r.mulin(modulus,prime);
+
+			// denominator upper bound
+			Integer denbound;
+			_r.assign(denbound,_lcontainer.denbound());
+
+			// numerator  upper bound
+			Integer numbound;
+			_r.assign(numbound,_lcontainer.numbound());
 
 			Timer eval_dac;//, eval_bsgs;
 #if 0
@@ -952,7 +1056,7 @@ namespace LinBox
 
 			Vector denominator(_r,num.size());
 
-			int counter=0;
+			counter=0;
 			typename Vector::iterator   iter_approx = real_approximation.begin();
 			typename Vector1::iterator  iter_num    = num.begin();
 			typename Vector::iterator   iter_denom  = denominator.begin();
@@ -1039,15 +1143,10 @@ namespace LinBox
 
 			ratrecon.stop();
 			//std::cout<<"partial rational reconstruction : "<<ratrecon.usertime()<<std::endl;
-#ifdef RSTIMING
-			tRecon.stop();
-			ttRecon += tRecon;
-			_num_rec=counter;
-#endif
 
 			return true;
 
-		} // end of getRational3
+		} // end of reconstructDigits
 
 		/*!
 		 * early terminated analog of getRational3.
@@ -1239,6 +1338,188 @@ namespace LinBox
 
 		} // end of getRationalET
 
+		/** Early terminated reconstruction with a shared denominator.
+		 *
+		 * The lifting is stopped as soon as the output stabilizes: at
+		 * check points whose spacing grows geometrically, only the
+		 * random linear combination <code>c = r.x mod p^i</code> is
+		 * reconstructed, which costs one rational reconstruction
+		 * whatever the dimension. When two consecutive check points
+		 * give the same fraction for \c c, its denominator is taken as
+		 * the common denominator of \c x and all the entries are
+		 * reconstructed with it, by a product and a reduction each; an
+		 * entry out of the bounds falls back to its own reconstruction.
+		 * Without early termination, this is getRational3.
+		 *
+		 * The cost is output sensitive: a solution with small
+		 * numerators and denominator needs about twice its size in
+		 * digits, instead of the Hadamard bound of the lifting
+		 * container.
+		 *
+		 * @note As getRational2, this is probabilistic: the combination
+		 * may stabilize on a wrong fraction, with a probability about
+		 * 1/p per check point.
+		 */
+		template<class Vector1>
+		bool getRationalBatched(Vector1& num, Integer& den) const
+		{
+#ifdef RSTIMING
+			ttRecon.clear();
+			tRecon.start();
+#endif
+			linbox_check(num.size() == (size_t)_lcontainer.size());
+
+			const size_t n   = _lcontainer.size();
+			const size_t len = _lcontainer.length();
+			Integer prime = _lcontainer.prime();
+
+			Vector r(_r,n);
+			for (typename Vector::iterator r_p = r.begin(); r_p != r.end(); ++r_p)
+				_r.init(*r_p, int64_t(rand()));
+
+			const Vector zero_digit(_r,n,_r.zero);
+			std::vector<Vector> digits;
+			digits.reserve(len);
+
+			Integer modulus, pmodulus, c, tmp, two;
+			_r.assign(modulus, _r.one);
+			_r.assign(c, _r.zero);
+			_r.init(two, int64_t(2));
+
+			// fraction of c at the previous check point
+			Integer c_num, c_den, prev_num, prev_den;
+			_r.assign(prev_num, _r.zero);
+			_r.assign(prev_den, _r.zero);
+
+			size_t next_check = 1;
+			int counter = 0;
+
+			typename LiftingContainer::const_iterator iter = _lcontainer.begin();
+			for (size_t i = 1 ; i <= len ; ++i) {
+				digits.push_back(zero_digit);
+#ifdef RSTIMING
+				tRecon.stop();
+				ttRecon += tRecon;
+#endif
+				if (!iter.next(digits.back())) {
+					commentator().report()
+					<< "ERROR in lifting container. (batched)" << std::endl;
+					return false;
+				}
+#ifdef RSTIMING
+				tRecon.start();
+#endif
+				_r.assign(pmodulus, modulus);
+				_r.mulin(modulus, prime);
+
+				// c += (r.digit) p^{i-1}
+				dot(tmp, r, digits.back());
+				_r.axpyin(c, tmp, pmodulus);
+				_r.modin(c, modulus);
+
+				if (i < next_check || i == len)
+					continue;
+				next_check = i + 1 + i/8;
+
+				// balanced bounds, N D < p^i / 2
+				Integer numbound, denbound;
+				_r.quo(tmp, modulus, two);
+				_r.sqrt(numbound, tmp);
+				_r.assign(denbound, numbound);
+
+				if (!Givaro::reconstructRational(c_num, c_den, c, modulus, numbound, denbound))
+					continue;
+				if (!_r.areEqual(c_num, prev_num) || !_r.areEqual(c_den, prev_den)) {
+					_r.assign(prev_num, c_num);
+					_r.assign(prev_den, c_den);
+					continue;
+				}
+
+				// c is stable: try its denominator for every entry
+				Vector approx(_r,n);
+				typename std::vector<Vector>::const_iterator digit_begin = digits.begin();
+				Integer x = prime;
+				PolEval(approx, digit_begin, i, x);
+				if (reconstructShared(num, den, approx, c_den, modulus, numbound, denbound, counter)) {
+					_lifted = i;
+#ifdef RSTIMING
+					tRecon.stop();
+					ttRecon += tRecon;
+					_num_rec = counter;
+#endif
+#ifdef DEBUG_RR_BOUNDACCURACY
+					std::cout << "Computed " << i << " digits out of estimated " << len << std::endl;
+#endif
+					return true;
+				}
+			}
+
+			// no early termination, use the bounds of the container
+			_lifted = len;
+			bool ok = reconstructDigits(num, den, digits, counter);
+#ifdef RSTIMING
+			tRecon.stop();
+			ttRecon += tRecon;
+			_num_rec = counter;
+#endif
+			return ok;
+		} // end of getRationalBatched
+
+		/** Reconstruction of \p approx modulo \p modulus with the
+		 * denominator \p d shared by all the entries.
+		 * <code>d approx</code> is reduced in the symmetric range; an
+		 * entry larger than \p numbound is reconstructed on its own and
+		 * the denominator becomes the lcm. Returns false if an entry
+		 * cannot be reconstructed, or if the denominator exceeds \p
+		 * denbound.
+		 */
+		template<class Vector1>
+		bool reconstructShared(Vector1& num, Integer& den, const Vector& approx, const Integer& d,
+				       const Integer& modulus, const Integer& numbound, const Integer& denbound,
+				       int& counter) const
+		{
+			Integer tmp_res, neg_res, abs_neg, tmp_num, tmp_den, l, g;
+			_r.assign(den, d);
+			typename Vector1::iterator num_p = num.begin();
+			typename Vector::const_iterator a_p = approx.begin();
+			for ( ; a_p != approx.end(); ++a_p, ++num_p) {
+				_r.mul(tmp_res, *a_p, den);
+				_r.modin(tmp_res, modulus);
+				_r.sub(neg_res, tmp_res, modulus);
+				_r.abs(abs_neg, neg_res);
+				if (_r.compare(tmp_res, numbound) < 0)
+					_r.assign(*num_p, tmp_res);
+				else if (_r.compare(abs_neg, numbound) < 0)
+					_r.assign(*num_p, neg_res);
+				else {
+					if (!Givaro::reconstructRational(tmp_num, tmp_den, *a_p, modulus, numbound, denbound))
+						return false;
+					++counter;
+					_r.lcm(l, den, tmp_den);
+					if (_r.compare(l, denbound) >= 0)
+						return false;
+					_r.div(g, l, den);
+					if (!_r.isOne(g))
+						for (typename Vector1::iterator num_p1 = num.begin(); num_p1 != num_p; ++num_p1)
+							_r.mulin(*num_p1, g);
+					_r.div(g, l, tmp_den);
+					_r.mul(*num_p, g, tmp_num);
+					_r.assign(den, l);
+				}
+			}
+
+			// d may be a multiple of the actual denominator
+			_r.assign(g, den);
+			for (num_p = num.begin(); num_p != num.end() && !_r.isOne(g); ++num_p)
+				_r.gcdin(g, *num_p);
+			if (!_r.isOne(g)) {
+				for (num_p = num.begin(); num_p != num.end(); ++num_p)
+					_r.divin(*num_p, g);
+				_r.divin(den, g);
+			}
+			return true;
+		}
+
 
 #ifdef __LINBOX_HAVE_NTL
 		/*!
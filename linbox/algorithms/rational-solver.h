@@ -746,6 +746,31 @@ namespace LinBox
 						    const Vector2& b, bool s = false,
 						    int maxPrimes = DEFAULT_MAXPRIMES) const;
 
+		/** Solve a nonsingular, square linear system \c AX=B with several right-hand sides.
+		 *
+		 * The \c k systems are lifted together: each p-adic digit is a
+		 * \c n x \c k matrix, computed with one matrix product modulo
+		 * \c p, and the residues are updated with one integer matrix
+		 * product, in parallel on threadPool(). The columns are then
+		 * reconstructed in parallel.
+		 *
+		 * @param num       Matrix of numerators, \c n x \c k
+		 * @param den       Denominators. <code>1/den[j] * num_j</code> is the rational solution of <code>Ax = B_j</code>
+		 * @param A         Matrix of linear system (it must be square and a BlasMatrix)
+		 * @param B         Right-hand sides, \c n x \c k
+		 * @param maxPrimes maximum number of moduli to try
+		 *
+		 * @return status of solution :
+		 *   - \c SS_FAILED   all primes used were bad;
+		 *   - \c SS_OK       solution found, guaranteed correct;
+		 *   - \c SS_SINGULAR system appreared singular mod all primes.
+		 *   .
+		 */
+		template<class IMatrix>
+		SolverReturnStatus solveNonsingular(BlasMatrix<Ring>& num, BlasVector<Ring>& den,
+						    const IMatrix& A, const BlasMatrix<Ring>& B,
+						    int maxPrimes = DEFAULT_MAXPRIMES) const;
+
 		/** Solve a general rectangular linear system \c Ax=b over quotient field of a ring.
 		 *  If A is known to be square and nonsingular, calling solveNonsingular is more efficient.
 		 *
@@ -750,6 +750,61 @@ namespace LinBox
 		return SS_OK;
 	}
 
+	template <class Ring, class Field, class RandomPrime>
+	template <class IMatrix>
+	SolverReturnStatus
+	RationalSolver<Ring,Field,RandomPrime,DixonTraits>::solveNonsingular(BlasMatrix<Ring>& num,
+									     BlasVector<Ring>& den,
+									     const IMatrix& A,
+									     const BlasMatrix<Ring>& B,
+									     int maxPrimes) const
+	{
+		linbox_check(A.rowdim() == A.coldim());
+		linbox_check(A.rowdim() == B.rowdim());
+		linbox_check(num.rowdim() == A.coldim());
+		linbox_check(num.coldim() == B.coldim());
+		linbox_check(den.size() == B.coldim());
+
+		int trials = 0, notfr;
+		BlasMatrix<Field>* FMP = NULL;
+		Field *F=NULL;
+
+		do {
+			if (trials == maxPrimes) {
+				if (F != NULL) delete F;
+				if (FMP != NULL) delete FMP;
+				return SS_SINGULAR;
+			}
+			if (trials != 0) chooseNewPrime();
+			++trials;
+
+			if (FMP != NULL) delete FMP;
+			if (F != NULL) delete F;
+			F = new Field (_prime);
+
+			BlasMatrix<Field> Ap(*F, A.rowdim(), A.coldim());
+			MatrixHom::map (Ap, A);
+			FMP = new BlasMatrix<Field>(*F, A.rowdim(), A.coldim());
+			if (!checkBlasPrime(_prime)) {
+				*FMP = Ap;
+				notfr = (int)MatrixInverse::matrixInverseIn(*F,*FMP);
+			}
+			else {
+				BlasMatrixDomain<Field> BMDF(*F);
+				BMDF.invin(*FMP, Ap, notfr); //notfr <- nullity
+			}
+		} while (notfr);
+
+		typedef BlockDixonLiftingContainer<Ring,Field,IMatrix,BlasMatrix<Field> > LiftingContainer;
+		LiftingContainer lc(_ring, *F, A, *FMP, B, _prime);
+		RationalReconstruction<LiftingContainer > re(lc);
+		bool ok = re.getRationalBlock(num, den);
+
+		delete F;
+		delete FMP;
+		return ok ? SS_OK : SS_FAILED;
+	}
+
 	template <class Ring, class Field, class RandomPrime>
 	template <class IMatrix, class Vector1, class Vector2>
 	SolverReturnStatus
@@ -37,6 +37,8 @@
 
 #include <givaro/givrnsfixed.h>    // Chinese Remainder with fixed primes
 
+#include "linbox/algorithms/crt-subproduct-tree.h"
+
 
 namespace LinBox
 {
@@ -64,11 +66,10 @@ namespace LinBox
 
 		typedef Givaro::RNSsystem<Integer, Field >      CRTSystem;
 		typedef typename CRTSystem::domains               Domains;
-		typedef typename CRTSystem::array                Elements;
 		// typedef typename CRTSystem::ring             Ring;
 
-		CRTSystem     _CRT_ ;
-		Domains _PrimeDoms_ ;
+		CRTSubproductTree _tree_ ; //!< reconstruction, shared by all the entries
+		Domains     _PrimeDoms_ ;
 
 #ifdef __LINBOX_HAVE_IML
 		//! @todo IML wrapper here
@@ -99,11 +100,13 @@ namespace LinBox
 		 */
 		void initCRA() ;
 		/*! Computes \c result corresponding to the \c residues.
-		 *
+		 * \c residues[j] is \c result modulo the \c j-th prime.
 		 */
 		void cra(integer & result, const std::vector<double> & residues);
 		/*! Computes \c result corresponding to the \c residues.
-		 *
+		 * \c residues[j][i] is \c result[i] modulo the \c j-th prime.
+		 * The subproduct tree of the primes is shared by all the entries,
+		 * which are reconstructed in parallel.
 		 */
 		void cra(std::vector<integer> & result, const std::vector<std::vector<double> > & residues);
 
@@ -144,7 +147,7 @@ namespace LinBox
 		// typedef typename CRTSystem::array        Elements;
 		// typedef typename CRTSystem::ring             Ring;
 
-		CRTSystemFixed     _CRT_ ;
+		CRTSubproductTree _tree_ ; //!< reconstruction, shared by all the entries
 		Prime_t         _Primes_ ;
 
 #ifdef __LINBOX_HAVE_IML
@@ -175,11 +178,13 @@ namespace LinBox
 		 */
 		void initCRA() ;
 		/*! Computes \c result corresponding to the \c residues.
-		 *
+		 * \c residues[j] is \c result modulo the \c j-th prime.
 		 */
 		void cra(integer & result, const std::vector<double> & residues);
 		/*! Computes \c result corresponding to the \c residues.
-		 *
+		 * \c residues[j][i] is \c result[i] modulo the \c j-th prime.
+		 * The subproduct tree of the primes is shared by all the entries,
+		 * which are reconstructed in parallel.
 		 */
 		void cra(std::vector<integer> & result, const std::vector<std::vector<double> > & residues);
 
@@ -32,8 +32,10 @@
 #ifndef __LINBOX_algorithms_rns_INL
 #define __LINBOX_algorithms_rns_INL
 
+#include <cmath>
 #include <set>
 #include "linbox/util/debug.h"
+#include "linbox/randiter/random-prime.h"
 
 namespace LinBox
 {
@@ -100,8 +102,7 @@ namespace LinBox
 		for(; i != _PrimeDoms_.end(); ++i, ++pvec ) {
 			*i = Field( (double)*pvec  );
 		}
-		CRTSystem CRT( _PrimeDoms_ );
-		_CRT_ = CRT  ;
+		_tree_.build( _primes_ );
 		return ;
 	}
 
@@ -109,13 +110,7 @@ namespace LinBox
 	void
 	RNS<Unsigned>::cra(integer & result, const std::vector<double> & residues)
 	{
-		Elements Moduli( _size_ );
-		typename Elements::iterator e = Moduli.begin();
-		std::vector<double>::const_iterator r = residues.begin();
-		for (; e != Moduli.end() ; ++e, ++r) {
-			*e = *r ;
-		}
-		_CRT_.RnsToRing( result, Moduli );
+		_tree_.reconstruct( result, residues );
 		linbox_check(result >=0);
 		linbox_check(result < _maxint_ );
 		if (!Unsigned)
@@ -136,15 +131,18 @@ namespace LinBox
 			residues[i].resize(result.size());
 			unitCRA(residues[i],_PrimeDoms_[i]); // creates residue list
 		}
+		const std::vector<std::vector<double> > & r = residues; // not the template overload
+		cra(result, r);
+	}
+
+	template<bool Unsigned>
+	void
+	RNS<Unsigned>::cra(std::vector<integer> & result, const std::vector<std::vector<double> > & residues)
+	{
+		linbox_check(residues.size() == _size_);
+		_tree_.reconstruct( result, residues, residues.front().size() );
 
 		for (size_t i = 0 ; i < result.size() ; ++i) {
-			Elements Moduli( _size_ );
-			typename Elements::iterator e = Moduli.begin();
-			std::vector<std::vector<double> >::iterator r = residues.begin();
-			for (; e != Moduli.end() ; ++e,++r) {
-				*e = (*r)[i] ;
-			}
-			_CRT_.RnsToRing( result[i], Moduli );
 			// std::cout << result[i] << '<' << _maxint_ << std::endl;
 			linbox_check(result[i] >=0);
 			linbox_check(result [i]< _maxint_ );
@@ -228,8 +226,7 @@ namespace LinBox
 		for(; i != _Primes_.end(); ++i, ++pvec ) {
 			*i = *pvec ;
 		}
-		CRTSystemFixed CRT(_Primes_);
-		_CRT_ = CRT;
+		_tree_.build( _primes_ );
 		return ;
 	}
 
@@ -237,13 +234,7 @@ namespace LinBox
 	void
 	RNSfixed<Unsigned>::cra(integer & result, const std::vector<double> & residues)
 	{
-		Prime_t Moduli( _size_ );
-		typename Prime_t::iterator e = Moduli.begin();
-		std::vector<double>::const_iterator r = residues.begin();
-		for (; e != Moduli.end() ; ++e, ++r) {
-			*e = *r ;
-		}
-		_CRT_.RnsToRing( result, Moduli );
+		_tree_.reconstruct( result, residues );
 	linbox_check(result >=0);
 		linbox_check(result < _maxint_ );
 
@@ -265,15 +256,18 @@ namespace LinBox
 			residues[i].resize(result.size());
 			unitCRA(residues[i],Givaro::Modular<double>(_Primes_[i]));
 		}
+		const std::vector<std::vector<double> > & r = residues; // not the template overload
+		cra(result, r);
+	}
+
+	template<bool Unsigned>
+	void
+	RNSfixed<Unsigned>::cra(std::vector<integer> & result, const std::vector<std::vector<double> > & residues)
+	{
+		linbox_check(residues.size() == _size_);
+		_tree_.reconstruct( result, residues, residues.front().size() );
 
 		for (size_t i = 0 ; i < result.size() ; ++i) {
-			Prime_t Moduli( _size_ );
-			typename Prime_t::iterator e = Moduli.begin();
-			std::vector<std::vector<double > >::iterator r = residues.begin();
-			for (; e != Moduli.end() ; ++e,++r) {
-				*e = (*r)[i] ;
-			}
-			_CRT_.RnsToRing( result[i], Moduli );
 	linbox_check(result [i]>=0);
 		linbox_check(result [i]< _maxint_ );
 
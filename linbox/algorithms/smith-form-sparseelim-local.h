@@ -57,7 +57,8 @@ namespace LinBox
     enum {
         PRIVILEGIATE_NO_COLUMN_PIVOTING	= 1,
         PRIVILEGIATE_REDUCING_FILLIN	= 2,
-        PRESERVE_UPPER_MATRIX		= 4
+        PRESERVE_UPPER_MATRIX		= 4,
+        PARALLEL_PIVOTING		= 8
     };
 
 	/** \brief Repository of functions for rank modulo a prime power by elimination
@@ -68,13 +69,14 @@ namespace LinBox
 		typedef GaussDomain<_Field> Father_t;
 		typedef _Field Field;
 		typedef typename Field::Element Element;
+		typedef typename Father_t::PivotCandidate PivotCandidate;
 	public:
 
 		/** \brief The field parameter is the domain
 		 * over which to perform computations
 		 */
-		PowerGaussDomain (const Field &F) :
-			Father_t(F)
+		PowerGaussDomain (const Field &F, double denseSwitch = __LINBOX_GAUSS_DENSE_SWITCH__) :
+			Father_t(F, denseSwitch)
 		{}
 
 		//Copy constructor
@@ -244,7 +246,7 @@ namespace LinBox
 
         template<class Vecteur>
         void PreserveUpperMatrixRow(Vecteur& ligne, Boolean_Trait<false>::BooleanType ) {
-            ligne = Vecteur(0);
+            sparseRowPool<Vecteur>().release(ligne);
         }
 
 
@@ -295,7 +297,8 @@ namespace LinBox
 					// -------------------------------------------
 					// Elimination
 					unsigned long npiv = (unsigned long) lignepivot.size();
-					Vecteur construit(nj + npiv);
+					Vecteur construit;
+					sparseRowPool<Vecteur>().acquire(construit, nj + npiv);
 					// construit : <-- ci
 					// courante  : <-- m
 					// pivot     : <-- l
@@ -348,7 +351,7 @@ namespace LinBox
 						*ci++ = lignecourante[(size_t)m++];
 
 					construit.erase(ci,construit.end());
-					lignecourante = construit;
+					sparseRowPool<Vecteur>().replace(lignecourante, construit);
 				}
 				else
 					// -------------------------------------------
@@ -372,6 +375,73 @@ namespace LinBox
 			}
 		}
 
+		// ------------------------------------------------------
+		// Dense local elimination of the active rows k..Ni-1,
+		// columns indcol..Nj-1, once they are dense enough:
+		// pivots are units, the remaining block is divided
+		// by PRIME when none is left.
+		// ------------------------------------------------------
+		template<class Modulo, class BB, class Container>
+		void dense_rankin(Modulo& MOD, Modulo PRIME, Container& ranks, BB& LigneA, const size_t k, unsigned long& indcol, const size_t Ni, const size_t Nj)
+		{
+			const size_t sNi = Ni-k, sNj = Nj-indcol;
+			commentator().report (Commentator::LEVEL_NORMAL, INTERNAL_DESCRIPTION)
+			<< "Dense switch at row " << k << ": " << sNi << 'x' << sNj << std::endl;
+
+			std::vector<Modulo> A(sNi*sNj, Modulo(0));
+			for(size_t i=k; i<Ni; ++i) {
+				for(size_t j=0; j<LigneA[i].size(); ++j)
+					A[(i-k)*sNj+LigneA[i][j].first-indcol] = (Modulo)LigneA[i][j].second;
+				LigneA[i].resize(0);
+			}
+
+			for(size_t r=0; (r<sNi) && (r<sNj) && (MOD > 1); ) {
+				size_t pi=sNi, pj=sNj;
+				bool nonzero = false;
+				for(size_t i=r; (i<sNi) && (pi==sNi); ++i)
+					for(size_t j=r; j<sNj; ++j) {
+						const Modulo& a = A[i*sNj+j];
+						if (isNZero(a)) {
+							nonzero = true;
+							if (! MY_divides(PRIME,a)) {
+								pi=i; pj=j;
+								break;
+							}
+						}
+					}
+				if (! nonzero) break;
+				if (pi == sNi) {
+					for(size_t i=r; i<sNi; ++i)
+						for(size_t j=r; j<sNj; ++j)
+							A[i*sNj+j] /= PRIME;
+					MOD /= PRIME;
+					ranks.push_back( indcol );
+					continue;
+				}
+
+				if (pi != r)
+					for(size_t j=r; j<sNj; ++j)
+						std::swap(A[pi*sNj+j], A[r*sNj+j]);
+				if (pj != r)
+					for(size_t i=r; i<sNi; ++i)
+						std::swap(A[i*sNj+pj], A[i*sNj+r]);
+
+				Modulo invpiv; MY_Zpz_inv(invpiv, A[r*sNj+r], MOD);
+				for(size_t i=r+1; i<sNi; ++i) {
+					Modulo headcoeff = A[i*sNj+r];
+					if (isZero(headcoeff)) continue;
+					headcoeff = MOD-headcoeff;
+					headcoeff *= invpiv;
+					headcoeff %= MOD;
+					for(size_t j=r+1; j<sNj; ++j) {
+						A[i*sNj+j] += headcoeff * A[r*sNj+j];
+						A[i*sNj+j] %= MOD;
+					}
+				}
+				++r; ++indcol;
+			}
+		}
+
 		// ------------------------------------------------------
 		// Rank calculators, defining row strategy
 		// ------------------------------------------------------
@@ -385,6 +455,8 @@ namespace LinBox
 			ranks.resize(0);
 
 			typedef typename BB::Row Vecteur;
+			SparseRowPool<Vecteur>& pool = sparseRowPool<Vecteur>();
+			pool.resetCounts();
 
 			Modulo MOD = FMOD;
 #ifdef LINBOX_PRANK_OUT
@@ -422,11 +494,24 @@ namespace LinBox
 			unsigned long ind_pow = 1;
 			unsigned long maxout = Ni/100; maxout = (maxout<10 ? 10 : (maxout>1000 ? 1000 : maxout) );
 			unsigned long thres = Ni/maxout; thres = (thres >0 ? thres : 1);
+			bool dense = false;
 
 
 			for (unsigned long k=0; k<last;++k) {
 				if ( ! (k % maxout) ) commentator().progress ((long)k);
 
+				// Fill-in monitor, the upper rows are not kept
+				// by the dense elimination
+				if (! PreserveUpperMatrix) {
+					size_t nnz = 0;
+					for(unsigned long l=k; l<Ni; ++l)
+						nnz += LigneA[(size_t)l].size();
+					if (this->isDenseEnough(nnz, Ni-k, Nj-indcol)) {
+						dense_rankin(MOD, PRIME, ranks, LigneA, k, indcol, Ni, Nj);
+						dense = true;
+						break;
+					}
+				}
 
 				unsigned long p=k;
 				for(;;) {
@@ -474,9 +559,7 @@ namespace LinBox
 #ifdef  LINBOX_pp_gauss_steps_OUT
 					std::cerr << "------------ permuting rows " << p << " and " << k << " ---" << std::endl;
 #endif
-					Vecteur vtm = LigneA[(size_t)k];
-					LigneA[(size_t)k] = LigneA[(size_t)p];
-					LigneA[(size_t)p] = vtm;
+					std::swap(LigneA[(size_t)k], LigneA[(size_t)p]);
 				}
 #ifdef  LINBOX_pp_gauss_steps_OUT
                 if (c != (long(indcol)-1L))
@@ -494,6 +577,7 @@ namespace LinBox
                 PreserveUpperMatrixRow(LigneA[(size_t)k], typename Boolean_Trait<PreserveUpperMatrix>::BooleanType());
 			}
 
+            if (! dense) {
             c = -2;
             SameColumnPivoting(PRIME, LigneA[(size_t)last], indcol, c, typename Boolean_Trait<PrivilegiateNoColumnPivoting>::BooleanType() );
             if (c == -2) CherchePivot( PRIME, LigneA[(size_t)last], indcol, c, col_density );
@@ -504,6 +588,7 @@ namespace LinBox
 				MOD /= PRIME;
 				CherchePivot( PRIME, LigneA[(size_t)last], indcol, c, col_density );
 			}
+            }
 			while( MOD > 1) {
 				MOD /= PRIME;
 				ranks.push_back( indcol );
@@ -516,13 +601,243 @@ namespace LinBox
 #ifdef LINBOX_PRANK_OUT
 			std::cerr << "Rank mod " << (unsigned long)FMOD << " : " << indcol << std::endl;
 #endif
+			pool.write(commentator().report (Commentator::LEVEL_NORMAL, PARTIAL_RESULT))
+			<< ", peak RSS " << peakResidentSetSize() << " kB" << std::endl;
+			pool.trim();
 			commentator().stop ("done", 0, "PRGE");
 
 		}
 
+		// ------------------------------------------------------
+		// Parallel rank calculator: batches of independent unit
+		// pivots, chosen by Markowitz cost, are eliminated at
+		// once, the other rows being shared among the threads.
+		// The block is divided by PRIME when no unit is left.
+		// ------------------------------------------------------
+		template<class Modulo, class BB, class Container>
+		void parallel_rankin(Modulo FMOD, Modulo PRIME, Container& ranks, BB& LigneA, const size_t Ni, const size_t Nj)
+		{
+			commentator().start ("Parallel Gaussian elimination modulo a prime power",
+					   "PPRGE", Ni);
+
+			typedef typename BB::Row Vecteur;
+			typedef typename Vecteur::value_type E;
+			SparseRowPool<Vecteur>& pool = sparseRowPool<Vecteur>();
+			pool.resetCounts();
+
+			ranks.resize(0);
+			Modulo MOD = FMOD;
+
+			std::vector<size_t> active, rest;
+			for(size_t i=0; i<Ni; ++i) {
+				Vecteur& row = LigneA[i];
+				size_t rs=0;
+				for(size_t k=0; k<row.size(); ++k) {
+					Modulo r = row[k].second;
+					if ((r <0) || (r >= MOD)) r %= MOD ;
+					if (r <0) r += MOD ;
+					if (isNZero(r)) {
+						row[rs] = row[k];
+						row[rs].second = ( r );
+						++rs;
+					}
+				}
+				row.resize(rs);
+				if (rs) active.push_back(i);
+			}
+
+			unsigned long indcol = 0;
+			std::vector<size_t> col_density(Nj);
+			std::vector<long> batchOfCol(Nj, -1);
+			std::vector<char> pivoted(Nj, 0);
+			std::vector<size_t> batch, pivotCols;
+			std::vector<Modulo> invpivots;
+			std::vector<PivotCandidate> C;
+
+			while (! active.empty() && (MOD > 1)) {
+				commentator().progress ((long)indcol);
+
+				size_t nnz = 0;
+				std::fill(col_density.begin(), col_density.end(), 0);
+				for(size_t a=0; a<active.size(); ++a) {
+					const Vecteur& row = LigneA[active[a]];
+					nnz += row.size();
+					for(size_t k=0; k<row.size(); ++k)
+						++col_density[row[k].first];
+				}
+
+				if (this->isDenseEnough(nnz, active.size(), Nj-indcol)) {
+					// Active rows moved to the bottom, free columns
+					// relabeled indcol..Nj-1 in order
+					const size_t k0 = Ni - active.size();
+					std::vector<size_t> label(Nj);
+					for(size_t j=0, f=indcol; j<Nj; ++j)
+						if (! pivoted[j]) label[j] = f++;
+					for(size_t t=active.size(); t-- > 0; ) {
+						if (active[t] != k0+t)
+							std::swap(LigneA[k0+t], LigneA[active[t]]);
+						for(size_t l=0; l<LigneA[k0+t].size(); ++l)
+							LigneA[k0+t][l].first = label[LigneA[k0+t][l].first];
+					}
+					dense_rankin(MOD, PRIME, ranks, LigneA, k0, indcol, Ni, Nj);
+					break;
+				}
+
+				// Sparsest column among the units of each row
+				const size_t n = active.size();
+				const size_t chunks = std::min(n, 4*threadPool().size());
+				std::vector<char> hasUnit(n, 0);
+				C.resize(n);
+				threadPool().parallelFor(0, chunks, [&](size_t t) {
+					for(size_t a=t*n/chunks; a<(t+1)*n/chunks; ++a) {
+						const Vecteur& row = LigneA[active[a]];
+						size_t c = Nj;
+						for(size_t k=0; k<row.size(); ++k)
+							if (! MY_divides(PRIME,row[k].second)
+							    && ((c == Nj) || (col_density[row[k].first] < col_density[c])))
+								c = row[k].first;
+						hasUnit[a] = (c < Nj);
+						if (c == Nj) continue;
+						C[a].cost = (uint64_t)(row.size()-1) * (uint64_t)(col_density[c]-1);
+						C[a].row  = active[a];
+						C[a].col  = c;
+					}
+				});
+				size_t nc = 0;
+				for(size_t a=0; a<n; ++a)
+					if (hasUnit[a]) C[nc++] = C[a];
+				C.resize(nc);
+
+				if (nc == 0) {
+					// no unit left
+					for(size_t a=0; a<n; ++a) {
+						Vecteur& row = LigneA[active[a]];
+						for(size_t k=0; k<row.size(); ++k)
+							row[k].second /= PRIME;
+					}
+					MOD /= PRIME;
+					ranks.push_back( indcol );
+					continue;
+				}
+
+				this->selectIndependentPivots(batch, batchOfCol, C, LigneA, Nj);
+				pivotCols.resize(batch.size());
+				invpivots.resize(batch.size());
+				for(size_t b=0; b<batch.size(); ++b) {
+					const Vecteur& row = LigneA[batch[b]];
+					for(size_t k=0; k<row.size(); ++k)
+						if (batchOfCol[row[k].first] == (long)b) {
+							pivotCols[b] = row[k].first;
+							MY_Zpz_inv(invpivots[b], (Modulo)row[k].second, MOD);
+							break;
+						}
+				}
+
+				rest.resize(0);
+				for(size_t a=0; a<n; ++a) {
+					const Vecteur& row = LigneA[active[a]];
+					bool isPivot = false;
+					for(size_t k=0; k<row.size() && !isPivot; ++k) {
+						const long b = batchOfCol[row[k].first];
+						isPivot = (b >= 0) && (batch[(size_t)b] == active[a]);
+					}
+					if (! isPivot) rest.push_back(active[a]);
+				}
+
+				// row buffers from the pool of each thread, the pivot
+				// rows being independent the result does not depend
+				// on the number of threads
+				const size_t m = rest.size();
+				const size_t chunks2 = std::min(m, 4*threadPool().size());
+				threadPool().parallelFor(0, chunks2, [&](size_t t) {
+					SparseRowPool<Vecteur>& tpool = sparseRowPool<Vecteur>();
+					std::vector<std::pair<size_t,Modulo> > hits;
+					for(size_t a=t*m/chunks2; a<(t+1)*m/chunks2; ++a) {
+						Vecteur& row = LigneA[rest[a]];
+						hits.resize(0);
+						for(size_t k=0; k<row.size(); ++k)
+							if (batchOfCol[row[k].first] >= 0)
+								hits.push_back(std::pair<size_t,Modulo>((size_t)batchOfCol[row[k].first], (Modulo)row[k].second));
+						for(size_t u=0; u<hits.size(); ++u) {
+							const size_t b = hits[u].first;
+							const Vecteur& prow = LigneA[batch[b]];
+							Modulo headcoeff = MOD-hits[u].second;
+							headcoeff *= invpivots[b];
+							headcoeff %= MOD;
+							Vecteur buf;
+							tpool.acquire(buf, row.size() + prow.size());
+							buf.resize(0);
+							size_t x=0, y=0;
+							while ((x < row.size()) || (y < prow.size())) {
+								if ((y == prow.size()) || ((x < row.size()) && (row[x].first < prow[y].first)))
+									buf.push_back(row[x++]);
+								else if ((x == row.size()) || (prow[y].first < row[x].first)) {
+									Modulo v = headcoeff;
+									v *= (Modulo)prow[y].second;
+									v %= MOD;
+									if (isNZero(v)) {
+										E e(prow[y]);
+										e.second = v;
+										buf.push_back(e);
+									}
+									++y;
+								}
+								else {
+									if (row[x].first != pivotCols[b]) {
+										Modulo v = headcoeff;
+										v *= (Modulo)prow[y].second;
+										v += (Modulo)row[x].second;
+										v %= MOD;
+										if (isNZero(v)) {
+											E e(row[x]);
+											e.second = v;
+											buf.push_back(e);
+										}
+									}
+									++x; ++y;
+								}
+							}
+							tpool.replace(row, buf);
+						}
+					}
+				});
+
+				for(size_t b=0; b<batch.size(); ++b) {
+					++indcol;
+					pivoted[pivotCols[b]] = 1;
+					const Vecteur& row = LigneA[batch[b]];
+					for(size_t k=0; k<row.size(); ++k)
+						batchOfCol[row[k].first] = -1;
+					pool.release(LigneA[batch[b]]);
+				}
+
+				active.resize(0);
+				for(size_t a=0; a<m; ++a)
+					if (LigneA[rest[a]].size())
+						active.push_back(rest[a]);
+			}
+
+			while( MOD > 1) {
+				MOD /= PRIME;
+				ranks.push_back( indcol );
+			}
+
+#ifdef LINBOX_PRANK_OUT
+			std::cerr << "Rank mod " << (unsigned long)FMOD << " : " << indcol << std::endl;
+#endif
+			pool.write(commentator().report (Commentator::LEVEL_NORMAL, PARTIAL_RESULT))
+			<< ", peak RSS " << peakResidentSetSize() << " kB" << std::endl;
+			pool.trim();
+			commentator().stop ("done", 0, "PPRGE");
+		}
+
 		template<class Modulo, class BB, class D, class Container>
 		void prime_power_rankin (Modulo FMOD, Modulo PRIME, Container& ranks, BB& SLA, const size_t Ni, const size_t Nj, const D& density_trait, int StaticParameters=0)
 		{
+            if ((PARALLEL_PIVOTING & StaticParameters) && !(PRESERVE_UPPER_MATRIX & StaticParameters)) {
+                parallel_rankin(FMOD, PRIME, ranks, SLA, Ni, Nj);
+                return;
+            }
             if (PRIVILEGIATE_NO_COLUMN_PIVOTING & StaticParameters) {
                 if (PRESERVE_UPPER_MATRIX & StaticParameters) {
                     gauss_rankin<Modulo,BB,D,Container,true,true>(FMOD,PRIME,ranks, SLA, Ni, Nj, density_trait);
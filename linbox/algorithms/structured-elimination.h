@@ -0,0 +1,496 @@
+/* linbox/algorithms/structured-elimination.h
+ * Copyright (C) 2016 the LinBox group
+ *
+ * ========LICENCE========
+ * This file is part of the library LinBox.
+ *
+ * LinBox is free software: you can redistribute it and/or modify
+ * it under the terms of the  GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ * ========LICENCE========
+ */
+
+/*! @file algorithms/structured-elimination.h
+ * @ingroup algorithms
+ * @brief Structured Gaussian elimination: filtering of a sparse matrix before
+ * any rank or nullspace method.
+ */
+
+#ifndef __LINBOX_structured_elimination_H
+#define __LINBOX_structured_elimination_H
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "linbox/util/debug.h"
+#include "linbox/util/commentator.h"
+
+namespace LinBox
+{
+
+	/** \brief Structured Gaussian elimination of a sparse matrix.
+	 *
+	 * The pivots that create no fill-in are taken first, before
+	 * any other method (elimination, Wiedemann, Lanczos) runs on what
+	 * is left:
+	 * - empty columns are removed;
+	 * - a singleton column (one entry) is a pivot: its row and column
+	 *   are removed;
+	 * - a column of weight 2 is merged: its lighter row is added to the
+	 *   other one to cancel the column, which becomes a singleton.
+	 *
+	 * Removing rows makes other columns lighter, until every column
+	 * left has at least 3 entries. Each pivot adds one to the rank.
+	 * The pivot rows are kept, so that a vector of the right nullspace
+	 * of the reduced matrix can be lifted back to the original matrix,
+	 * and so are the combinations of original rows that make the
+	 * reduced rows, for the left nullspace.
+	 *
+	 * For tall matrices (relations in rows, whose dependencies are
+	 * sought), the heaviest rows beyond the number of columns plus
+	 * \c excess can be dropped too. Left nullspace vectors still lift
+	 * exactly, but the rank and the right nullspace are no longer
+	 * those of the original matrix.
+	 *
+	 * The matrix is a vector of sparse rows, sorted by column and not
+	 * storing zeroes: SparseMatrix<Field, SparseMatrixFormat::SparseSeq>
+	 * (rows of pairs), or ZeroOne<GF2> (rows of column indices).
+	 */
+	template <class _Field>
+	class StructuredElimination {
+	public:
+		typedef _Field                                      Field;
+		typedef typename Field::Element                     Element;
+		typedef std::vector<std::pair<size_t, Element> >    Row;
+
+		StructuredElimination (const Field &F) :
+			_field(&F), _Ni(0), _Nj(0), _dropped(0)
+		{}
+
+		const Field &field () const { return *_field; }
+
+		/** Reduces the leading \p Ni x \p Nj block of \p A in place.
+		 * On return, the reduced matrix is the leading rowdim() x
+		 * coldim() block of \p A, and the other rows of the block are
+		 * empty.
+		 * @param excess if nonnegative, at most coldim()+excess rows
+		 *               are kept.
+		 * @return the number of pivots.
+		 */
+		template <class Matrix>
+		size_t reducein (Matrix &A, size_t Ni, size_t Nj, long excess = -1);
+
+		template <class Matrix>
+		size_t reducein (Matrix &A, long excess = -1)
+		{
+			return reducein(A, A.rowdim(), A.coldim(), excess);
+		}
+
+		//! row dimension of the reduced matrix.
+		size_t rowdim () const { return _rowMap.size(); }
+
+		//! column dimension of the reduced matrix.
+		size_t coldim () const { return _colMap.size(); }
+
+		//! number of pivots taken.
+		size_t pivots () const { return _pivots.size(); }
+
+		//! number of rows dropped in excess.
+		size_t dropped () const { return _dropped; }
+
+		//! original row of the row \p i of the reduced matrix.
+		size_t row (size_t i) const { return _rowMap[i]; }
+
+		//! original column of the column \p j of the reduced matrix.
+		size_t col (size_t j) const { return _colMap[j]; }
+
+		//! the columns found empty, in the original numbering.
+		const std::vector<size_t> &emptyColumns () const { return _empty; }
+
+		/** Rank of the original matrix from the rank of the reduced one.
+		 * Exact when no row was dropped.
+		 */
+		unsigned long &rank (unsigned long &r, unsigned long reducedRank) const
+		{
+			return r = reducedRank + pivots();
+		}
+
+		/** Lifts a vector \p y of the right nullspace of the reduced
+		 * matrix (size coldim()) to a vector \p x of the right
+		 * nullspace of the original matrix (size \p Nj). Empty
+		 * columns get zero.
+		 */
+		template <class Vector1, class Vector2>
+		Vector1 &lift (Vector1 &x, const Vector2 &y) const
+		{
+			for (size_t j = 0 ; j < _Nj ; ++j)
+				field().assign(x[j], field().zero);
+			for (size_t j = 0 ; j < coldim() ; ++j)
+				field().assign(x[_colMap[j]], y[j]);
+			return backSubstitute(x);
+		}
+
+		/** Lifts a vector \p z of the left nullspace of the reduced
+		 * matrix (size rowdim()) to a vector \p y of the left
+		 * nullspace of the original matrix (size \p Ni).
+		 */
+		template <class Vector1, class Vector2>
+		Vector1 &liftLeft (Vector1 &y, const Vector2 &z) const
+		{
+			Element t;
+			for (size_t i = 0 ; i < _Ni ; ++i)
+				field().assign(y[i], field().zero);
+			for (size_t k = 0 ; k < rowdim() ; ++k) {
+				const Row &c = _combo[_rowMap[k]];
+				for (typename Row::const_iterator e = c.begin() ; e != c.end() ; ++e) {
+					field().assign(t, y[e->first]);
+					field().axpyin(t, e->second, z[k]);
+					field().assign(y[e->first], t);
+				}
+			}
+			return y;
+		}
+
+		/** The nullspace vector of the original matrix given by the
+		 * \p k-th empty column. With the lifts of a basis of the
+		 * nullspace of the reduced matrix, they are a basis of the
+		 * nullspace of the original one.
+		 */
+		template <class Vector1>
+		Vector1 &liftEmpty (Vector1 &x, size_t k) const
+		{
+			for (size_t j = 0 ; j < _Nj ; ++j)
+				field().assign(x[j], field().zero);
+			field().assign(x[_empty[k]], field().one);
+			return backSubstitute(x);
+		}
+
+	private:
+		struct Pivot {
+			size_t col;
+			Row    row;
+		};
+
+		// x_j = - (sum of the other entries of the pivot row) / a_j,
+		// last pivot first.
+		template <class Vector1>
+		Vector1 &backSubstitute (Vector1 &x) const
+		{
+			Element s, t;
+			for (size_t p = _pivots.size() ; p-- > 0 ; ) {
+				const Pivot &P = _pivots[p];
+				Element a(field().one);
+				field().assign(s, field().zero);
+				for (typename Row::const_iterator e = P.row.begin() ; e != P.row.end() ; ++e) {
+					if (e->first == P.col)
+						field().assign(a, e->second);
+					else {
+						field().assign(t, x[e->first]);
+						field().axpyin(s, e->second, t);
+					}
+				}
+				field().negin(s);
+				field().divin(s, a);
+				field().assign(x[P.col], s);
+			}
+			return x;
+		}
+
+		// reading and writing the rows of the user matrix
+		template <class E>
+		static size_t entryCol (const std::pair<size_t, E> &e) { return e.first; }
+		static size_t entryCol (size_t j) { return j; }
+
+		template <class E>
+		const Element &entryVal (const std::pair<size_t, E> &e) const { return e.second; }
+		const Element &entryVal (size_t) const { return field().one; }
+
+		template <class MRow, class E>
+		static void pushEntry (MRow &r, size_t j, const Element &v, std::pair<size_t, E> *)
+		{
+			r.push_back(std::pair<size_t, E>(j, v));
+		}
+		template <class MRow>
+		static void pushEntry (MRow &r, size_t j, const Element &, size_t *)
+		{
+			r.push_back(j);
+		}
+
+		template <class MRow>
+		void readRow (size_t i, const MRow &r)
+		{
+			_rows[i].reserve(r.size());
+			for (typename MRow::const_iterator e = r.begin() ; e != r.end() ; ++e) {
+				size_t j = entryCol(*e);
+				_rows[i].push_back(std::pair<size_t, Element>(j, entryVal(*e)));
+				_colRows[j].push_back(i);
+				++_weight[j];
+			}
+		}
+
+		template <class MRow>
+		static void writeRow (MRow &r, const Row &src, const std::vector<size_t> &newCol)
+		{
+			for (typename Row::const_iterator e = src.begin() ; e != src.end() ; ++e)
+				pushEntry(r, newCol[e->first], e->second, (typename MRow::value_type *)0);
+		}
+
+		// does row i contain column j?
+		bool contains (size_t i, size_t j) const
+		{
+			const Row &r = _rows[i];
+			typename Row::const_iterator e = std::lower_bound(r.begin(), r.end(), std::pair<size_t, Element>(j, field().zero),
+									   [](const std::pair<size_t, Element> &a, const std::pair<size_t, Element> &b) { return a.first < b.first; });
+			return e != r.end() && e->first == j;
+		}
+
+		// value of column j in row i
+		const Element &value (size_t i, size_t j) const
+		{
+			const Row &r = _rows[i];
+			for (typename Row::const_iterator e = r.begin() ; e != r.end() ; ++e)
+				if (e->first == j)
+					return e->second;
+			return field().zero;
+		}
+
+		// row i leaves the active matrix
+		void removeRow (size_t i)
+		{
+			_activeRow[i] = false;
+			for (typename Row::const_iterator e = _rows[i].begin() ; e != _rows[i].end() ; ++e)
+				if (--_weight[e->first] <= 2)
+					_queue.push_back(e->first);
+		}
+
+		// row i2 += c row i1, cancelling column j
+		void mergeRows (size_t i2, size_t i1, size_t j);
+
+		// r2 += c r1, on sorted sparse rows. The columns added and
+		// cancelled are passed to fill(k) and cancel(k).
+		template <class Fill, class Cancel>
+		void axpyRow (Row &r2, const Element &c, const Row &r1, const Fill &fill, const Cancel &cancel) const;
+
+		// pivots and merges, until every column has 3 entries or more
+		void filter ();
+
+		const Field                         *_field;
+		size_t                               _Ni, _Nj, _dropped;
+		std::vector<Row>                     _rows;
+		std::vector<Row>                     _combo;     // original rows making a row
+		std::vector<bool>                    _activeRow, _activeCol;
+		std::vector<size_t>                  _weight;
+		std::vector<std::vector<size_t> >    _colRows;   // rows of a column, maybe stale
+		std::vector<size_t>                  _queue;     // columns of weight <= 2
+		std::vector<Pivot>                   _pivots;
+		std::vector<size_t>                  _empty, _rowMap, _colMap;
+	};
+
+	template <class _Field>
+	template <class Matrix>
+	size_t StructuredElimination<_Field>::reducein (Matrix &A, size_t Ni, size_t Nj, long excess)
+	{
+		commentator().start ("Structured Gaussian elimination", "StructuredElimination::reducein");
+
+		_Ni = Ni;
+		_Nj = Nj;
+		_dropped = 0;
+		_rows.assign(Ni, Row());
+		_combo.assign(Ni, Row(1));
+		_activeRow.assign(Ni, true);
+		_activeCol.assign(Nj, true);
+		_weight.assign(Nj, 0);
+		_colRows.assign(Nj, std::vector<size_t>());
+		_pivots.clear();
+		_empty.clear();
+		_queue.clear();
+
+		size_t nnz = 0;
+		for (size_t i = 0 ; i < Ni ; ++i) {
+			_combo[i][0] = std::pair<size_t, Element>(i, field().one);
+			readRow(i, A[i]);
+			nnz += _rows[i].size();
+		}
+		for (size_t j = 0 ; j < Nj ; ++j)
+			if (_weight[j] <= 2)
+				_queue.push_back(j);
+
+		filter();
+
+		// drop the heaviest rows in excess, which frees more pivots
+		while (excess >= 0) {
+			size_t m = 0, n = 0;
+			std::vector<std::pair<size_t, size_t> > weights;
+			for (size_t i = 0 ; i < Ni ; ++i)
+				if (_activeRow[i]) {
+					++m;
+					weights.push_back(std::pair<size_t, size_t>(_rows[i].size(), i));
+				}
+			for (size_t j = 0 ; j < Nj ; ++j)
+				n += _activeCol[j];
+			if (m <= n + (size_t)excess)
+				break;
+			std::sort(weights.begin(), weights.end());
+			for (size_t k = 0 ; k < m - n - (size_t)excess ; ++k) {
+				removeRow(weights[weights.size()-1-k].second);
+				++_dropped;
+			}
+			filter();
+		}
+
+		// the reduced matrix, written back in the leading block
+		_rowMap.clear();
+		_colMap.clear();
+		std::vector<size_t> newCol(Nj, 0);
+		for (size_t j = 0 ; j < Nj ; ++j)
+			if (_activeCol[j]) {
+				newCol[j] = _colMap.size();
+				_colMap.push_back(j);
+			}
+		for (size_t i = 0 ; i < Ni ; ++i)
+			if (_activeRow[i])
+				_rowMap.push_back(i);
+
+		size_t rnnz = 0;
+		for (size_t k = 0 ; k < Ni ; ++k) {
+			A[k].clear();
+			if (k >= rowdim())
+				continue;
+			writeRow(A[k], _rows[_rowMap[k]], newCol);
+			rnnz += _rows[_rowMap[k]].size();
+		}
+
+		// the active rows are not needed for lifting, nor the
+		// combinations of the others
+		for (size_t i = 0 ; i < Ni ; ++i)
+			if (_activeRow[i])
+				Row().swap(_rows[i]);
+			else
+				Row().swap(_combo[i]);
+		std::vector<std::vector<size_t> >().swap(_colRows);
+
+		commentator().report (Commentator::LEVEL_NORMAL, INTERNAL_DESCRIPTION)
+			<< Ni << 'x' << Nj << " (" << nnz << " entries) reduced to "
+			<< rowdim() << 'x' << coldim() << " (" << rnnz << " entries), "
+			<< pivots() << " pivots, " << _empty.size() << " empty columns, "
+			<< _dropped << " rows dropped" << std::endl;
+		commentator().stop ("done", NULL, "StructuredElimination::reducein");
+		return pivots();
+	}
+
+	template <class _Field>
+	void StructuredElimination<_Field>::filter ()
+	{
+		while (!_queue.empty()) {
+			const size_t j = _queue.back();
+			_queue.pop_back();
+			if (!_activeCol[j] || _weight[j] > 2)
+				continue;
+
+			if (_weight[j] == 0) {
+				_activeCol[j] = false;
+				_empty.push_back(j);
+				continue;
+			}
+
+			// the active rows of column j
+			size_t rows[2], w = 0;
+			for (size_t k = 0 ; k < _colRows[j].size() && w < _weight[j] ; ++k) {
+				size_t i = _colRows[j][k];
+				if (_activeRow[i] && (w == 0 || rows[0] != i) && contains(i, j))
+					rows[w++] = i;
+			}
+			linbox_check(w == _weight[j]);
+
+			size_t p = rows[0];
+			if (w == 2) {
+				// the lighter row is the pivot, added to the other
+				if (_rows[rows[1]].size() < _rows[p].size())
+					std::swap(rows[0], rows[1]);
+				p = rows[0];
+				mergeRows(rows[1], p, j);
+			}
+
+			_activeCol[j] = false;
+			removeRow(p);
+			Pivot P;
+			P.col = j;
+			P.row.swap(_rows[p]);
+			_pivots.push_back(P);
+		}
+	}
+
+	template <class _Field>
+	template <class Fill, class Cancel>
+	void StructuredElimination<_Field>::axpyRow (Row &r2, const Element &c, const Row &r1, const Fill &fill, const Cancel &cancel) const
+	{
+		Row r;
+		r.reserve(r1.size() + r2.size());
+		typename Row::const_iterator e1 = r1.begin(), e2 = r2.begin();
+		Element t;
+		while (e1 != r1.end() || e2 != r2.end()) {
+			if (e2 == r2.end() || (e1 != r1.end() && e1->first < e2->first)) {
+				field().mul(t, c, e1->second);
+				r.push_back(std::pair<size_t, Element>(e1->first, t));
+				fill(e1->first);
+				++e1;
+			}
+			else if (e1 == r1.end() || e2->first < e1->first) {
+				r.push_back(*e2);
+				++e2;
+			}
+			else {
+				field().axpy(t, c, e1->second, e2->second);
+				if (field().isZero(t))
+					cancel(e1->first);
+				else
+					r.push_back(std::pair<size_t, Element>(e1->first, t));
+				++e1;
+				++e2;
+			}
+		}
+		r2.swap(r);
+	}
+
+	template <class _Field>
+	void StructuredElimination<_Field>::mergeRows (size_t i2, size_t i1, size_t j)
+	{
+		// c = - a_{i2,j} / a_{i1,j}
+		Element c;
+		field().div(c, value(i2, j), value(i1, j));
+		field().negin(c);
+
+		axpyRow(_rows[i2], c, _rows[i1],
+			[this, i2](size_t k) {
+				++_weight[k];
+				_colRows[k].push_back(i2);
+			},
+			[this](size_t k) {
+				if (--_weight[k] <= 2)
+					_queue.push_back(k);
+			});
+		axpyRow(_combo[i2], c, _combo[i1], [](size_t) {}, [](size_t) {});
+	}
+
+}
+
+#endif // __LINBOX_structured_elimination_H
+
+// vim:sts=8:sw=8:ts=8:noet:sr:cino=>s,f0,{0,g0,(0,:0,t0,+0,=s
+// Local Variables:
+// mode: C++
+// tab-width: 8
+// indent-tabs-mode: nil
+// c-basic-offset: 8
+// End:
@@ -32,223 +32,136 @@
 #include "linbox/algorithms/density.h"
 #include "linbox/blackbox/blackbox-interface.h"
 #include "linbox/blackbox/subrowmatrix.h"
-#include "linbox/blackbox/blackbox_thread.h"
+#include "linbox/util/thread-pool.h"
 
-#include <typeinfo>
+#include <vector>
 
 namespace LinBox
 {
 
-	/** \brief This is a matrix representation supporting a parallel matrix vector product
-	 */
-	template <class Out, class Matrix, class In>
-	Out& BlackboxParallel(Out& out,const Matrix& m,
-			      const In& in, BBBase::BBType type) : public BlackboxInterface
-
+	struct BBBase {
+		typedef enum {Apply, ApplyTranspose} BBType;
+	};
 
-	template <class Out, class Matrix, class In>
-	Out& BlackboxParallel(Out& out, const Matrix& cm, const In& in, BBBase::BBType type) : public BlackboxInterface
+	/*- Splits the rows of m in nparts blocks of about the same number of
+	 * non zero entries. part[t]..part[t+1] are the rows of block t.
+	 */
+	template <class Matrix>
+	void BlackboxPartition(std::vector<size_t>& part, const Matrix& m, size_t nparts)
 	{
+		std::vector<size_t> load(m. rowdim() + 1, 0);
 
-		typedef SubRowMatrix<Matrix> SubMatrix;
-
-		typedef typename Out::iterator OutIterator;
-
-		typedef typename In::const_iterator InIterator;
-
-		typename BB_list_list::const_iterator cp;
-
-		const std::type_info * key = & typeid (Out& (*) (Out&, const Matrix&, const In&));
-
-		// search the threads info location
-		cp = cm. sub_list. find (key);
-
-		// allocate threads for this apply function
-		if (cp == cm. sub_list. end()) {
-
-			Matrix& m = const_cast<Matrix&>(cm);
-
-			m. sub_list. insert (std::pair<const std::type_info*,
-						    BB_list>
-						(key, BB_list()));
-
-			typename BB_list_list::iterator p;
-
-			p = m. sub_list. find (key);
+		typename Matrix::ConstRowIterator row_p;
 
-			cp = p;
+		size_t i = 0;
 
-			pthread_sigmask (SIG_BLOCK, &(Thread::sigset), 0);
+		for (row_p = m. rowBegin(); row_p != m. rowEnd(); ++ row_p, ++ i)
 
-			const In* inaddr = NULL;
+			load[i+1] = load[i] + density(*row_p);
 
-			int nnz = 0;
+		part. assign (nparts + 1, m. rowdim());
 
-			int aver_load, cur_load;
+		part[0] = 0;
 
-			typename Matrix::ConstRowIterator row_p;
+		i = 0;
 
-			for (row_p = m. rowBegin(); row_p != m. rowEnd(); ++ row_p)
+		for (size_t t = 1; t < nparts; ++ t) {
 
-				nnz += density(*row_p);
+			size_t target = (load. back() * t) / nparts;
 
-			aver_load = (int)ceil((double)nnz / (double)LINBOX_NTHR);
+			while (i < m. rowdim() && load[i] < target)
 
-			cur_load = 0;
+				++ i;
 
-			int len = 0;
-
-			int pos = 0;
-
-			SubMatrix* subp;
-
-			Out* outaddr = NULL;
-
-			BBBase* t;
-
-			for (row_p = m. rowBegin(); row_p != m. rowEnd(); ++ row_p) {
-
-				cur_load += density(*row_p);
-
-				++ len;
-
-				if ((cur_load >= aver_load) || (((size_t)(pos + len) == cm. rowdim()) && (cur_load > 0))) {
+			part[t] = i;
+		}
+	}
 
-					cur_load = 0;
+	/** \brief Parallel matrix vector product of a row matrix.
+	 *
+	 * The rows are split in blocks of balanced density, each block is a
+	 * task of the library thread pool (see threadPool()). More blocks than
+	 * threads are created for the apply so that skewed rows are evened out
+	 * by work stealing. The transposed apply uses one partial result per
+	 * thread, summed at the end.
+	 */
+	template <class Out, class Matrix, class In>
+	Out& BlackboxParallel(Out& out, const Matrix& cm, const In& in, BBBase::BBType type)
+	{
 
-					subp = new SubMatrix(&m, pos, len);
+		typedef SubRowMatrix<Matrix> SubMatrix;
 
-					t = createBBThread(subp, outaddr, inaddr);
+		typedef typename Out::iterator OutIterator;
 
-					p -> second. push_back (t);
+		typedef typename In::const_iterator InIterator;
 
-					pos += len;
+		ThreadPool& pool = threadPool();
 
-					len = 0;
-				}
+		Matrix& m = const_cast<Matrix&>(cm);
 
-			}
-
-		}
+		std::vector<size_t> part;
 
 		switch (type) {
 
 		case BBBase::Apply :  {
 
-			std::vector<Subvector<OutIterator>*> outv(cp -> second.size());
-
-			typename std::vector<Subvector<OutIterator>*>::iterator outv_p = outv. begin();
-
-			int len = 0;
-
-			int pos = 0;
-
-			BB_list::const_iterator ti_p;
-
-			const In* inaddr = &in;
-
-			BBBase* bp = NULL;
-
-			// give the input for each threads, and signal them
-			for (ti_p = cp -> second. begin(); ti_p != cp -> second. end(); ++ ti_p, ++ outv_p) {
-
-				bp = *(ti_p);
-
-				len = ((const SubMatrix*)bp -> bb_addr) -> rowdim();
-
-				*outv_p = new Subvector<OutIterator>(out. begin() + pos,
-							  out. begin() + (pos + len));
-
-				bp -> bb_outaddr = (void*) *outv_p;
-
-				bp -> bb_inaddr = (const void*) inaddr;
-
-				bp -> bb_type = BBBase::Apply;
-
-				Thread::signal_thread (bp);
-
-				pos += len;
-			}
-
-			OutIterator out_p;
+			BlackboxPartition (part, cm, 4 * pool. size());
 
-			for (out_p = out. begin() + pos; out_p != out. end(); ++ out_p)
+			pool. parallelFor (0, part. size() - 1, [&](size_t t) {
 
-				cm. field(). assign(*out_p, cm.field().zero);
+				size_t len = part[t+1] - part[t];
 
-			for (ti_p = cp ->second. begin(); ti_p != cp -> second. end(); ++ ti_p)
+				if (len == 0)
+					return;
 
-			Thread::wait_thread (*ti_p);
+				SubMatrix sub(&m, part[t], len);
 
-			for (outv_p = outv. begin(); outv_p != outv. end(); ++ outv_p)
+				Subvector<OutIterator> sub_out(out. begin() + (ptrdiff_t)part[t],
+							       out. begin() + (ptrdiff_t)part[t+1]);
 
-			delete (*outv_p);
+				sub. apply (sub_out, in);
+			});
 
 			break; }
 
 		case BBBase::ApplyTranspose : {
 
-			int nthr = cp -> second. size ();
-
-			OutIterator out_p;
-
-			 for (out_p = out. begin(); out_p != out. end(); ++ out_p)
+			BlackboxPartition (part, cm, pool. size());
 
-                                cm. field(). assign(*out_p, cm.field().zero);
+			size_t nthr = part. size() - 1;
 
 			std::vector<std::vector<typename Matrix::Field::Element> > out_v(nthr);
 
-			std::vector<Subvector<InIterator>*> in_v(nthr);
-
-			typename std::vector<std::vector<typename Matrix::Field::Element> >::iterator out_v_p;
-
-			typename std::vector<Subvector<InIterator>*>::iterator in_v_p;
-
-                        int len = 0;
-
-                        int pos = 0;
+			pool. parallelFor (0, nthr, [&](size_t t) {
 
-                        BB_list::const_iterator ti_p;
+				size_t len = part[t+1] - part[t];
 
-                        BBBase* bp = NULL;
+				if (len == 0)
+					return;
 
-			for (ti_p = cp -> second. begin (), in_v_p = in_v. begin(), out_v_p = out_v. begin();
-			     ti_p != cp -> second. end();
-		  	     ++ ti_p, ++ in_v_p, ++ out_v_p) {
+				out_v[t]. resize (cm. coldim(), cm. field(). zero);
 
-				bp = *ti_p;
+				SubMatrix sub(&m, part[t], len);
 
-				len = ((const SubMatrix*)bp -> bb_addr) -> rowdim();
+				Subvector<InIterator> sub_in(in. begin() + (ptrdiff_t)part[t],
+							     in. begin() + (ptrdiff_t)part[t+1]);
 
-				*in_v_p = new Subvector<InIterator>(in. begin() + pos, in. begin() + (pos + len));
+				sub. applyTranspose (out_v[t], sub_in);
+			});
 
-				out_v_p -> resize (cm. coldim());
-
-				bp -> bb_outaddr = &(*out_v_p);
-
-				bp -> bb_inaddr = *in_v_p;
-
-				bp -> bb_type = BBBase::ApplyTranspose;
-
-				Thread::signal_thread (bp);
-
-				pos += len;
-			}
+			OutIterator out_p;
 
-			for (ti_p = cp ->second. begin(); ti_p != cp -> second. end(); ++ ti_p)
+			for (out_p = out. begin(); out_p != out. end(); ++ out_p)
 
-                       		Thread::wait_thread (*ti_p);
+				cm. field(). assign(*out_p, cm.field().zero);
 
 			VectorDomain<typename Matrix::Field> vd(cm. field());
 
-			for (out_v_p = out_v. begin(), in_v_p = in_v. begin();
-			     out_v_p != out_v. end(); ++ out_v_p, ++ in_v_p) {
-
-				vd. addin (out, *out_v_p);
+			for (size_t t = 0; t < nthr; ++ t)
 
-				delete (*in_v_p);
+				if (out_v[t]. size())
 
-			}
+					vd. addin (out, out_v[t]);
 
 			break; }
 
@@ -35,6 +35,7 @@
 #include "linbox/vector/stream.h"
 #include "linbox/matrix/sparse-matrix.h"
 #include "linbox/vector/light_container.h"
+#include "linbox/util/thread-pool.h"
 
 namespace LinBox
 {
@@ -56,14 +57,14 @@ namespace LinBox
 
 		const GF2 *_field;
 
-		ZeroOne(const GF2& ) :
-			_nnz(0)
+		ZeroOne(const GF2& F) :
+			_field(&F), _nnz(0)
 		{}
-		ZeroOne(const GF2& , const size_t m) :
-			Father_t(m), _rowdim(m), _coldim(m),_nnz(0)
+		ZeroOne(const GF2& F, const size_t m) :
+			Father_t(m), _field(&F), _rowdim(m), _coldim(m),_nnz(0)
 		{}
-		ZeroOne(const GF2& , const size_t m, const size_t n) :
-			Father_t(m), _rowdim(m), _coldim(n),_nnz(0)
+		ZeroOne(const GF2& F, const size_t m, const size_t n) :
+			Father_t(m), _field(&F), _rowdim(m), _coldim(n),_nnz(0)
 		{}
 
 		ZeroOne():
@@ -76,8 +77,8 @@ namespace LinBox
 			Father_t(m), _rowdim(m), _coldim(n),_nnz(0)
 		{}
 
-		ZeroOne(const GF2& , VectorStream<Row_t>& stream) :
-			Father_t(stream.m()), _rowdim(stream.m()), _coldim(stream.n()), _nnz(0)
+		ZeroOne(const GF2& F, VectorStream<Row_t>& stream) :
+			Father_t(stream.m()), _field(&F), _rowdim(stream.m()), _coldim(stream.n()), _nnz(0)
 		{
 			for (Father_t::iterator row=begin(); row != end(); ++row) {
 				stream >> *row;
@@ -86,12 +87,12 @@ namespace LinBox
 		}
 
 		ZeroOne(const Self_t& A) :
-			Father_t(static_cast<const Father_t&>(A)), _rowdim(A._rowdim), _coldim(A._coldim), _nnz(A._nnz)
+			Father_t(static_cast<const Father_t&>(A)), _field(A._field), _rowdim(A._rowdim), _coldim(A._coldim), _nnz(A._nnz)
 		{ }
 
-		ZeroOne(const GF2& , size_t* rowP, size_t* colP,
+		ZeroOne(const GF2& F, size_t* rowP, size_t* colP,
 			const size_t m, const size_t n, const size_t Nnz, const bool ,const bool) :
-			Father_t(m), _rowdim(m), _coldim(n), _nnz(Nnz)
+			Father_t(m), _field(&F), _rowdim(m), _coldim(n), _nnz(Nnz)
 		{
 			for(size_t k=0; k<Nnz; ++k)
 				this->operator[](rowP[k]).push_back(colP[k]);
@@ -112,6 +113,23 @@ namespace LinBox
 		template<class OutVector, class InVector>
 		OutVector& applyTranspose(OutVector& y, const InVector& x) const; // y = A^T x
 
+		/** Y = A X, for a block X of up to 64 vectors.
+		 * A block is bit-sliced: it has one 64-bit word per row
+		 * (std::vector<uint64_t> for instance), bit k of the word being
+		 * the entry of the k-th vector. A row of A is then applied to
+		 * all the vectors at once, with XORs. The rows are shared
+		 * among the threads of threadPool().
+		 */
+		template<class WordVector>
+		WordVector& applyBlock(WordVector& Y, const WordVector& X) const;
+
+		/** Y = A^T X, for a bit-sliced block X.
+		 * This one scatters the rows and is sequential: applying
+		 * a stored transpose with applyBlock is faster in parallel.
+		 */
+		template<class WordVector>
+		WordVector& applyTransposeBlock(WordVector& Y, const WordVector& X) const;
+
 		/** Read the matrix from a stream in ANY format
 		 *  entries are read as "long int" and set to 1 if they are odd,
 		 *  0 otherwise
@@ -93,6 +93,35 @@ namespace LinBox
 	}
 
 
+	template<class WordVector>
+	inline WordVector & ZeroOne<GF2>::applyBlock(WordVector & Y, const WordVector & X) const
+	{
+		const size_t m = rowdim();
+		const size_t chunks = std::min(m, 4*threadPool().size());
+		threadPool().parallelFor(0, chunks, [&](size_t t) {
+			for (size_t i = t*m/chunks ; i < (t+1)*m/chunks ; ++i) {
+				const Row_t & row = this->operator[](i);
+				typename WordVector::value_type w(0);
+				for (Row_t::const_iterator loc = row.begin(); loc != row.end(); ++loc)
+					w ^= X[*loc];
+				Y[i] = w;
+			}
+		});
+		return Y;
+	}
+
+	template<class WordVector>
+	inline WordVector & ZeroOne<GF2>::applyTransposeBlock(WordVector & Y, const WordVector & X) const
+	{
+		std::fill(Y.begin(), Y.begin()+coldim(), typename WordVector::value_type(0));
+		for (size_t i = 0 ; i < rowdim() ; ++i) {
+			const Row_t & row = this->operator[](i);
+			for (Row_t::const_iterator loc = row.begin(); loc != row.end(); ++loc)
+				Y[*loc] ^= X[i];
+		}
+		return Y;
+	}
+
 	inline void ZeroOne<GF2>::setEntry(size_t i, size_t j, const Element& v) {
 		Row_t& rowi = this->operator[](i);
 		Row_t::iterator there = std::lower_bound(rowi.begin(), rowi.end(), j);
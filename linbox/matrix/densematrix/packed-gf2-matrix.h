@@ -0,0 +1,292 @@
+/* linbox/matrix/densematrix/packed-gf2-matrix.h
+ * Copyright (C) 2016 the LinBox group
+ *
+ * ========LICENCE========
+ * This file is part of the library LinBox.
+ *
+ * LinBox is free software: you can redistribute it and/or modify
+ * it under the terms of the  GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ * ========LICENCE========
+ */
+
+/*! @file matrix/densematrix/packed-gf2-matrix.h
+ * @ingroup densematrix
+ * @brief Dense matrices over GF2, packed 64 entries per word.
+ *
+ * This is the representation used by the method of four Russians in
+ * MatrixDomain<GF2> (multiplication, rank, echelon form, nullspace).
+ */
+
+#ifndef __LINBOX_densematrix_packed_gf2_matrix_H
+#define __LINBOX_densematrix_packed_gf2_matrix_H
+
+#include <algorithm>
+#include <iostream>
+#include <random>
+#include <stdint.h>
+#include <vector>
+
+#include "linbox/field/gf2.h"
+#include "linbox/util/debug.h"
+
+namespace LinBox
+{
+
+	/*! Dense matrix over GF2, packed by rows.
+	 * @ingroup densematrix
+	 *
+	 * Entry <code>(i,j)</code> is bit <code>j%64</code> of the word
+	 * <code>j/64</code> of row \c i, and every row starts on a word
+	 * boundary (at word <code>i*stride()</code>). The bits beyond
+	 * coldim() in the last word of a row are always zero, so that rows can
+	 * be added word by word.
+	 *
+	 * A matrix can also be a window on another one, starting on a word
+	 * boundary: it then shares its storage, like BlasSubmatrix.
+	 */
+	class PackedGF2Matrix {
+	public:
+		typedef GF2                 Field;
+		typedef GF2::Element        Element;
+		typedef uint64_t            word_type;
+		typedef PackedGF2Matrix     Self_t;
+
+		static const size_t         WORD = 64;
+
+		//! \p m x \p n zero matrix.
+		PackedGF2Matrix (const GF2 &F, size_t m = 0, size_t n = 0) :
+			_field(&F), _row(m), _col(n), _stride(wordsFor(n)),
+			_rep(m*wordsFor(n), 0), _ptr(_rep.empty() ? NULL : &_rep[0])
+		{}
+
+		//! Deep copy, also of a window.
+		PackedGF2Matrix (const Self_t &A) :
+			_field(A._field), _row(A._row), _col(A._col), _stride(A.words()),
+			_rep(A._row*A.words()), _ptr(_rep.empty() ? NULL : &_rep[0])
+		{
+			for (size_t i = 0 ; i < _row ; ++i)
+				std::copy(A.rowPtr(i), A.rowPtr(i)+_stride, rowPtr(i));
+		}
+
+		// not the template constructor below
+		PackedGF2Matrix (Self_t &A) :
+			PackedGF2Matrix(static_cast<const Self_t &>(A))
+		{}
+
+		/*! Window on rows <code>[i0,i0+m)</code> and columns
+		 * <code>[j0,j0+n)</code> of \p A, sharing its storage.
+		 * \p j0 must be a multiple of 64, and \p j0+n is either a
+		 * multiple of 64 or the column dimension of \p A.
+		 */
+		PackedGF2Matrix (Self_t &A, size_t i0, size_t j0, size_t m, size_t n) :
+			_field(A._field), _row(m), _col(n), _stride(A._stride),
+			_rep(), _ptr(A._ptr + i0*A._stride + j0/WORD)
+		{
+			linbox_check(j0 % WORD == 0);
+			linbox_check(i0+m <= A._row && j0+n <= A._col);
+			linbox_check((j0+n) % WORD == 0 || j0+n == A._col);
+		}
+
+		/*! Packed copy of any matrix over GF2 with \c getEntry.
+		 */
+		template<class Matrix>
+		PackedGF2Matrix (const Matrix &A) :
+			_field(&A.field()), _row(A.rowdim()), _col(A.coldim()), _stride(wordsFor(A.coldim())),
+			_rep(A.rowdim()*wordsFor(A.coldim()), 0), _ptr(_rep.empty() ? NULL : &_rep[0])
+		{
+			Element x;
+			for (size_t i = 0 ; i < _row ; ++i)
+				for (size_t j = 0 ; j < _col ; ++j)
+					if (A.getEntry(x,i,j))
+						setEntry(i,j,true);
+		}
+
+		//! Copies the entries of \p A, which has the same shape.
+		Self_t &operator= (const Self_t &A)
+		{
+			if (&A == this)
+				return *this;
+			linbox_check(_row == A._row && _col == A._col);
+			for (size_t i = 0 ; i < _row ; ++i)
+				std::copy(A.rowPtr(i), A.rowPtr(i)+words(), rowPtr(i));
+			return *this;
+		}
+
+		/*! Reshapes to a \p m x \p n zero matrix.
+		 * Not for a window.
+		 */
+		void resize (size_t m, size_t n)
+		{
+			linbox_check(_ptr == NULL || !_rep.empty());
+			_row = m;
+			_col = n;
+			_stride = wordsFor(n);
+			_rep.assign(m*_stride, 0);
+			_ptr = _rep.empty() ? NULL : &_rep[0];
+		}
+
+		const GF2 &field () const { return *_field; }
+		size_t rowdim () const { return _row; }
+		size_t coldim () const { return _col; }
+
+		//! distance in words between two rows.
+		size_t stride () const { return _stride; }
+
+		//! number of words of a row.
+		size_t words () const { return wordsFor(_col); }
+
+		word_type *rowPtr (size_t i) { return _ptr + i*_stride; }
+		const word_type *rowPtr (size_t i) const { return _ptr + i*_stride; }
+
+		bool getEntry (size_t i, size_t j) const
+		{
+			return (rowPtr(i)[j/WORD] >> (j%WORD)) & 1;
+		}
+
+		Element &getEntry (Element &x, size_t i, size_t j) const
+		{
+			return x = getEntry(i,j);
+		}
+
+		void setEntry (size_t i, size_t j, const Element &x)
+		{
+			word_type mask = word_type(1) << (j%WORD);
+			if (x)
+				rowPtr(i)[j/WORD] |= mask;
+			else
+				rowPtr(i)[j/WORD] &= ~mask;
+		}
+
+		//! row \p i += row \p k, from the word \p w on.
+		void addRow (size_t i, size_t k, size_t w = 0)
+		{
+			word_type *a = rowPtr(i);
+			const word_type *b = rowPtr(k);
+			for (size_t l = w ; l < words() ; ++l)
+				a[l] ^= b[l];
+		}
+
+		void swapRows (size_t i, size_t k)
+		{
+			if (i != k)
+				std::swap_ranges(rowPtr(i), rowPtr(i)+words(), rowPtr(k));
+		}
+
+		//! Overwrite with zeroes.
+		Self_t &zero ()
+		{
+			for (size_t i = 0 ; i < _row ; ++i)
+				std::fill(rowPtr(i), rowPtr(i)+words(), word_type(0));
+			return *this;
+		}
+
+		//! Overwrite with random bits.
+		void random (uint64_t seed = 0)
+		{
+			std::mt19937_64 gen(seed);
+			for (size_t i = 0 ; i < _row ; ++i) {
+				word_type *a = rowPtr(i);
+				for (size_t l = 0 ; l < words() ; ++l)
+					a[l] = gen();
+				clearPadding(i);
+			}
+		}
+
+		/*! \p y = A \p x, with vectors of bits (BitVector, std::vector<bool>...).
+		 */
+		template<class OutVector, class InVector>
+		OutVector &apply (OutVector &y, const InVector &x) const
+		{
+			linbox_check(x.size() == _col && y.size() == _row);
+			std::vector<word_type> xw(words(), 0);
+			for (size_t j = 0 ; j < _col ; ++j)
+				if (x[j])
+					xw[j/WORD] |= word_type(1) << (j%WORD);
+			for (size_t i = 0 ; i < _row ; ++i) {
+				const word_type *a = rowPtr(i);
+				word_type t = 0;
+				for (size_t l = 0 ; l < words() ; ++l)
+					t ^= a[l] & xw[l];
+				y[i] = parity(t);
+			}
+			return y;
+		}
+
+		/*! \p y = A^T \p x.
+		 */
+		template<class OutVector, class InVector>
+		OutVector &applyTranspose (OutVector &y, const InVector &x) const
+		{
+			linbox_check(x.size() == _row && y.size() == _col);
+			std::vector<word_type> yw(words(), 0);
+			for (size_t i = 0 ; i < _row ; ++i)
+				if (x[i]) {
+					const word_type *a = rowPtr(i);
+					for (size_t l = 0 ; l < words() ; ++l)
+						yw[l] ^= a[l];
+				}
+			for (size_t j = 0 ; j < _col ; ++j)
+				y[j] = (yw[j/WORD] >> (j%WORD)) & 1;
+			return y;
+		}
+
+		std::ostream &write (std::ostream &os) const
+		{
+			for (size_t i = 0 ; i < _row ; ++i) {
+				for (size_t j = 0 ; j < _col ; ++j)
+					os << (getEntry(i,j) ? '1' : '0');
+				os << std::endl;
+			}
+			return os;
+		}
+
+		static size_t wordsFor (size_t n)
+		{
+			return (n+WORD-1)/WORD;
+		}
+
+		static bool parity (word_type t)
+		{
+			return __builtin_parityll(t);
+		}
+
+	private:
+		void clearPadding (size_t i)
+		{
+			if (_col % WORD)
+				rowPtr(i)[words()-1] &= (word_type(1) << (_col%WORD)) - 1;
+		}
+
+		const GF2               *_field;
+		size_t                   _row;
+		size_t                   _col;
+		size_t                   _stride;
+		std::vector<word_type>   _rep;
+		word_type               *_ptr;
+	};
+
+	//! A packed matrix is always eliminated.
+	inline bool useBB(const PackedGF2Matrix &) { return false; }
+
+}
+
+#endif // __LINBOX_densematrix_packed_gf2_matrix_H
+
+// vim:sts=8:sw=8:ts=8:noet:sr:cino=>s,f0,{0,g0,(0,:0,t0,+0,=s
+// Local Variables:
+// mode: C++
+// tab-width: 8
+// indent-tabs-mode: nil
+// c-basic-offset: 8
+// End:
@@ -40,13 +40,17 @@
 
 #include "linbox/field/gf2.h"
 #include "linbox/matrix/matrix-domain.h"
+#include "linbox/matrix/densematrix/packed-gf2-matrix.h"
 
 // Specialization of MatrixDomain for GF2
 namespace LinBox
 {
 	/*! Specialization of MatrixDomain for GF2.
-	 * @bug this is half done and makes MatrixDomain on GF2 hardly usable.
-	 * @todo this is where m4ri will play.
+	 * Dense PackedGF2Matrix operands use the method of four Russians:
+	 * M4RM multiplication with Strassen-Winograd recursion above a
+	 * cutoff, and M4RI elimination for the rank, echelon forms and
+	 * nullspace. Rows are processed in parallel on threadPool().
+	 * @bug the vector products are half done.
 	 */
 	template <>
 	class MatrixDomain<GF2> {
@@ -99,7 +103,65 @@ namespace LinBox
 					    VectorCategories::DenseZeroOneVectorTag,
 					    VectorCategories::SparseZeroOneVectorTag) const;
 
+		/*! @name Dense packed matrices
+		 * Method of four Russians.
+		 */
+		//@{
+
+		//! number of columns eliminated, or rows of B combined, per table.
+		static const size_t M4RI_K = 8;
+
+		//! smallest dimension (in bits) for a Strassen-Winograd step.
+		static const size_t STRASSEN_CUTOFF = 4096;
+
+		//! C = A + B.
+		PackedGF2Matrix &add (PackedGF2Matrix &C, const PackedGF2Matrix &A, const PackedGF2Matrix &B) const;
+
+		//! C += A.
+		PackedGF2Matrix &addin (PackedGF2Matrix &C, const PackedGF2Matrix &A) const;
+
+		//! C = AB.
+		PackedGF2Matrix &mul (PackedGF2Matrix &C, const PackedGF2Matrix &A, const PackedGF2Matrix &B) const;
+
+		//! C += AB.
+		PackedGF2Matrix &axpyin (PackedGF2Matrix &C, const PackedGF2Matrix &A, const PackedGF2Matrix &B) const;
+
+		/*! Row echelon form of \p A, in place (M4RI).
+		 * @param A       matrix, overwritten by its (reduced) row echelon form
+		 * @param pivots  the column of the pivot of the rows <code>0..rank-1</code>
+		 * @param reduced if true, the entries above the pivots are zeroed too.
+		 * @return the rank of \p A
+		 */
+		size_t echelonize (PackedGF2Matrix &A, std::vector<size_t> &pivots, bool reduced = false) const;
+
+		//! rank of \p A, which is modified.
+		size_t rankin (PackedGF2Matrix &A) const;
+
+		//! rank of \p A.
+		size_t rank (const PackedGF2Matrix &A) const;
+
+		/*! Basis of the right nullspace of \p A, which is modified.
+		 * \p N is resized (n x kerdim) and its columns are the basis.
+		 * @return the dimension of the nullspace.
+		 */
+		size_t nullspaceBasisIn (PackedGF2Matrix &N, PackedGF2Matrix &A) const;
+
+		//! transpose of \p A in \p T (resized).
+		PackedGF2Matrix &transpose (PackedGF2Matrix &T, const PackedGF2Matrix &A) const;
+
+		//@}
+
 		VectorDomain<GF2> _VD;
+
+	private:
+		typedef PackedGF2Matrix::word_type word_type;
+
+		// C += AB with the method of four Russians.
+		void m4rm (PackedGF2Matrix &C, const PackedGF2Matrix &A, const PackedGF2Matrix &B) const;
+
+		// f(i) for the rows i in [begin,end), in parallel when work (in words) is large.
+		template<class Func>
+		static void forRows (size_t begin, size_t end, size_t work, const Func &f);
 	};
 
 	template <class Vector1, class Matrix, class Vector2>
@@ -179,6 +241,8 @@ namespace LinBox
 
 }
 
+#include "linbox/matrix/matrixdomain/matrix-domain-m4ri.inl"
+
 #endif // __LINBOX_matrix_domain_H
 
 
@@ -0,0 +1,327 @@
+/* linbox/matrix/matrixdomain/matrix-domain-m4ri.inl
+ * Copyright (C) 2016 the LinBox group
+ *
+ * ========LICENCE========
+ * This file is part of the library LinBox.
+ *
+ * LinBox is free software: you can redistribute it and/or modify
+ * it under the terms of the  GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ * ========LICENCE========
+ */
+
+/*! @file matrix/matrixdomain/matrix-domain-m4ri.inl
+ * @ingroup matrixdomain
+ * @brief Method of four Russians over GF2 on PackedGF2Matrix.
+ *
+ * M4RM: the rows of \c B are taken \c k at a time, the \c 2^k sums of
+ * these rows are tabulated, and each row of \c C gets the one selected by
+ * the \c k bits of the row of \c A, so a product costs
+ * <code>m l n / (64 k)</code> word operations instead of
+ * <code>m l n / 64</code>.
+ *
+ * M4RI: the same tables eliminate \c k pivots at a time. The pivots of a
+ * block of \c k columns are found by plain Gaussian elimination, reduced
+ * to the identity on their columns, and every other row is cleared on
+ * these columns by one table lookup.
+ */
+
+#ifndef __LINBOX_matrixdomain_matrix_domain_m4ri_INL
+#define __LINBOX_matrixdomain_matrix_domain_m4ri_INL
+
+#include <algorithm>
+#include <vector>
+
+#include "linbox/util/thread-pool.h"
+
+namespace LinBox
+{
+
+	template<class Func>
+	inline void MatrixDomain<GF2>::forRows (size_t begin, size_t end, size_t work, const Func &f)
+	{
+		if (end <= begin)
+			return;
+		const size_t m = end - begin;
+		size_t chunks = std::min(m, 4*threadPool().size());
+		if (m*work < (size_t(1) << 16))
+			chunks = 1;
+		threadPool().parallelFor(0, chunks, [&](size_t t) {
+			for (size_t i = begin + t*m/chunks ; i < begin + (t+1)*m/chunks ; ++i)
+				f(i);
+		});
+	}
+
+	inline PackedGF2Matrix &MatrixDomain<GF2>::addin (PackedGF2Matrix &C, const PackedGF2Matrix &A) const
+	{
+		linbox_check(C.rowdim() == A.rowdim() && C.coldim() == A.coldim());
+		const size_t w = C.words();
+		forRows(0, C.rowdim(), w, [&](size_t i) {
+			word_type *c = C.rowPtr(i);
+			const word_type *a = A.rowPtr(i);
+			for (size_t l = 0 ; l < w ; ++l)
+				c[l] ^= a[l];
+		});
+		return C;
+	}
+
+	inline PackedGF2Matrix &MatrixDomain<GF2>::add (PackedGF2Matrix &C, const PackedGF2Matrix &A,
+							const PackedGF2Matrix &B) const
+	{
+		C = A;
+		return addin(C, B);
+	}
+
+	inline void MatrixDomain<GF2>::m4rm (PackedGF2Matrix &C, const PackedGF2Matrix &A,
+					     const PackedGF2Matrix &B) const
+	{
+		const size_t m = A.rowdim(), l = A.coldim(), w = B.words();
+		const size_t k = M4RI_K;
+		std::vector<word_type> T((size_t(1) << k) * w);
+
+		for (size_t j0 = 0 ; j0 < l ; j0 += k) {
+			const size_t kk = std::min(k, l-j0);
+			const size_t mask = (size_t(1) << kk) - 1;
+
+			// T[b] = sum of the rows j0+t of B for the bits t of b
+			std::fill(T.begin(), T.begin()+(ptrdiff_t)w, word_type(0));
+			for (size_t b = 1 ; b <= mask ; ++b) {
+				const word_type *prev = &T[(b & (b-1))*w];
+				const word_type *row  = B.rowPtr(j0 + (size_t)__builtin_ctzll(b));
+				word_type *t = &T[b*w];
+				for (size_t x = 0 ; x < w ; ++x)
+					t[x] = prev[x] ^ row[x];
+			}
+
+			// k divides 64: the k bits are in one word
+			forRows(0, m, w, [&](size_t i) {
+				const size_t b = (A.rowPtr(i)[j0/PackedGF2Matrix::WORD] >> (j0%PackedGF2Matrix::WORD)) & mask;
+				if (b == 0)
+					return;
+				word_type *c = C.rowPtr(i);
+				const word_type *t = &T[b*w];
+				for (size_t x = 0 ; x < w ; ++x)
+					c[x] ^= t[x];
+			});
+		}
+	}
+
+	inline PackedGF2Matrix &MatrixDomain<GF2>::axpyin (PackedGF2Matrix &C, const PackedGF2Matrix &A,
+							   const PackedGF2Matrix &B) const
+	{
+		linbox_check(A.coldim() == B.rowdim());
+		linbox_check(C.rowdim() == A.rowdim() && C.coldim() == B.coldim());
+		const size_t m = A.rowdim(), l = A.coldim(), n = B.coldim();
+		const size_t W = PackedGF2Matrix::WORD;
+
+		if (std::min(std::min(m,l),n) < STRASSEN_CUTOFF) {
+			m4rm(C, A, B);
+			return C;
+		}
+
+		// Strassen-Winograd on the largest even part, the column splits
+		// on word boundaries; all the signs vanish in characteristic 2.
+		const size_t m2 = m/2, l2 = (l/(2*W))*W, n2 = (n/(2*W))*W;
+		PackedGF2Matrix &Am = const_cast<PackedGF2Matrix &>(A);
+		PackedGF2Matrix &Bm = const_cast<PackedGF2Matrix &>(B);
+		const PackedGF2Matrix A11(Am, 0, 0, m2, l2), A12(Am, 0, l2, m2, l2),
+		      A21(Am, m2, 0, m2, l2), A22(Am, m2, l2, m2, l2);
+		const PackedGF2Matrix B11(Bm, 0, 0, l2, n2), B12(Bm, 0, n2, l2, n2),
+		      B21(Bm, l2, 0, l2, n2), B22(Bm, l2, n2, l2, n2);
+		PackedGF2Matrix C11(C, 0, 0, m2, n2), C12(C, 0, n2, m2, n2),
+				C21(C, m2, 0, m2, n2), C22(C, m2, n2, m2, n2);
+
+		const GF2 &F = C.field();
+		PackedGF2Matrix S(F, m2, l2), T(F, l2, n2), Q(F, m2, n2);
+
+		add(S, A21, A22);               // S1
+		add(T, B12, B11);               // T1
+		axpyin(Q, S, T);                // P5
+		addin(C12, Q); addin(C22, Q);
+
+		addin(S, A11);                  // S2 = S1 + A11
+		addin(T, B22);                  // T2 = T1 + B22
+		axpyin(Q.zero(), S, T);         // P6
+		addin(C12, Q); addin(C21, Q); addin(C22, Q);
+
+		addin(S, A12);                  // S4 = S2 + A12
+		axpyin(Q.zero(), S, B22);       // P3
+		addin(C12, Q);
+
+		addin(T, B21);                  // T4 = T2 + B21
+		axpyin(Q.zero(), A22, T);       // P4
+		addin(C21, Q);
+
+		add(S, A11, A21);               // S3
+		add(T, B22, B12);               // T3
+		axpyin(Q.zero(), S, T);         // P7
+		addin(C21, Q); addin(C22, Q);
+
+		axpyin(Q.zero(), A11, B11);     // P1
+		addin(C11, Q); addin(C12, Q); addin(C21, Q); addin(C22, Q);
+
+		axpyin(C11, A12, B21);          // P2
+
+		// the remaining rows and columns
+		if (l > 2*l2) {
+			PackedGF2Matrix Cc(C, 0, 0, 2*m2, 2*n2);
+			const PackedGF2Matrix Ar(Am, 0, 2*l2, 2*m2, l-2*l2), Br(Bm, 2*l2, 0, l-2*l2, 2*n2);
+			axpyin(Cc, Ar, Br);
+		}
+		if (n > 2*n2) {
+			PackedGF2Matrix Cr(C, 0, 2*n2, m, n-2*n2);
+			const PackedGF2Matrix Br(Bm, 0, 2*n2, l, n-2*n2);
+			axpyin(Cr, A, Br);
+		}
+		if (m > 2*m2) {
+			PackedGF2Matrix Cr(C, 2*m2, 0, m-2*m2, 2*n2);
+			const PackedGF2Matrix Ar(Am, 2*m2, 0, m-2*m2, l), Bl(Bm, 0, 0, l, 2*n2);
+			axpyin(Cr, Ar, Bl);
+		}
+		return C;
+	}
+
+	inline PackedGF2Matrix &MatrixDomain<GF2>::mul (PackedGF2Matrix &C, const PackedGF2Matrix &A,
+							const PackedGF2Matrix &B) const
+	{
+		return axpyin(C.zero(), A, B);
+	}
+
+	inline size_t MatrixDomain<GF2>::echelonize (PackedGF2Matrix &A, std::vector<size_t> &pivots,
+						     bool reduced) const
+	{
+		const size_t m = A.rowdim(), n = A.coldim(), W = PackedGF2Matrix::WORD;
+		const size_t k = M4RI_K;
+		size_t r = 0;
+		pivots.clear();
+		std::vector<word_type> T;
+		std::vector<size_t> piv;
+
+		for (size_t c = 0 ; c < n && r < m ; c += k) {
+			const size_t w0 = c/W, w = A.words() - w0;
+
+			// pivots of the columns [c,c+k), by Gaussian elimination
+			piv.clear();
+			for (size_t j = c ; j < std::min(c+k,n) && r+piv.size() < m ; ++j) {
+				const size_t top = r + piv.size();
+				for (size_t i = top ; i < m ; ++i) {
+					for (size_t p = 0 ; p < piv.size() ; ++p)
+						if (A.getEntry(i, piv[p]))
+							A.addRow(i, r+p, w0);
+					if (A.getEntry(i, j)) {
+						A.swapRows(i, top);
+						piv.push_back(j);
+						break;
+					}
+				}
+			}
+			const size_t kk = piv.size();
+			if (kk == 0)
+				continue;
+
+			// identity on the pivot columns
+			for (size_t q = 1 ; q < kk ; ++q)
+				for (size_t p = 0 ; p < q ; ++p)
+					if (A.getEntry(r+p, piv[q]))
+						A.addRow(r+p, r+q, w0);
+
+			// T[b] = sum of the pivot rows r+t for the bits t of b
+			T.assign((size_t(1) << kk) * w, 0);
+			for (size_t b = 1 ; b < (size_t(1) << kk) ; ++b) {
+				const word_type *prev = &T[(b & (b-1))*w];
+				const word_type *row  = A.rowPtr(r + (size_t)__builtin_ctzll(b)) + w0;
+				word_type *t = &T[b*w];
+				for (size_t x = 0 ; x < w ; ++x)
+					t[x] = prev[x] ^ row[x];
+			}
+
+			// clears the pivot columns of the other rows
+			auto clear = [&](size_t i) {
+				size_t b = 0;
+				for (size_t p = 0 ; p < kk ; ++p)
+					b |= size_t(A.getEntry(i, piv[p])) << p;
+				if (b == 0)
+					return;
+				word_type *a = A.rowPtr(i) + w0;
+				const word_type *t = &T[b*w];
+				for (size_t x = 0 ; x < w ; ++x)
+					a[x] ^= t[x];
+			};
+			forRows(r+kk, m, w, clear);
+			if (reduced)
+				forRows(0, r, w, clear);
+
+			pivots.insert(pivots.end(), piv.begin(), piv.end());
+			r += kk;
+		}
+		return r;
+	}
+
+	inline size_t MatrixDomain<GF2>::rankin (PackedGF2Matrix &A) const
+	{
+		std::vector<size_t> pivots;
+		return echelonize(A, pivots, false);
+	}
+
+	inline size_t MatrixDomain<GF2>::rank (const PackedGF2Matrix &A) const
+	{
+		PackedGF2Matrix B(A);
+		return rankin(B);
+	}
+
+	inline size_t MatrixDomain<GF2>::nullspaceBasisIn (PackedGF2Matrix &N, PackedGF2Matrix &A) const
+	{
+		const size_t n = A.coldim();
+		std::vector<size_t> pivots;
+		const size_t r = echelonize(A, pivots, true);
+
+		std::vector<bool> isPivot(n, false);
+		for (size_t p = 0 ; p < r ; ++p)
+			isPivot[pivots[p]] = true;
+		std::vector<size_t> freeCols;
+		for (size_t j = 0 ; j < n ; ++j)
+			if (!isPivot[j])
+				freeCols.push_back(j);
+
+		// x_f = 1 and x_{pivots[p]} = A(p,f) for each free column f
+		N.resize(n, n-r);
+		for (size_t t = 0 ; t < freeCols.size() ; ++t) {
+			N.setEntry(freeCols[t], t, true);
+			for (size_t p = 0 ; p < r ; ++p)
+				if (A.getEntry(p, freeCols[t]))
+					N.setEntry(pivots[p], t, true);
+		}
+		return n-r;
+	}
+
+	inline PackedGF2Matrix &MatrixDomain<GF2>::transpose (PackedGF2Matrix &T, const PackedGF2Matrix &A) const
+	{
+		T.resize(A.coldim(), A.rowdim());
+		for (size_t i = 0 ; i < A.rowdim() ; ++i)
+			for (size_t j = 0 ; j < A.coldim() ; ++j)
+				if (A.getEntry(i,j))
+					T.setEntry(j,i,true);
+		return T;
+	}
+
+}
+
+#endif // __LINBOX_matrixdomain_matrix_domain_m4ri_INL
+
+// vim:sts=8:sw=8:ts=8:noet:sr:cino=>s,f0,{0,g0,(0,:0,t0,+0,=s
+// Local Variables:
+// mode: C++
+// tab-width: 8
+// indent-tabs-mode: nil
+// c-basic-offset: 8
+// End:
@@ -180,10 +180,10 @@ namespace LinBox{
 			}
 		}
 
-		// copy elt from M[beg..end], _size must be >= end-beg+1
+		// copy elt from M[beg..end] to [start..], _size must be >= start+end-beg+1
 		// M is stored as a Polynomial of Matrices
 		template <size_t storage>
-		void copy(const PolynomialMatrix<PMType::matfirst,storage,Field>& M, size_t beg, size_t end){
+		void copy(const PolynomialMatrix<PMType::matfirst,storage,Field>& M, size_t beg, size_t end, size_t start=0){
 			//std::cout<<"copying.....matfirst to polfirst.....same field"<<std::endl;
 			const size_t ls = COPY_BLOCKSIZE;
 			for (size_t i = beg; i <= end; i+=ls)
@@ -191,13 +191,13 @@ namespace LinBox{
 					// Rk: the two loop must be interchanged in some cases
 					for (size_t _i = i; _i < std::min(end+1, i + ls); _i++)
 						for (size_t _j = j; _j < std::min(_col * _row, j + ls);++_j)
-							ref(_j,_i-beg)= M.get(_j,_i);
+							ref(_j,start+_i-beg)= M.get(_j,_i);
 		}
 
-		// copy elt from M[beg..end], _size must be >= end-beg+1
+		// copy elt from M[beg..end] to [start..], _size must be >= start+end-beg+1
 		// M is stored as a Polynomial of Matrices with a different field
 		template<size_t storage, typename OtherField>
-		void copy(const PolynomialMatrix<PMType::matfirst,storage,OtherField> & M, size_t beg, size_t end){
+		void copy(const PolynomialMatrix<PMType::matfirst,storage,OtherField> & M, size_t beg, size_t end, size_t start=0){
 			//std::cout<<"copying.....matfirst to polfirst.....other field"<<std::endl;
 			const size_t ls = COPY_BLOCKSIZE;
 			Hom<OtherField,Field> hom(M.field(),field()) ;
@@ -205,7 +205,7 @@ namespace LinBox{
 				for (size_t j = 0; j < _col * _row; j+=ls)
 					for (size_t _i = i; _i < std::min(end+1, i + ls); _i++) {
 						for (size_t _j = j; _j < std::min(_col * _row, j + ls);++_j)
-							hom.image(ref(_j,_i-beg),M.get(_j,_i) );
+							hom.image(ref(_j,start+_i-beg),M.get(_j,_i) );
 					}
 		}
 
@@ -0,0 +1,516 @@
+/* linbox/matrix/sparsematrix/sparse-binary.h
+ * Copyright (C) the LinBox group
+ *
+ * ========LICENCE========
+ * This file is part of the library LinBox.
+ *
+ * LinBox is free software: you can redistribute it and/or modify
+ * it under the terms of the  GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ * ========LICENCE========
+ *.
+ */
+
+/*! @file matrix/sparsematrix/sparse-binary.h
+ * @ingroup sparsematrix
+ * @brief Binary file format of the sparse matrices.
+ *
+ * A file is a SparseBinaryHeader followed by the arrays of the matrix,
+ * in the byte order of the machine that wrote it:
+ *  - CSR layout: row pointers (rowdim+1), column ids (nnz), values (nnz);
+ *  - COO layout: row ids (nnz), column ids (nnz), values (nnz).
+ *
+ * Indices are stored on 64 bits and values as the elements of the field,
+ * so that the arrays can be used in place once the file is mapped.
+ * Every array starts on a multiple of 8 bytes.
+ */
+
+#ifndef __LINBOX_sparse_matrix_sparse_binary_H
+#define __LINBOX_sparse_matrix_sparse_binary_H
+
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <ostream>
+#include <fstream>
+#include <type_traits>
+#include <vector>
+#include <algorithm>
+
+#include "linbox/util/error.h"
+#include "linbox/util/field-axpy.h"
+#include "linbox/util/mapped-file.h"
+#include "linbox/util/thread-pool.h"
+#include "linbox/matrix/sparse-matrix.h"
+
+//! Current version of the binary sparse format.
+#define __LINBOX_SPARSE_BINARY_VERSION__ 1
+
+namespace LinBox
+{
+
+	/** Header of a binary sparse matrix file (96 bytes).
+	 \ingroup sparsematrix
+	 */
+	struct SparseBinaryHeader {
+		enum Layout { CSR = 0, COO = 1 };
+		enum Kind { SIGNED = 0, UNSIGNED = 1, FLOATING = 2 };
+
+		char     magic[8];     //!< "LBXSPMAT"
+		uint32_t version;      //!< __LINBOX_SPARSE_BINARY_VERSION__
+		uint32_t layout;       //!< CSR or COO
+		uint32_t byteOrder;    //!< 0x01020304 as written
+		uint32_t indexWidth;   //!< bytes of an index, 8
+		uint32_t elementWidth; //!< bytes of a value
+		uint32_t elementKind;  //!< SIGNED, UNSIGNED or FLOATING
+		uint64_t modulus;      //!< characteristic of the field
+		uint64_t rowdim;
+		uint64_t coldim;
+		uint64_t nnz;
+		uint64_t reserved[4];
+
+		SparseBinaryHeader () { std::memset(this, 0, sizeof(SparseBinaryHeader)); }
+
+		template <class Field>
+		SparseBinaryHeader (const Field &F, Layout l, size_t m, size_t n, size_t z)
+		{
+			typedef typename Field::Element Element;
+			std::memset(this, 0, sizeof(SparseBinaryHeader));
+			std::memcpy(magic, "LBXSPMAT", 8);
+			version      = __LINBOX_SPARSE_BINARY_VERSION__;
+			layout       = (uint32_t)l;
+			byteOrder    = 0x01020304u;
+			indexWidth   = (uint32_t)sizeof(int64_t);
+			elementWidth = (uint32_t)sizeof(Element);
+			elementKind  = kind<Element>();
+			modulus      = (uint64_t)F.characteristic();
+			rowdim       = m;
+			coldim       = n;
+			nnz          = z;
+		}
+
+		/// NULL if a matrix over \p F can be read from this header, the reason otherwise.
+		template <class Field>
+		const char *check (const Field &F) const
+		{
+			typedef typename Field::Element Element;
+			if (std::memcmp(magic, "LBXSPMAT", 8) != 0)
+				return "LinBox ERROR: not a binary sparse matrix file";
+			if (version != __LINBOX_SPARSE_BINARY_VERSION__)
+				return "LinBox ERROR: unsupported version of the binary sparse format";
+			if (byteOrder != 0x01020304u)
+				return "LinBox ERROR: binary sparse matrix written with another byte order";
+			if (layout != CSR && layout != COO)
+				return "LinBox ERROR: unknown layout in binary sparse matrix file";
+			if (indexWidth != sizeof(int64_t))
+				return "LinBox ERROR: bad index width in binary sparse matrix file";
+			if (elementWidth != sizeof(Element) || elementKind != kind<Element>())
+				return "LinBox ERROR: binary sparse matrix elements do not match the field";
+			if (modulus != (uint64_t)F.characteristic())
+				return "LinBox ERROR: binary sparse matrix written over another field";
+			return NULL;
+		}
+
+		/// Size of the file described.
+		uint64_t fileSize () const
+		{
+			const uint64_t idx = (layout == CSR) ? rowdim + 1 + nnz : 2 * nnz;
+			return sizeof(SparseBinaryHeader) + idx * indexWidth + nnz * elementWidth;
+		}
+
+		template <class Element>
+		static uint32_t kind ()
+		{
+			return std::numeric_limits<Element>::is_integer
+			? (std::numeric_limits<Element>::is_signed ? SIGNED : UNSIGNED)
+			: FLOATING;
+		}
+	};
+
+	/// Buffered writer of an array of the binary sparse format.
+	template <class T>
+	class SparseBinaryBlock {
+	public:
+		SparseBinaryBlock (std::ostream &os) : _os(os) { _buf.reserve(size_t(1) << 13); }
+		~SparseBinaryBlock () { flush(); }
+
+		void push (const T &x)
+		{
+			_buf.push_back(x);
+			if (_buf.size() == _buf.capacity())
+				flush();
+		}
+
+		void flush ()
+		{
+			if (_buf.size())
+				_os.write((const char *)_buf.data(), (std::streamsize)(_buf.size() * sizeof(T)));
+			_buf.resize(0);
+		}
+
+	private:
+		std::ostream  &_os;
+		std::vector<T> _buf;
+	};
+
+	/** @name Streaming writers of the binary sparse format.
+	 * The arrays are written in order from the matrix, with a buffer of
+	 * a few kB: no copy of the matrix is made.
+	 * The rows of CSR and sequence matrices are written as they are:
+	 * they are expected sorted by column.
+	 */
+	//@{
+	template <class Field>
+	std::ostream &writeSparseBinary (std::ostream &os, const SparseMatrix<Field, SparseMatrixFormat::CSR> &A)
+	{
+		typedef typename Field::Element Element;
+		static_assert(std::is_trivially_copyable<Element>::value, "binary sparse format needs plain elements");
+		const size_t m = A.rowdim(), nnz = A.size();
+		SparseBinaryHeader h(A.field(), SparseBinaryHeader::CSR, m, A.coldim(), nnz);
+		os.write((const char *)&h, sizeof(h));
+		{
+			SparseBinaryBlock<int64_t> start(os);
+			start.push(0);
+			for (size_t i = 0 ; i < m ; ++i)
+				start.push((int64_t)A.getEnd(i));
+		}
+		{
+			SparseBinaryBlock<int64_t> colid(os);
+			for (size_t k = 0 ; k < nnz ; ++k)
+				colid.push((int64_t)A.getColid(k));
+		}
+		SparseBinaryBlock<Element> data(os);
+		for (size_t k = 0 ; k < nnz ; ++k)
+			data.push(A.getData(k));
+		data.flush();
+		return os;
+	}
+
+	template <class Field>
+	std::ostream &writeSparseBinary (std::ostream &os, const SparseMatrix<Field, SparseMatrixFormat::COO> &A)
+	{
+		typedef typename Field::Element Element;
+		static_assert(std::is_trivially_copyable<Element>::value, "binary sparse format needs plain elements");
+		const size_t nnz = A.size();
+		SparseBinaryHeader h(A.field(), SparseBinaryHeader::COO, A.rowdim(), A.coldim(), nnz);
+		os.write((const char *)&h, sizeof(h));
+		{
+			SparseBinaryBlock<int64_t> rowid(os);
+			for (size_t k = 0 ; k < nnz ; ++k)
+				rowid.push((int64_t)A.getRowid(k));
+		}
+		{
+			SparseBinaryBlock<int64_t> colid(os);
+			for (size_t k = 0 ; k < nnz ; ++k)
+				colid.push((int64_t)A.getColid(k));
+		}
+		SparseBinaryBlock<Element> data(os);
+		for (size_t k = 0 ; k < nnz ; ++k)
+			data.push(A.getData(k));
+		data.flush();
+		return os;
+	}
+
+	/// Sequence matrices are written in the CSR layout.
+	template <class Field>
+	std::ostream &writeSparseBinary (std::ostream &os, const SparseMatrix<Field, SparseMatrixFormat::SparseSeq> &A)
+	{
+		typedef typename Field::Element Element;
+		static_assert(std::is_trivially_copyable<Element>::value, "binary sparse format needs plain elements");
+		const size_t m = A.rowdim();
+		size_t nnz = 0;
+		for (size_t i = 0 ; i < m ; ++i)
+			nnz += A[i].size();
+		SparseBinaryHeader h(A.field(), SparseBinaryHeader::CSR, m, A.coldim(), nnz);
+		os.write((const char *)&h, sizeof(h));
+		{
+			SparseBinaryBlock<int64_t> start(os);
+			int64_t s = 0;
+			start.push(s);
+			for (size_t i = 0 ; i < m ; ++i)
+				start.push(s += (int64_t)A[i].size());
+		}
+		{
+			SparseBinaryBlock<int64_t> colid(os);
+			for (size_t i = 0 ; i < m ; ++i)
+				for (size_t k = 0 ; k < A[i].size() ; ++k)
+					colid.push((int64_t)A[i][k].first);
+		}
+		SparseBinaryBlock<Element> data(os);
+		for (size_t i = 0 ; i < m ; ++i)
+			for (size_t k = 0 ; k < A[i].size() ; ++k)
+				data.push(A[i][k].second);
+		data.flush();
+		return os;
+	}
+
+	/// Writes \p A to the file \p filename, throws LinboxError on failure.
+	template <class Matrix>
+	void writeSparseBinary (const char *filename, const Matrix &A)
+	{
+		std::ofstream out(filename, std::ios::binary);
+		if (! out || ! writeSparseBinary(out, A))
+			throw LinboxError("LinBox ERROR: cannot write the binary sparse matrix file");
+	}
+	//@}
+
+	/** Read only sparse matrix on a mapped binary file.
+	 *
+	 * With the CSR layout, the row pointers, column ids and values are
+	 * the pages of the file: opening the matrix costs no read nor copy,
+	 * the entries are loaded by the system when they are first used.
+	 * With the COO layout, the row pointers are computed; the columns
+	 * and values are used in place if the entries are sorted by rows and
+	 * columns, copied and sorted otherwise.
+	 * Only the row pointers are checked, the column ids are trusted.
+	 *
+	 * It is a blackbox (apply, applyTranspose) with the accessors of the
+	 * CSR matrices, and can be exported to a CSR SparseMatrix.
+	 \ingroup sparsematrix
+	 */
+	template <class _Field>
+	class MappedCSRMatrix {
+	public:
+		typedef _Field                    Field;
+		typedef typename Field::Element   Element;
+		typedef ptrdiff_t                 index_t;
+		typedef std::vector<index_t>      svector_t;
+		typedef SparseMatrix<Field, SparseMatrixFormat::CSR> CSRMatrix;
+
+		/** Maps \p filename.
+		 * @throws LinboxError if the file cannot be read, is truncated,
+		 * or does not hold a matrix over \p F.
+		 */
+		MappedCSRMatrix (const Field &F, const char *filename) :
+			_field(&F), _m(0), _n(0), _nnz(0), _start(NULL), _colid(NULL), _data(NULL), _inPlace(false)
+		{
+			if (! _file.open(filename) || _file.size() < sizeof(SparseBinaryHeader))
+				throw LinboxError("LinBox ERROR: cannot read the binary sparse matrix file");
+			SparseBinaryHeader h;
+			std::memcpy(&h, _file.data(), sizeof(h));
+			const char *err = h.check(F);
+			if (err)
+				throw LinboxError(err);
+			if (_file.size() < h.fileSize())
+				throw LinboxError("LinBox ERROR: truncated binary sparse matrix file");
+			_m   = (size_t)h.rowdim;
+			_n   = (size_t)h.coldim;
+			_nnz = (size_t)h.nnz;
+
+			const int64_t *p = (const int64_t *)(_file.data() + sizeof(h));
+			if (h.layout == SparseBinaryHeader::CSR)
+				mapCSR(p, p + _m + 1, (const Element *)(p + _m + 1 + _nnz));
+			else
+				mapCOO(p, p + _nnz, (const Element *)(p + 2 * _nnz));
+		}
+
+		size_t rowdim () const { return _m; }
+		size_t coldim () const { return _n; }
+		size_t size () const { return _nnz; }
+		const Field &field () const { return *_field; }
+
+		/// true if the columns and values are the pages of the file.
+		bool isMapped () const { return _inPlace && _file.isMapped(); }
+
+		index_t getStart (const size_t &i) const { return _start[i]; }
+		index_t getEnd (const size_t &i) const { return _start[i+1]; }
+		size_t getColid (const size_t &k) const { return (size_t)_colid[k]; }
+		const Element &getData (const size_t &k) const { return _data[k]; }
+
+		const Element &getEntry (const size_t &i, const size_t &j) const
+		{
+			linbox_check(i < _m);
+			const index_t *beg = _colid + _start[i], *end = _colid + _start[i+1];
+			const index_t *low = std::lower_bound(beg, end, (index_t)j);
+			if (low == end || *low != (index_t)j)
+				return field().zero;
+			return _data[low - _colid];
+		}
+
+		Element &getEntry (Element &x, size_t i, size_t j) const
+		{
+			return field().assign(x, getEntry(i, j));
+		}
+
+		/// y = Ax, in parallel on blocks of rows with the same number of entries.
+		template <class OutVector, class InVector>
+		OutVector &apply (OutVector &y, const InVector &x) const
+		{
+			const size_t nt = threadPool().size();
+			if (nt < 2 || _nnz < LINBOX_CSR_PARALLEL || _m < nt) {
+				applyRows(y, x, 0, _m);
+				return y;
+			}
+			svector_t part(nt+1);
+			part[0] = 0;
+			for (size_t t = 1 ; t < nt ; ++t) {
+				const index_t target = (index_t)((_nnz * t) / nt);
+				part[t] = std::lower_bound(_start + part[t-1], _start + _m, target) - _start;
+			}
+			part[nt] = (index_t)_m;
+			threadPool().parallelFor(0, nt, [&](size_t t) {
+				applyRows(y, x, (size_t)part[t], (size_t)part[t+1]);
+			});
+			return y;
+		}
+
+		/// y = A^T x
+		template <class OutVector, class InVector>
+		OutVector &applyTranspose (OutVector &y, const InVector &x) const
+		{
+			for (size_t j = 0 ; j < _n ; ++j)
+				field().assign(y[j], field().zero);
+			for (size_t i = 0 ; i < _m ; ++i)
+				for (index_t k = _start[i] ; k < _start[i+1] ; ++k)
+					field().axpyin(y[(size_t)_colid[k]], _data[k], x[i]);
+			return y;
+		}
+
+		/// Copy in a CSR matrix.
+		CSRMatrix &exporte (CSRMatrix &S) const
+		{
+			S.resize(_m, _n, _nnz);
+			S.setStart(svector_t(_start, _start + _m + 1));
+			S.setColid(svector_t(_colid, _colid + _nnz));
+			S.setData(std::vector<Element>(_data, _data + _nnz));
+			S.finalize();
+			return S;
+		}
+
+	private:
+		MappedCSRMatrix (const MappedCSRMatrix &);
+		MappedCSRMatrix &operator= (const MappedCSRMatrix &);
+
+		void mapCSR (const int64_t *start, const int64_t *colid, const Element *data)
+		{
+			if (start[0] != 0 || start[_m] != (int64_t)_nnz)
+				throw LinboxError("LinBox ERROR: bad row pointers in binary sparse matrix file");
+			for (size_t i = 0 ; i < _m ; ++i)
+				if (start[i] > start[i+1])
+					throw LinboxError("LinBox ERROR: bad row pointers in binary sparse matrix file");
+			_data = data;
+			if (std::is_same<index_t, int64_t>::value) {
+				_start   = (const index_t *)start;
+				_colid   = (const index_t *)colid;
+				_inPlace = true;
+				return;
+			}
+			_ownStart.assign(start, start + _m + 1);
+			_ownColid.assign(colid, colid + _nnz);
+			_start = _ownStart.data();
+			_colid = _ownColid.data();
+		}
+
+		void mapCOO (const int64_t *rowid, const int64_t *colid, const Element *data)
+		{
+			_ownStart.assign(_m + 1, 0);
+			bool sorted = true;
+			for (size_t k = 0 ; k < _nnz ; ++k) {
+				if (rowid[k] < 0 || rowid[k] >= (int64_t)_m)
+					throw LinboxError("LinBox ERROR: bad row id in binary sparse matrix file");
+				++_ownStart[(size_t)rowid[k]+1];
+				sorted = sorted && (k == 0 || rowid[k-1] < rowid[k]
+						    || (rowid[k-1] == rowid[k] && colid[k-1] < colid[k]));
+			}
+			for (size_t i = 0 ; i < _m ; ++i)
+				_ownStart[i+1] += _ownStart[i];
+			_start = _ownStart.data();
+
+			if (sorted && std::is_same<index_t, int64_t>::value) {
+				_colid   = (const index_t *)colid;
+				_data    = data;
+				_inPlace = true;
+				return;
+			}
+			// placement in row order, then each row sorted by column
+			svector_t pos(_ownStart.begin(), _ownStart.end() - 1);
+			std::vector<std::pair<index_t, Element> > entries(_nnz);
+			for (size_t k = 0 ; k < _nnz ; ++k)
+				entries[(size_t)pos[(size_t)rowid[k]]++] = std::pair<index_t, Element>((index_t)colid[k], data[k]);
+			_ownColid.resize(_nnz);
+			_ownData.resize(_nnz);
+			for (size_t i = 0 ; i < _m ; ++i) {
+				std::sort(entries.begin() + _ownStart[i], entries.begin() + _ownStart[i+1],
+					  [](const std::pair<index_t, Element> &a, const std::pair<index_t, Element> &b) {
+						  return a.first < b.first;
+					  });
+				for (index_t k = _ownStart[i] ; k < _ownStart[i+1] ; ++k) {
+					_ownColid[(size_t)k] = entries[(size_t)k].first;
+					_ownData[(size_t)k]  = entries[(size_t)k].second;
+				}
+			}
+			_colid = _ownColid.data();
+			_data  = _ownData.data();
+		}
+
+		template <class OutVector, class InVector>
+		void applyRows (OutVector &y, const InVector &x, const size_t ibeg, const size_t iend) const
+		{
+			applyRows(y, x, ibeg, iend, typename SpMV::Kernel<Field>::Available());
+		}
+
+		template <class OutVector, class InVector>
+		void applyRows (OutVector &y, const InVector &x, const size_t ibeg, const size_t iend, std::true_type) const
+		{
+			const Element *xp = SpMV::densePointer<Element>(x);
+			if (xp == NULL)
+				return applyRows(y, x, ibeg, iend, std::false_type());
+			SpMV::Kernel<Field> K(field());
+			for (size_t i = ibeg ; i < iend ; ++i)
+				K.dot(y[i], _data + _start[i], _colid + _start[i], (size_t)(_start[i+1] - _start[i]), xp);
+		}
+
+		template <class OutVector, class InVector>
+		void applyRows (OutVector &y, const InVector &x, const size_t ibeg, const size_t iend, std::false_type) const
+		{
+			FieldAXPY<Field> accu(field());
+			for (size_t i = ibeg ; i < iend ; ++i) {
+				accu.reset();
+				for (index_t k = _start[i] ; k < _start[i+1] ; ++k)
+					accu.mulacc(_data[k], x[(size_t)_colid[k]]);
+				accu.get(y[i]);
+			}
+		}
+
+		const Field          *_field;
+		MappedFile            _file;
+		size_t                _m, _n, _nnz;
+		const index_t        *_start, *_colid;
+		const Element        *_data;
+		svector_t             _ownStart, _ownColid;
+		std::vector<Element>  _ownData;
+		bool                  _inPlace;
+	};
+
+	/** Reads a binary sparse matrix file into \p A (a copy of the file).
+	 * @throws LinboxError as MappedCSRMatrix.
+	 */
+	template <class Field>
+	SparseMatrix<Field, SparseMatrixFormat::CSR> &
+	readSparseBinary (SparseMatrix<Field, SparseMatrixFormat::CSR> &A, const char *filename)
+	{
+		MappedCSRMatrix<Field> M(A.field(), filename);
+		return M.exporte(A);
+	}
+
+} // namespace LinBox
+
+#endif // __LINBOX_sparse_matrix_sparse_binary_H
+
+// vim:sts=8:sw=8:ts=8:noet:sr:cino=>s,f0,{0,g0,(0,:0,t0,+0,=s
+// Local Variables:
+// mode: C++
+// tab-width: 8
+// indent-tabs-mode: nil
+// c-basic-offset: 8
+// End:
@@ -40,6 +40,7 @@
 #include "linbox/util/debug.h"
 #include "linbox/field/hom.h"
 #include "sparse-domain.h"
+#include "sparse-simd-kernels.h"
 
 #ifndef LINBOX_COO_TRANSPOSE
 #define LINBOX_COO_TRANSPOSE 1000
@@ -798,6 +799,45 @@ namespace LinBox
 			return applyTranspose(y,x,field().zero);
 		}
 
+		/*! Y <- AX for a block X of vectors (SpMM).
+		 * Each run of consecutive triples of a row is read once for all
+		 * the columns of the dense row major X and added to its row of Y,
+		 * so the triples need not be sorted by rows.
+		 */
+		template<class Mat1, class Mat2>
+		Mat1 & applyLeft(Mat1 &Y, const Mat2 &X) const
+		{
+			linbox_check(X.rowdim() == coldim());
+			linbox_check(Y.rowdim() == rowdim());
+			linbox_check(Y.coldim() == X.coldim());
+
+			const size_t k = X.coldim();
+			const Element * xp = X.getPointer();
+			Element * yp = Y.getPointer();
+			const size_t ldx = X.getStride();
+			const size_t ldy = Y.getStride();
+
+			for (size_t i = 0 ; i < _rownb ; ++i)
+				for (size_t j = 0 ; j < k ; ++j)
+					field().assign(yp[i*ldy+j],field().zero);
+
+			SpMV::BlockAccumulator<Field> accu(field(),k);
+			std::vector<Element> Yi(k);
+			size_t z = 0 ;
+			while (z < _nbnz) {
+				const size_t i = _rowid[z] ;
+				accu.reset();
+				for ( ; z < _nbnz && _rowid[z] == i ; ++z)
+					accu.mulacc(_data[z], xp+_colid[z]*ldx);
+				accu.get(Yi.data());
+				Element * yi = yp+i*ldy ;
+				for (size_t j = 0 ; j < k ; ++j)
+					field().addin(yi[j],Yi[j]);
+			}
+
+			return Y;
+		}
+
 		const Field & field()  const
 		{
 			return _field ;
@@ -40,12 +40,25 @@
 #include "linbox/util/debug.h"
 #include "linbox/field/hom.h"
 #include "sparse-domain.h"
+#include "sparse-simd-kernels.h"
 #include "givaro/zring.h"
 
+#include "linbox/util/thread-pool.h"
+
 #ifndef LINBOX_CSR_TRANSPOSE
 #define LINBOX_CSR_TRANSPOSE 1000
 #endif
 
+//! below this number of non zero entries, apply stays sequential.
+#ifndef LINBOX_CSR_PARALLEL
+#define LINBOX_CSR_PARALLEL 10000
+#endif
+
+//! default number of threads used by apply (0 means the whole thread pool).
+#ifndef LINBOX_CSR_THREADS
+#define LINBOX_CSR_THREADS 1
+#endif
+
 namespace LinBox {
 #if 0
 	template<class _Field>
@@ -129,6 +142,7 @@ namespace LinBox {
 			,_start(1,0),_colid(0),_data(0)
 			, _field()
 			, _helper()
+			, _threads(LINBOX_CSR_THREADS)
 		{
 			_start[0] = 0 ;
 		}
@@ -142,6 +156,7 @@ namespace LinBox {
 			,_data(0)
 			, _field(F)
 			, _helper()
+			, _threads(LINBOX_CSR_THREADS)
 		{
 			_start[0] = 0 ;
 		}
@@ -154,6 +169,7 @@ namespace LinBox {
 			,_data(0)
 			, _field(F)
 			, _helper()
+			, _threads(LINBOX_CSR_THREADS)
 		{
 			_start[0] = 0 ;
 		}
@@ -168,6 +184,7 @@ namespace LinBox {
 			,_data(z)
 			, _field(F)
 			, _helper()
+			, _threads(LINBOX_CSR_THREADS)
 		{
 			_start[0] = 0 ;
 		}
@@ -180,6 +197,7 @@ namespace LinBox {
 			,_data(S._data)
 			, _field(S._field)
 			, _helper()
+			, _threads(S._threads)
 		{
 		}
 
@@ -276,6 +294,7 @@ namespace LinBox {
 			, _colid(S.size())
 			,_data(S.size())
 			, _field(F)
+			, _threads(LINBOX_CSR_THREADS)
 		{
 			typename SparseMatrix<_Tp1,_Rw1>::template rebind<Field,Storage>()(*this, S);
 			finalize();
@@ -302,6 +321,7 @@ namespace LinBox {
 			, _colid(0)
 			,_data(0)
 			, _field(F)
+			, _threads(LINBOX_CSR_THREADS)
 		{
 			{
 				_start[0] = 0 ;
@@ -331,6 +351,7 @@ namespace LinBox {
 			,_colid(0)
 			,_data(0)
 			,_field(ms.field())
+			, _threads(LINBOX_CSR_THREADS)
 		{
 			firstTriple();
 
@@ -374,6 +395,7 @@ namespace LinBox {
 			_colid.resize(nn);
 			_data.resize(nn);
 			_nbnz = nn ;
+			_helper.reset();
 		}
 
 		void resize(const size_t & mm, const size_t & nn, const size_t & zz = 0)
@@ -393,6 +415,7 @@ namespace LinBox {
 			_rownb(S.rowdim()),_colnb(S.coldim()),
 			_start(S.rowdim()+1,0),_colid(S.size()),_data(S.size()),
 			_field(S.field())
+			, _threads(LINBOX_CSR_THREADS)
 		{
 			this->importe(S); // convert Temp from anything
 			finalize();
@@ -641,6 +664,7 @@ namespace LinBox {
 				linbox_check(_start[rowdim()] == _nbnz);
 			}
 			_triples.reset();
+			_helper.reset();
 
 		} // end construction after a sequence of setEntry calls.
 
@@ -666,6 +690,7 @@ namespace LinBox {
 			}
 
 			// nothing has been done yet
+			_helper.reset();
 			typedef typename svector_t::iterator myIterator ;
 			index_t ibeg = _start[i];
 			index_t iend = _start[i+1];
@@ -787,6 +812,7 @@ namespace LinBox {
 				return ;
 			else {
 				// not sure
+				_helper.reset();
 				size_t la = (size_t)(low-_colid.begin()) ;
 				for (size_t k = i+1 ; k <= _rownb ; ++k)
 					_start[k] -= 1 ;
@@ -802,6 +828,7 @@ namespace LinBox {
 		 */
 		void clean()
 		{
+			_helper.reset();
 			size_t i = 0 ;
 			while ( i < _data.size() ) {
 				if ( field().isZero(_data[i]) ) {
@@ -825,17 +852,21 @@ namespace LinBox {
 			// linbox_check(consistent());
 			prepare(field(),y,a);
 
-
-			// std::cout << "apply" << std::endl;
-			FieldAXPY<Field> accu(field());
-			for (size_t i = 0 ; i < _rownb ; ++i) {
-				accu.reset();
-				for (index_t k = _start[i] ; k < _start[i+1] ; ++k)
-					// field().axpyin( y[i], _data[k], x[_colid[k]] ); //! @todo delay !!!
-					accu.mulacc(_data[k],x[_colid[k]]);
-				accu.get(y[i]);
+			size_t nt = threads();
+			if (nt < 2 || _nbnz < LINBOX_CSR_PARALLEL || _rownb < nt) {
+				applyRows(y,x,0,_rownb);
+				return y;
 			}
 
+			// each thread gets a contiguous block of rows with about
+			// _nbnz/nt entries. Rows are never split, so the result
+			// does not depend on the number of threads.
+			svector_t part ;
+			partition(part,_start,_rownb,nt);
+			threadPool().parallelFor(0,nt,[&](size_t t) {
+				applyRows(y,x,(size_t)part[t],(size_t)part[t+1]);
+			});
+
 			return y;
 		}
 
@@ -846,11 +877,24 @@ namespace LinBox {
 		outVector& applyTranspose(outVector &y, const inVector& x, const Element & a) const
 		{
 			linbox_check(consistent());
+			prepare(field(),y,a);
+
 			if (_helper.optimized(*this)) {
-				return _helper.matrix().apply(y,x,a) ; // NEVER use applyTranspose on that thing.
-			}
+				// gather through the cached CSC index, one column per output entry.
+				size_t nt = threads();
+				if (nt < 2 || _nbnz < LINBOX_CSR_PARALLEL || _colnb < nt) {
+					applyTransposeCols(y,x,0,_colnb);
+					return y;
+				}
 
-			prepare(field(),y,a);
+				svector_t part ;
+				partition(part,_helper.start(),_colnb,nt);
+				threadPool().parallelFor(0,nt,[&](size_t t) {
+					applyTransposeCols(y,x,(size_t)part[t],(size_t)part[t+1]);
+				});
+
+				return y;
+			}
 
 			const FieldAXPY<Field> accu0(field());
 			std::vector<FieldAXPY<Field> > Y(_colnb, accu0);
@@ -874,6 +918,39 @@ namespace LinBox {
 			return apply(y,x,field().zero);
 		}
 
+		/*! Y <- AX for a block X of vectors (SpMM).
+		 * Each row of A is read once for all the columns of X.
+		 * X and Y are dense row major matrices (\c BlasMatrix or
+		 * \c BlasSubmatrix) ; rows are split across threads like in apply.
+		 */
+		template<class Mat1, class Mat2>
+		Mat1 & applyLeft(Mat1 &Y, const Mat2 &X) const
+		{
+			linbox_check(X.rowdim() == coldim());
+			linbox_check(Y.rowdim() == rowdim());
+			linbox_check(Y.coldim() == X.coldim());
+
+			const size_t k = X.coldim();
+			const Element * xp = X.getPointer();
+			Element * yp = Y.getPointer();
+			const size_t ldx = X.getStride();
+			const size_t ldy = Y.getStride();
+
+			size_t nt = threads();
+			if (nt < 2 || _nbnz*k < LINBOX_CSR_PARALLEL || _rownb < nt) {
+				applyLeftRows(yp,ldy,xp,ldx,k,0,_rownb);
+				return Y;
+			}
+
+			svector_t part ;
+			partition(part,_start,_rownb,nt);
+			threadPool().parallelFor(0,nt,[&](size_t t) {
+				applyLeftRows(yp,ldy,xp,ldx,k,(size_t)part[t],(size_t)part[t+1]);
+			});
+
+			return Y;
+		}
+
 		template<class inVector, class outVector>
 		outVector& applyTranspose(outVector &y, const inVector& x ) const
 		{
@@ -891,6 +968,36 @@ namespace LinBox {
 			return true ;
 		}
 
+		/*! Builds the cached column index used by applyTranspose.
+		 * This is otherwise done on the first call to applyTranspose,
+		 * only when the matrix has more than \c LINBOX_CSR_TRANSPOSE
+		 * entries. The index is dropped when the structure of the
+		 * matrix changes (not when values are changed by setData).
+		 */
+		void optimizeTranspose() const
+		{
+			_helper.getHelp(*this,true);
+		}
+
+		/*! Number of threads used by apply and applyTranspose.
+		 * @param t 1 for the sequential product, 0 to use all the
+		 * threads of the library pool (see threadPool()).
+		 * The blocks of rows are tasks of the pool, so an apply called
+		 * from a task does not start more threads.
+		 */
+		void setThreads(const size_t & t)
+		{
+			_threads = t ;
+		}
+
+		//! Number of threads apply will actually use.
+		size_t threads() const
+		{
+			if (_threads == 0)
+				return threadPool().size();
+			return _threads ;
+		}
+
 		// Element magnitude() const ;
 
 		size_t maxrow() const
@@ -903,27 +1010,104 @@ namespace LinBox {
 
 	private :
 
+		//! y[i] = sum(A(i,j) x(j) for ibeg <= i < iend.
+		template<class inVector, class outVector>
+		void applyRows(outVector &y, const inVector& x, const size_t ibeg, const size_t iend) const
+		{
+			applyRows(y,x,ibeg,iend,typename SpMV::Kernel<Field>::Available());
+		}
+
+		// word size modular fields: delayed reduction and SIMD gathers.
+		template<class inVector, class outVector>
+		void applyRows(outVector &y, const inVector& x, const size_t ibeg, const size_t iend, std::true_type) const
+		{
+			const Element * xp = SpMV::densePointer<Element>(x) ;
+			if (xp == NULL)
+				return applyRows(y,x,ibeg,iend,std::false_type());
+
+			SpMV::Kernel<Field> K(field());
+			for (size_t i = ibeg ; i < iend ; ++i)
+				K.dot(y[i], _data.data()+_start[i], _colid.data()+_start[i], (size_t)(_start[i+1]-_start[i]), xp);
+		}
+
+		template<class inVector, class outVector>
+		void applyRows(outVector &y, const inVector& x, const size_t ibeg, const size_t iend, std::false_type) const
+		{
+			FieldAXPY<Field> accu(field());
+			for (size_t i = ibeg ; i < iend ; ++i) {
+				accu.reset();
+				for (index_t k = _start[i] ; k < _start[i+1] ; ++k)
+					accu.mulacc(_data[k],x[_colid[k]]);
+				accu.get(y[i]);
+			}
+		}
+
+		//! rows ibeg <= i < iend of Y = AX, X and Y row major.
+		void applyLeftRows(Element * yp, const size_t ldy, const Element * xp, const size_t ldx,
+				   const size_t k, const size_t ibeg, const size_t iend) const
+		{
+			SpMV::BlockAccumulator<Field> accu(field(),k);
+			for (size_t i = ibeg ; i < iend ; ++i) {
+				accu.reset();
+				for (index_t l = _start[i] ; l < _start[i+1] ; ++l)
+					accu.mulacc(_data[(size_t)l], xp+(size_t)_colid[(size_t)l]*ldx);
+				accu.get(yp+i*ldy);
+			}
+		}
+
+		//! y[j] = sum(A(i,j) x(i) for jbeg <= j < jend, using the CSC index.
+		template<class inVector, class outVector>
+		void applyTransposeCols(outVector &y, const inVector& x, const size_t jbeg, const size_t jend) const
+		{
+			const svector_t & tstart = _helper.start();
+			const svector_t & trowid = _helper.rowid();
+			const svector_t & tpos   = _helper.pos();
+			FieldAXPY<Field> accu(field());
+			for (size_t j = jbeg ; j < jend ; ++j) {
+				accu.reset();
+				for (index_t k = tstart[j] ; k < tstart[j+1] ; ++k)
+					accu.mulacc(_data[(size_t)tpos[(size_t)k]],x[trowid[(size_t)k]]);
+				accu.get(y[j]);
+			}
+		}
+
+		/*! Splits the \p n rows (or columns) of a compressed storage in
+		 * \p nt blocks with about the same number of non zero entries.
+		 * @param part [out] block \c t is <code>[part[t],part[t+1])</code>.
+		 * @param start row (or column) pointers, of size \p n+1.
+		 * @param n number of rows (or columns).
+		 * @param nt number of blocks.
+		 */
+		static void partition(svector_t & part, const svector_t & start, const size_t n, const size_t nt)
+		{
+			part.resize(nt+1);
+			part[0] = 0 ;
+			for (size_t t = 1 ; t < nt ; ++t) {
+				index_t target = (index_t)(((size_t)start[n] * t) / nt) ;
+				part[t] = (index_t)(std::lower_bound(start.begin()+part[t-1], start.begin()+(index_t)n, target) - start.begin()) ;
+			}
+			part[nt] = (index_t)n ;
+		}
+
+		/*! Cached CSC index of the matrix, for applyTranspose.
+		 * Column \c j has its entries in rows <code>rowid()[k]</code>
+		 * with value <code>_data[pos()[k]]</code>, for
+		 * <code>start()[j] <= k < start()[j+1]</code>.
+		 * Values are not copied, so setData does not invalidate it.
+		 */
 		class Helper {
 			bool _useable ;
 			bool _optimized ;
-			bool blackbox_usage ;
-			Self_t *_AT ;
+			svector_t _start ;
+			svector_t _rowid ;
+			svector_t _pos ;
 		public:
 
 			Helper() :
 				_useable(false)
 				,_optimized(false)
-				, blackbox_usage(true)
-				, _AT(NULL)
 			{}
 
-			~Helper()
-			{
-				if ( _AT ) {
-					delete _AT ;
-				}
-			}
-
 			bool optimized(const Self_t & A)
 			{
 				if (!_useable) {
@@ -933,22 +1117,47 @@ namespace LinBox {
 				return	_optimized;
 			}
 
-			void getHelp(const Self_t & A)
+			void getHelp(const Self_t & A, bool force = false)
 			{
-				if ( A.size() > LINBOX_CSR_TRANSPOSE ) { // and/or A.rowDensity(), A.coldim(),...
-					// std::cout << "optimizing..." ;
+				if ( force || A.size() > LINBOX_CSR_TRANSPOSE ) { // and/or A.rowDensity(), A.coldim(),...
+					_start.assign(A.coldim()+1,0);
+					_rowid.resize(A.size());
+					_pos.resize(A.size());
+
+					for (size_t k = 0 ; k < A.size() ; ++k)
+						_start[(size_t)A._colid[k]+1] += 1 ;
+					for (size_t j = 0 ; j < A.coldim() ; ++j)
+						_start[j+1] += _start[j] ;
+
+					svector_t next(_start.begin(),_start.end()-1);
+					for (size_t i = 0 ; i < A.rowdim() ; ++i)
+						for (index_t k = A._start[i] ; k < A._start[i+1] ; ++k) {
+							index_t & place = next[(size_t)A._colid[(size_t)k]] ;
+							_rowid[(size_t)place] = (index_t)i ;
+							_pos  [(size_t)place] = k ;
+							++place ;
+						}
 					_optimized = true ;
-					_AT = new Self_t(A.field(),A.coldim(),A.rowdim());
-					A.transpose(*_AT);
-					// std::cout << "done!" << std::endl;
 				}
+				_useable = true ;
 			}
 
-			const Self_t & matrix() const
+			//! forget the index, the structure of the matrix changed.
+			void reset()
 			{
-				return *_AT ;
+				if (_useable) {
+					_useable = false ;
+					_optimized = false ;
+					svector_t().swap(_start);
+					svector_t().swap(_rowid);
+					svector_t().swap(_pos);
+				}
 			}
 
+			const svector_t & start() const { return _start ; }
+			const svector_t & rowid() const { return _rowid ; }
+			const svector_t & pos()   const { return _pos ; }
+
 		};
 
 	public:
@@ -974,6 +1183,7 @@ namespace LinBox {
 		{
 			// linbox_check(_start.size() == new_start.size());
 			_start = new_start ;
+			_helper.reset();
 		}
 
 		svector_t  getStart( ) const
@@ -1013,6 +1223,7 @@ namespace LinBox {
 		void setColid(svector_t new_colid)
 		{
 			_colid = new_colid ;
+			_helper.reset();
 		}
 
 		svector_t  getColid( ) const
@@ -1444,6 +1655,8 @@ namespace LinBox {
 
 		mutable Helper _helper ;
 
+		size_t _threads ; //!< threads used by apply, 0 for all.
+
 		mutable struct _triples {
 			ptrdiff_t _row ;
 			ptrdiff_t _nnz ;
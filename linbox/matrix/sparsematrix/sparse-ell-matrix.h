@@ -40,6 +40,8 @@
 #include "linbox/util/debug.h"
 #include "linbox/field/hom.h"
 #include "sparse-domain.h"
+#include "sparse-simd-kernels.h"
+#include "linbox/util/thread-pool.h"
 
 #ifndef LINBOX_ELL_TRANSPOSE
 #define LINBOX_ELL_TRANSPOSE 1000
@@ -769,19 +771,7 @@ namespace LinBox
 			// linbox_check(consistent());
 			prepare(field(),y,a);
 
-
-			FieldAXPY<Field> accu(field());
-			for (size_t i = 0 ; i < _rownb ; ++i) {
-				accu.reset();
-				for (size_t k = 0   ; k < _maxc ; ++k)
-					if (!field().isZero(getData(i,k)))
-						// field().axpyin( y[i], getData(i,k), x[getColid(i,k)] ); //! @todo delay !!!
-						accu.mulacc( getData(i,k), x[getColid(i,k)] );
-					else {
-						break;
-					}
-				accu.get(y[i]);
-			}
+			applyRows(y,x,typename SpMV::Kernel<Field>::Available());
 
 			return y;
 		}
@@ -834,6 +824,42 @@ namespace LinBox
 			return apply(y,x,field().zero);
 		}
 
+		/*! Y <- AX for a block X of vectors (SpMM).
+		 * Each row of A is read once for all the columns of X.
+		 * X and Y are dense row major matrices (\c BlasMatrix or
+		 * \c BlasSubmatrix).
+		 */
+		template<class Mat1, class Mat2>
+		Mat1 & applyLeft(Mat1 &Y, const Mat2 &X) const
+		{
+			linbox_check(X.rowdim() == coldim());
+			linbox_check(Y.rowdim() == rowdim());
+			linbox_check(Y.coldim() == X.coldim());
+
+			const size_t k = X.coldim();
+			const Element * xp = X.getPointer();
+			Element * yp = Y.getPointer();
+			const size_t ldx = X.getStride();
+			const size_t ldy = Y.getStride();
+
+			// rows are split in even blocks, one task of the pool each.
+			const size_t nt = (_nbnz*k < LINBOX_SPMM_PARALLEL) ? 1 : threadPool().size();
+			threadPool().parallelFor(0,nt,[&](size_t t) {
+				SpMV::BlockAccumulator<Field> accu(field(),k);
+				for (size_t i = _rownb*t/nt ; i < _rownb*(t+1)/nt ; ++i) {
+					accu.reset();
+					for (size_t l = 0 ; l < _maxc ; ++l) {
+						if (field().isZero(_data[i*_maxc+l]))
+							break;
+						accu.mulacc(_data[i*_maxc+l], xp+_colid[i*_maxc+l]*ldx);
+					}
+					accu.get(yp+i*ldy);
+				}
+			});
+
+			return Y;
+		}
+
 		template<class inVector, class outVector>
 		outVector& applyTranspose(outVector &y, const inVector& x ) const
 		{
@@ -890,6 +916,36 @@ namespace LinBox
 
 	private :
 
+		// word size modular fields: delayed reduction and SIMD gathers.
+		// Rows are padded with zeros in column 0, so they can be taken whole.
+		template<class Vector>
+		void applyRows(Vector &y, const Vector& x, std::true_type) const
+		{
+			const Element * xp = SpMV::densePointer<Element>(x) ;
+			if (xp == NULL)
+				return applyRows(y,x,std::false_type());
+
+			SpMV::Kernel<Field> K(field());
+			for (size_t i = 0 ; i < _rownb ; ++i)
+				K.dot(y[i], _data.data()+i*_maxc, _colid.data()+i*_maxc, _maxc, xp);
+		}
+
+		template<class Vector>
+		void applyRows(Vector &y, const Vector& x, std::false_type) const
+		{
+			FieldAXPY<Field> accu(field());
+			for (size_t i = 0 ; i < _rownb ; ++i) {
+				accu.reset();
+				for (size_t k = 0   ; k < _maxc ; ++k)
+					if (!field().isZero(getData(i,k)))
+						accu.mulacc( getData(i,k), x[getColid(i,k)] );
+					else {
+						break;
+					}
+				accu.get(y[i]);
+			}
+		}
+
 		class Helper {
 			bool _useable ;
 			bool _optimized ;
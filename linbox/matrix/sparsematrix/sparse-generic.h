@@ -84,6 +84,9 @@
 #include "linbox/solutions/solution-tags.h"
 #include "linbox/matrix/matrix-traits.h"
 #include "linbox/field/hom.h"
+#ifdef __LINBOX_PARALLEL
+#include "linbox/blackbox/blackbox_parallel.h"
+#endif
 
 
 
@@ -131,10 +134,6 @@ namespace LinBox { namespace Protected { /*  SparseMatrixGeneric */
 		typedef typename _SP_BB_VECTOR_<Row> Rep;
 		typedef SparseMatrixGeneric<_Field, _Row, Trait> Self_t;
 
-#ifdef __LINBOX_PARALLEL
-		BB_list_list sub_list;
-#endif
-
 
 
 		/** Constructor.
@@ -216,24 +215,7 @@ namespace LinBox { namespace Protected { /*  SparseMatrixGeneric */
 
 
 		/** Destructor. */
-		~SparseMatrixGeneric () {
-#ifdef __LINBOX_PARALLEL
-
-			BB_list_list::iterator p;
-
-			BB_list::iterator e_p;
-
-			for (p = sub_list. begin(); p != sub_list. end(); ++ p)
-				for (e_p = p -> second. begin();
-				     e_p != p -> second. end(); ++ e_p) {
-
-					Thread::terminate_thread (*e_p);
-
-					delete (*e_p);
-				}
-#endif
-
-		}
+		~SparseMatrixGeneric () {}
 
 		/** Retreive row dimension of the matrix.
 		 * @return integer number of rows of SparseMatrixGeneric matrix.
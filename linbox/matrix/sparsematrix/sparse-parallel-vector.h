@@ -111,10 +111,6 @@ namespace LinBox { namespace Protected {
 		typedef VectorCategories::SparseParallelVectorTag myTrait;
 		typedef SparseMatrixGeneric<_Field, _Row, myTrait> Self_t;
 
-#ifdef __LINBOX_PARALLEL
-		BB_list_list sub_list;
-#endif
-
 
 		template<typename _Tp1, typename _R1 = typename Rebind<_Row,_Tp1>::other >
 		struct rebind {
@@ -0,0 +1,584 @@
+/* linbox/matrix/sparsematrix/sparse-simd-kernels.h
+ * Copyright (C) 2016 the LinBox group
+ *
+ * ========LICENCE========
+ * This file is part of the library LinBox.
+ *
+ * LinBox is free software: you can redistribute it and/or modify
+ * it under the terms of the  GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.	 See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ * ========LICENCE========
+ */
+
+/*! @file matrix/sparsematrix/sparse-simd-kernels.h
+ * @ingroup sparsematrix
+ * @brief Sparse dot products with delayed modular reduction.
+ *
+ * A row of a CSR/ELL/ELL_R matrix is a list of values \c a and column
+ * indices \c j ; these kernels compute <code>sum a[k] x[j[k]] mod p</code>
+ * for the word size fields <code>Givaro::Modular<double></code>,
+ * <code>Givaro::Modular<float></code> and <code>Givaro::Modular<int32_t></code>.
+ *
+ * Products are accumulated without reduction as long as the
+ * accumulator cannot overflow (53 bit mantissa for \c double and \c float,
+ * 64 bit unsigned integers for \c int32_t), then reduced once.
+ * On x86-64 with GCC or clang, AVX2 and AVX-512 gather based versions are
+ * compiled regardless of the compiler flags and chosen at run time from
+ * the CPU features. Define \c LINBOX_SPMV_NO_SIMD to keep the scalar code
+ * only.
+ *
+ * The BlockAccumulator classes do the same for a sparse row times a dense
+ * row major block of \c k vectors, as used by the \c applyLeft (SpMM)
+ * of the sparse formats.
+ */
+
+#ifndef __LINBOX_matrix_sparsematrix_sparse_simd_kernels_H
+#define __LINBOX_matrix_sparsematrix_sparse_simd_kernels_H
+
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include <stdint.h>
+#include <type_traits>
+
+#include "linbox/linbox-config.h"
+#include "linbox/util/field-axpy.h"
+#include "givaro/modular.h"
+
+//! below this number of multiplications, applyLeft (SpMM) stays sequential.
+#ifndef LINBOX_SPMM_PARALLEL
+#define LINBOX_SPMM_PARALLEL 10000
+#endif
+
+#if !defined(LINBOX_SPMV_NO_SIMD) && defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__)) && !defined(__INTEL_COMPILER)
+#define __LINBOX_SPMV_DISPATCH
+#include <immintrin.h>
+#endif
+
+namespace LinBox {
+
+	template<class _Field, class _Rep> class BlasVector ;
+
+	//! Sparse matrix-vector product kernels.
+	namespace SpMV {
+
+		//! Instruction sets the kernels can use.
+		enum SimdLevel {
+			SIMD_NONE   = 0,
+			SIMD_AVX2   = 1, //!< AVX2 and FMA
+			SIMD_AVX512 = 2  //!< AVX-512F
+		};
+
+		//! Best instruction set of the running CPU (detected once).
+		inline SimdLevel simdLevel()
+		{
+#ifdef __LINBOX_SPMV_DISPATCH
+			static const SimdLevel level = [](){
+				__builtin_cpu_init();
+				if (__builtin_cpu_supports("avx512f"))
+					return SIMD_AVX512 ;
+				if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+					return SIMD_AVX2 ;
+				return SIMD_NONE ;
+			}();
+			return level ;
+#else
+			return SIMD_NONE ;
+#endif
+		}
+
+		/*! Number of products <code>(p-1)^2</code> that can be added to a
+		 * reduced value before reaching \p bound (capped to 2^32, so
+		 * that block ends never overflow).
+		 */
+		inline uint64_t delay(uint64_t p, uint64_t bound)
+		{
+			const uint64_t cap = (uint64_t)1 << 32 ;
+			uint64_t b = (p-1)*(p-1) ;
+			if (b == 0)
+				return cap ;
+			return std::min(std::max<uint64_t>((bound - (p-1)) / b, 1), cap) ;
+		}
+
+		//! 2^53, the bound for exact integer arithmetic in a \c double.
+		static const uint64_t mantissaBound = (uint64_t)1 << 53 ;
+
+		/*! @internal
+		 * acc + sum a[k] x[j[k]] mod p, in double, for 0 <= acc < p.
+		 * Works for \c double and \c float elements.
+		 */
+		template<class Elt, class Index>
+		inline double dotScalar(double acc, const Elt* a, const Index* j, size_t n, const Elt* x, double p, size_t d)
+		{
+			size_t k = 0 ;
+			while (k < n) {
+				size_t e = std::min(n, k+d);
+				for ( ; k < e ; ++k)
+					acc += (double)a[k] * (double)x[j[k]] ;
+				acc = std::fmod(acc,p);
+			}
+			return acc ;
+		}
+
+		/*! @internal
+		 * acc + sum a[k] x[j[k]] mod p, in 64 bit integers, for 0 <= acc < p.
+		 */
+		template<class Index>
+		inline uint64_t dotScalar(uint64_t acc, const int32_t* a, const Index* j, size_t n, const int32_t* x, uint64_t p, size_t d)
+		{
+			size_t k = 0 ;
+			while (k < n) {
+				size_t e = std::min(n, k+d);
+				for ( ; k < e ; ++k)
+					acc += (uint64_t)a[k] * (uint64_t)x[j[k]] ;
+				acc %= p ;
+			}
+			return acc ;
+		}
+
+#ifdef __LINBOX_SPMV_DISPATCH
+		/*! @internal
+		 * AVX2 and AVX-512 versions.
+		 * \p j must hold 64 bit indices, each lane accumulates at most
+		 * \p d products between two reductions.
+		 */
+		//@{
+		__attribute__((target("avx2,fma")))
+		inline __m256d reduceAVX2(__m256d r, __m256d P, __m256d invP)
+		{
+			// r - floor(r/p) p is in [-p,2p[ because of the rounding of r/p
+			__m256d q = _mm256_floor_pd(_mm256_mul_pd(r,invP));
+			r = _mm256_fnmadd_pd(q,P,r);
+			r = _mm256_add_pd(r, _mm256_and_pd(_mm256_cmp_pd(r,_mm256_setzero_pd(),_CMP_LT_OQ),P));
+			r = _mm256_sub_pd(r, _mm256_and_pd(_mm256_cmp_pd(r,P,_CMP_GE_OQ),P));
+			return r ;
+		}
+
+		__attribute__((target("avx2,fma")))
+		inline double dotAVX2(const double* a, const int64_t* j, size_t n, const double* x, double p, size_t d)
+		{
+			const __m256d P = _mm256_set1_pd(p);
+			const __m256d invP = _mm256_set1_pd(1./p);
+			__m256d acc = _mm256_setzero_pd();
+			size_t n4 = n & ~(size_t)3 ;
+			size_t k = 0 ;
+			while (k < n4) {
+				size_t e = std::min(n4, k+4*d);
+				for ( ; k < e ; k += 4) {
+					__m256i idx = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(j+k));
+					__m256d xv = _mm256_i64gather_pd(x,idx,8);
+					acc = _mm256_fmadd_pd(_mm256_loadu_pd(a+k),xv,acc);
+				}
+				acc = reduceAVX2(acc,P,invP);
+			}
+			double t[4] ;
+			_mm256_storeu_pd(t,acc);
+			double r = std::fmod(t[0]+t[1]+t[2]+t[3],p);
+			return dotScalar(r,a+k,j+k,n-k,x,p,d);
+		}
+
+		__attribute__((target("avx2,fma")))
+		inline double dotAVX2(const float* a, const int64_t* j, size_t n, const float* x, double p, size_t d)
+		{
+			const __m256d P = _mm256_set1_pd(p);
+			const __m256d invP = _mm256_set1_pd(1./p);
+			__m256d acc = _mm256_setzero_pd();
+			size_t n4 = n & ~(size_t)3 ;
+			size_t k = 0 ;
+			while (k < n4) {
+				size_t e = std::min(n4, k+4*d);
+				for ( ; k < e ; k += 4) {
+					__m256i idx = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(j+k));
+					__m256d xv = _mm256_cvtps_pd(_mm256_i64gather_ps(x,idx,4));
+					acc = _mm256_fmadd_pd(_mm256_cvtps_pd(_mm_loadu_ps(a+k)),xv,acc);
+				}
+				acc = reduceAVX2(acc,P,invP);
+			}
+			double t[4] ;
+			_mm256_storeu_pd(t,acc);
+			double r = std::fmod(t[0]+t[1]+t[2]+t[3],p);
+			return dotScalar(r,a+k,j+k,n-k,x,p,d);
+		}
+
+		__attribute__((target("avx2")))
+		inline uint64_t dotAVX2(const int32_t* a, const int64_t* j, size_t n, const int32_t* x, uint64_t p, size_t d)
+		{
+			__m256i acc = _mm256_setzero_si256();
+			uint64_t t[4] ;
+			size_t n4 = n & ~(size_t)3 ;
+			size_t k = 0 ;
+			while (k < n4) {
+				size_t e = std::min(n4, k+4*d);
+				for ( ; k < e ; k += 4) {
+					__m256i idx = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(j+k));
+					__m256i xv = _mm256_cvtepu32_epi64(_mm256_i64gather_epi32(x,idx,4));
+					__m256i av = _mm256_cvtepu32_epi64(_mm_loadu_si128(reinterpret_cast<const __m128i*>(a+k)));
+					acc = _mm256_add_epi64(acc,_mm256_mul_epu32(av,xv));
+				}
+				// no 64 bit modulo in AVX2
+				_mm256_storeu_si256(reinterpret_cast<__m256i*>(t),acc);
+				for (size_t l = 0 ; l < 4 ; ++l)
+					t[l] %= p ;
+				acc = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(t));
+			}
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(t),acc);
+			uint64_t r = (t[0]+t[1]+t[2]+t[3]) % p ;
+			return dotScalar(r,a+k,j+k,n-k,x,p,d);
+		}
+
+		__attribute__((target("avx512f")))
+		inline __m512d reduceAVX512(__m512d r, __m512d P, __m512d invP)
+		{
+			__m512d q = _mm512_roundscale_pd(_mm512_mul_pd(r,invP),_MM_FROUND_TO_NEG_INF|_MM_FROUND_NO_EXC);
+			r = _mm512_fnmadd_pd(q,P,r);
+			r = _mm512_mask_add_pd(r,_mm512_cmp_pd_mask(r,_mm512_setzero_pd(),_CMP_LT_OQ),r,P);
+			r = _mm512_mask_sub_pd(r,_mm512_cmp_pd_mask(r,P,_CMP_GE_OQ),r,P);
+			return r ;
+		}
+
+		__attribute__((target("avx512f")))
+		inline double dotAVX512(const double* a, const int64_t* j, size_t n, const double* x, double p, size_t d)
+		{
+			const __m512d P = _mm512_set1_pd(p);
+			const __m512d invP = _mm512_set1_pd(1./p);
+			__m512d acc = _mm512_setzero_pd();
+			size_t n8 = n & ~(size_t)7 ;
+			size_t k = 0 ;
+			while (k < n8) {
+				size_t e = std::min(n8, k+8*d);
+				for ( ; k < e ; k += 8) {
+					__m512i idx = _mm512_loadu_si512(j+k);
+					__m512d xv = _mm512_i64gather_pd(idx,x,8);
+					acc = _mm512_fmadd_pd(_mm512_loadu_pd(a+k),xv,acc);
+				}
+				acc = reduceAVX512(acc,P,invP);
+			}
+			double r = std::fmod(_mm512_reduce_add_pd(acc),p);
+			return dotScalar(r,a+k,j+k,n-k,x,p,d);
+		}
+
+		__attribute__((target("avx512f")))
+		inline double dotAVX512(const float* a, const int64_t* j, size_t n, const float* x, double p, size_t d)
+		{
+			const __m512d P = _mm512_set1_pd(p);
+			const __m512d invP = _mm512_set1_pd(1./p);
+			__m512d acc = _mm512_setzero_pd();
+			size_t n8 = n & ~(size_t)7 ;
+			size_t k = 0 ;
+			while (k < n8) {
+				size_t e = std::min(n8, k+8*d);
+				for ( ; k < e ; k += 8) {
+					__m512i idx = _mm512_loadu_si512(j+k);
+					__m512d xv = _mm512_cvtps_pd(_mm512_i64gather_ps(idx,x,4));
+					acc = _mm512_fmadd_pd(_mm512_cvtps_pd(_mm256_loadu_ps(a+k)),xv,acc);
+				}
+				acc = reduceAVX512(acc,P,invP);
+			}
+			double r = std::fmod(_mm512_reduce_add_pd(acc),p);
+			return dotScalar(r,a+k,j+k,n-k,x,p,d);
+		}
+
+		__attribute__((target("avx512f")))
+		inline uint64_t dotAVX512(const int32_t* a, const int64_t* j, size_t n, const int32_t* x, uint64_t p, size_t d)
+		{
+			__m512i acc = _mm512_setzero_si512();
+			uint64_t t[8] ;
+			size_t n8 = n & ~(size_t)7 ;
+			size_t k = 0 ;
+			while (k < n8) {
+				size_t e = std::min(n8, k+8*d);
+				for ( ; k < e ; k += 8) {
+					__m512i idx = _mm512_loadu_si512(j+k);
+					__m512i xv = _mm512_cvtepu32_epi64(_mm512_i64gather_epi32(idx,x,4));
+					__m512i av = _mm512_cvtepu32_epi64(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(a+k)));
+					acc = _mm512_add_epi64(acc,_mm512_mul_epu32(av,xv));
+				}
+				_mm512_storeu_si512(t,acc);
+				for (size_t l = 0 ; l < 8 ; ++l)
+					t[l] %= p ;
+				acc = _mm512_loadu_si512(t);
+			}
+			_mm512_storeu_si512(t,acc);
+			uint64_t r = 0 ;
+			for (size_t l = 0 ; l < 8 ; ++l)
+				r += t[l] ;
+			r %= p ;
+			return dotScalar(r,a+k,j+k,n-k,x,p,d);
+		}
+		//@}
+#endif // __LINBOX_SPMV_DISPATCH
+
+		/*! @internal
+		 * Picks the kernel for the running CPU.
+		 * The SIMD versions need 64 bit indices.
+		 */
+		template<class Elt, class Acc, class Index>
+		inline Acc dispatchDot(SimdLevel level, const Elt* a, const Index* j, size_t n, const Elt* x, Acc p, size_t d)
+		{
+#ifdef __LINBOX_SPMV_DISPATCH
+			if (sizeof(Index) == sizeof(int64_t)) {
+				const int64_t* j64 = reinterpret_cast<const int64_t*>(j);
+				if (level == SIMD_AVX512)
+					return dotAVX512(a,j64,n,x,p,d);
+				if (level == SIMD_AVX2)
+					return dotAVX2(a,j64,n,x,p,d);
+			}
+#endif
+			return dotScalar((Acc)0,a,j,n,x,p,d);
+		}
+
+		/*! Sparse dot products over \p Field.
+		 * Not available in general: the matrices then use FieldAXPY.
+		 * \c Available is \c std::true_type or \c std::false_type, for tag
+		 * dispatching.
+		 */
+		template<class Field>
+		struct Kernel {
+			typedef typename Field::Element Element ;
+			typedef std::false_type Available ;
+
+			Kernel(const Field &) {}
+
+			template<class Index>
+			Element & dot(Element & r, const Element*, const Index*, size_t, const Element*) const
+			{
+				return r ;
+			}
+		};
+
+		//! <code>Givaro::Modular<double></code> : accumulation in double.
+		template<>
+		struct Kernel<Givaro::Modular<double> > {
+			typedef double Element ;
+			typedef std::true_type Available ;
+
+			Kernel(const Givaro::Modular<double> & F) :
+				_p((double)F.characteristic())
+				, _delay((size_t)delay((uint64_t)F.characteristic(),mantissaBound))
+				, _level(simdLevel())
+			{}
+
+			template<class Index>
+			Element & dot(Element & r, const Element* a, const Index* j, size_t n, const Element* x) const
+			{
+				return r = dispatchDot(_level,a,j,n,x,_p,_delay);
+			}
+
+		private:
+			double _p ;
+			size_t _delay ;
+			SimdLevel _level ;
+		};
+
+		//! <code>Givaro::Modular<float></code> : accumulation in double.
+		template<>
+		struct Kernel<Givaro::Modular<float> > {
+			typedef float Element ;
+			typedef std::true_type Available ;
+
+			Kernel(const Givaro::Modular<float> & F) :
+				_p((double)F.characteristic())
+				, _delay((size_t)delay((uint64_t)F.characteristic(),mantissaBound))
+				, _level(simdLevel())
+			{}
+
+			template<class Index>
+			Element & dot(Element & r, const Element* a, const Index* j, size_t n, const Element* x) const
+			{
+				return r = (Element) dispatchDot(_level,a,j,n,x,_p,_delay);
+			}
+
+		private:
+			double _p ;
+			size_t _delay ;
+			SimdLevel _level ;
+		};
+
+		//! <code>Givaro::Modular<int32_t></code> : accumulation in 64 bit unsigned integers.
+		template<class Compute>
+		struct Kernel<Givaro::Modular<int32_t,Compute> > {
+			typedef int32_t Element ;
+			typedef std::true_type Available ;
+
+			Kernel(const Givaro::Modular<int32_t,Compute> & F) :
+				_p((uint64_t)F.characteristic())
+				, _delay((size_t)delay((uint64_t)F.characteristic(),~(uint64_t)0))
+				, _level(simdLevel())
+			{}
+
+			template<class Index>
+			Element & dot(Element & r, const Element* a, const Index* j, size_t n, const Element* x) const
+			{
+				return r = (Element) dispatchDot(_level,a,j,n,x,_p,_delay);
+			}
+
+		private:
+			uint64_t _p ;
+			size_t _delay ;
+			SimdLevel _level ;
+		};
+
+		/*! Linear combination of rows of a dense row major block,
+		 * <code>y[0..k) = sum a_l x_l[0..k)</code>, where \c x_l points to
+		 * a row of \c k contiguous entries.
+		 * This is the generic version, with one FieldAXPY per column.
+		 */
+		template<class Field>
+		class BlockAccumulator {
+		public:
+			typedef typename Field::Element Element ;
+
+			BlockAccumulator(const Field & F, size_t k) :
+				_acc(k, FieldAXPY<Field>(F))
+			{}
+
+			void reset()
+			{
+				for (size_t l = 0 ; l < _acc.size() ; ++l)
+					_acc[l].reset();
+			}
+
+			void mulacc(const Element & a, const Element * x)
+			{
+				for (size_t l = 0 ; l < _acc.size() ; ++l)
+					_acc[l].mulacc(a,x[l]);
+			}
+
+			void get(Element * y)
+			{
+				for (size_t l = 0 ; l < _acc.size() ; ++l)
+					_acc[l].get(y[l]);
+			}
+
+		private:
+			std::vector<FieldAXPY<Field> > _acc ;
+		};
+
+		/*! @internal
+		 * BlockAccumulator for word size fields: products are added
+		 * in \c Acc and the \c k accumulators are reduced once every
+		 * delay() rows. The inner loop is contiguous and left to the
+		 * compiler to vectorise.
+		 */
+		template<class Elt, class Acc>
+		class DelayedBlockAccumulator {
+		public:
+			DelayedBlockAccumulator(uint64_t p, uint64_t bound, size_t k) :
+				_p((Acc)p)
+				, _delay((size_t)delay(p,bound))
+				, _count(0)
+				, _acc(k,(Acc)0)
+			{}
+
+			void reset()
+			{
+				std::fill(_acc.begin(),_acc.end(),(Acc)0);
+				_count = 0 ;
+			}
+
+			void mulacc(const Elt & a, const Elt * x)
+			{
+				if (_count == _delay)
+					reduce();
+				const Acc aa = (Acc)a ;
+				Acc * acc = _acc.data();
+				const size_t k = _acc.size();
+				for (size_t l = 0 ; l < k ; ++l)
+					acc[l] += aa * (Acc)x[l] ;
+				++_count ;
+			}
+
+			void get(Elt * y)
+			{
+				reduce();
+				for (size_t l = 0 ; l < _acc.size() ; ++l)
+					y[l] = (Elt)_acc[l] ;
+			}
+
+		private:
+			static void reduceIn(double & r, double p) { r = std::fmod(r,p); }
+			static void reduceIn(uint64_t & r, uint64_t p) { r %= p ; }
+
+			void reduce()
+			{
+				for (size_t l = 0 ; l < _acc.size() ; ++l)
+					reduceIn(_acc[l],_p);
+				_count = 0 ;
+			}
+
+			Acc _p ;
+			size_t _delay ;
+			size_t _count ;
+			std::vector<Acc> _acc ;
+		};
+
+		template<>
+		class BlockAccumulator<Givaro::Modular<double> > : public DelayedBlockAccumulator<double,double> {
+		public:
+			BlockAccumulator(const Givaro::Modular<double> & F, size_t k) :
+				DelayedBlockAccumulator<double,double>((uint64_t)F.characteristic(),mantissaBound,k)
+			{}
+		};
+
+		template<>
+		class BlockAccumulator<Givaro::Modular<float> > : public DelayedBlockAccumulator<float,double> {
+		public:
+			BlockAccumulator(const Givaro::Modular<float> & F, size_t k) :
+				DelayedBlockAccumulator<float,double>((uint64_t)F.characteristic(),mantissaBound,k)
+			{}
+		};
+
+		template<class Compute>
+		class BlockAccumulator<Givaro::Modular<int32_t,Compute> > : public DelayedBlockAccumulator<int32_t,uint64_t> {
+		public:
+			BlockAccumulator(const Givaro::Modular<int32_t,Compute> & F, size_t k) :
+				DelayedBlockAccumulator<int32_t,uint64_t>((uint64_t)F.characteristic(),~(uint64_t)0,k)
+			{}
+		};
+
+		/*! Contiguous storage of a dense vector, or \c NULL when it is
+		 * not known to be contiguous.
+		 */
+		//@{
+		template<class Element, class Vect>
+		inline const Element * densePointer(const Vect &)
+		{
+			return NULL ;
+		}
+
+		template<class Element, class Alloc>
+		inline const Element * densePointer(const std::vector<Element,Alloc> & v)
+		{
+			return v.empty() ? NULL : &v[0] ;
+		}
+
+		template<class Element, class Field, class Rep>
+		inline const Element * densePointer(const BlasVector<Field,Rep> & v)
+		{
+			return v.size() ? v.getPointer() : NULL ;
+		}
+		//@}
+
+	} // SpMV
+
+} // LinBox
+
+#endif // __LINBOX_matrix_sparsematrix_sparse_simd_kernels_H
+
+// Local Variables:
+// mode: C++
+// tab-width: 8
+// indent-tabs-mode: nil
+// c-basic-offset: 8
+// End:
+// vim:sts=8:sw=8:ts=8:noet:sr:cino=>s,f0,{0,g0,(0,\:0,t0,+0,=s
@@ -43,6 +43,7 @@
 #include "linbox/blackbox/blackbox-interface.h"
 #include "linbox/field/hom.h"
 #include "linbox/matrix/matrix-domain.h"
+#include "linbox/matrix/sparsematrix/sparse-simd-kernels.h"
 
 #include <vector>
 
@@ -138,16 +138,28 @@ applyLeft // Y = AX
 	( /*typename SparseMatrix<Field_,SparseMatrixFormat::TPL>::Matrix*/Mat1 &Y,
 	  const /*typename SparseMatrix<Field_,SparseMatrixFormat::TPL>::Matrix*/Mat2 &X
 	) const
-{	Y.zero();
-	// Matrix Yc(field()) ;
-	// const Matrix Xc(field());// row submatrices
-	for (Index k = 0; k < data_.size(); ++k) {
-		Triple t = data_[k];
-		Matrix Yc (Y,t.row,0,1,Y.coldim());
-		// Yc.submatrix(Y,t.row,0,1,Y.coldim());
-		typename Matrix::constSubMatrixType Xc(X,t.col,0,1,X.coldim());
-		// Xc.submatrix(X,t.col,0,1,X.coldim());
-		MD_.saxpyin(Yc, t.elt, Xc);
+{	linbox_check(X.rowdim() == coldim());
+	linbox_check(Y.rowdim() == rowdim());
+	Y.zero();
+	const size_t k = X.coldim();
+	const Element * xp = X.getPointer();
+	Element * yp = Y.getPointer();
+	const size_t ldx = X.getStride();
+	const size_t ldy = Y.getStride();
+	// consecutive triples on the same row are accumulated together,
+	// each row of Y is then updated once per run.
+	SpMV::BlockAccumulator<Field> accu(field(),k);
+	std::vector<Element> Yi(k);
+	Index z = 0;
+	while (z < data_.size()) {
+		const Index i = data_[z].row;
+		accu.reset();
+		for ( ; z < data_.size() && data_[z].row == i ; ++z)
+			accu.mulacc(data_[z].elt, xp+(size_t)data_[z].col*ldx);
+		accu.get(Yi.data());
+		Element * yi = yp+(size_t)i*ldy;
+		for (size_t j = 0 ; j < k ; ++j)
+			field().addin(yi[j], Yi[j]);
 	}
 	return Y;
 }
@@ -34,6 +34,7 @@
 #include "linbox/blackbox/compose.h"
 #include "linbox/solutions/methods.h"
 #include "linbox/solutions/getentry.h"
+#include "linbox/solutions/hybrid-cost-model.h"
 #include "linbox/vector/blas-vector.h"
 
 #include "linbox/matrix/dense-matrix.h"
@@ -123,12 +124,9 @@ namespace LinBox
 						const RingCategories::ModularTag	&tag,
 						const Method::Hybrid			&Meth)
 	{
-		// not yet a hybrid
-
-		if (useBB(A))
+		if (hybridDecision(A, HybridCostModel::DET).choice == HybridDecision::BLACKBOX)
 			return det(d, A, tag, Method::Blackbox(Meth));
 		else
-
 			return det(d, A, tag, Method::Elimination(Meth));
 	}
 	template<class Blackbox>
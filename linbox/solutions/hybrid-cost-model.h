@@ -0,0 +1,547 @@
+/* linbox/solutions/hybrid-cost-model.h
+ * Copyright (C) the LinBox group
+ *
+ * ========LICENCE========
+ * This file is part of the library LinBox.
+ *
+ * LinBox is free software: you can redistribute it and/or modify
+ * it under the terms of the  GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ * ========LICENCE========
+ *.
+ */
+
+/*! @file solutions/hybrid-cost-model.h
+ * @ingroup solutions
+ * @brief Choice between Blackbox and Elimination for Method::Hybrid.
+ *
+ * The times of Wiedemann, sparse elimination and BLAS elimination are
+ * predicted from the shape of the matrix, its number of non zero entries,
+ * the spread of its row lengths and the size of the field elements,
+ * with nominal speeds of the machine, or speeds measured once and kept
+ * in the file named by the LINBOX_HYBRID_CALIBRATION environment variable.
+ */
+
+#ifndef __LINBOX_solutions_hybrid_cost_model_H
+#define __LINBOX_solutions_hybrid_cost_model_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <limits>
+#include <ostream>
+#include <random>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <givaro/modular.h>
+#include "linbox/integer.h"
+#include "linbox/util/commentator.h"
+#include "linbox/util/timer.h"
+#include "linbox/vector/blas-vector.h"
+#include "linbox/matrix/sparse-matrix.h"
+#include "linbox/matrix/dense-matrix.h"
+#include "linbox/matrix/matrixdomain/blas-matrix-domain.h"
+#include "linbox/algorithms/gauss.h"
+
+#ifndef __LINBOX_HYBRID_CALIBRATION_VERSION__
+#define __LINBOX_HYBRID_CALIBRATION_VERSION__ 1
+#endif
+
+#ifndef __LINBOX_HYBRID_MIN_DIM__
+/// Below this dimension, the nominal speeds are used rather than calibrated ones.
+#define __LINBOX_HYBRID_MIN_DIM__ 200
+#endif
+
+#ifndef __LINBOX_HYBRID_MP_COST__
+/// Cost of an operation on multiprecision elements, in word operations per word.
+#define __LINBOX_HYBRID_MP_COST__ 8.0
+#endif
+
+namespace LinBox
+{
+	/** Speeds of the machine, in seconds per operation.
+	 *
+	 * The nominal speeds of the constructor are used unless the
+	 * environment variable \c LINBOX_HYBRID_CALIBRATION names a file:
+	 * the speeds are then read from it, or measured over
+	 * <code>Givaro::Modular<double></code> by time limited
+	 * micro-benchmarks on matrices of a fixed seed and saved there when it
+	 * does not exist yet.  Remove the file to calibrate again.
+	 \ingroup solutions
+	 */
+	struct HybridCalibration {
+		double spmv;    //!< per non zero entry of a sparse apply
+		double vector;  //!< per field operation on vectors
+		double dense;   //!< per operation of dense elimination, as counted by HybridCostModel::denseOps
+		double sparse;  //!< per entry update of sparse elimination, as counted by HybridCostModel::sparseOps
+
+		HybridCalibration () : spmv(2e-9), vector(1e-9), dense(2e-11), sparse(2e-8) {}
+
+		bool read (const char *filename)
+		{
+			std::ifstream in(filename);
+			std::string key;
+			int version = 0, found = 0;
+			double v;
+			while (in >> key) {
+				if (key[0] == '#') {
+					std::getline(in, key);
+					continue;
+				}
+				if (key == "version") { in >> version; continue; }
+				if (! (in >> v) || ! (v > 0))
+					return false;
+				if (key == "spmv")   { spmv = v;   ++found; }
+				if (key == "vector") { vector = v; ++found; }
+				if (key == "dense")  { dense = v;  ++found; }
+				if (key == "sparse") { sparse = v; ++found; }
+			}
+			return version == __LINBOX_HYBRID_CALIBRATION_VERSION__ && found == 4;
+		}
+
+		bool write (const char *filename) const
+		{
+			std::ofstream out(filename);
+			out.precision(std::numeric_limits<double>::max_digits10);
+			out << "# LinBox hybrid cost model calibration, seconds per operation" << std::endl
+			<< "version " << __LINBOX_HYBRID_CALIBRATION_VERSION__ << std::endl
+			<< "spmv " << spmv << std::endl
+			<< "vector " << vector << std::endl
+			<< "dense " << dense << std::endl
+			<< "sparse " << sparse << std::endl;
+			return (bool)out;
+		}
+
+		std::ostream &write (std::ostream &os) const
+		{
+			return os << "spmv " << spmv << " s, vector " << vector
+			<< " s, dense " << dense << " s, sparse " << sparse << " s";
+		}
+
+		/// The calibration file, empty if none.
+		static std::string defaultFile ()
+		{
+			const char *env = std::getenv("LINBOX_HYBRID_CALIBRATION");
+			return (env != NULL) ? std::string(env) : std::string();
+		}
+
+		/// Runs the micro-benchmarks.
+		void measure ();
+
+		/// Read from \p file, or measured and saved there if it cannot be read.
+		static HybridCalibration calibrate (const std::string &file)
+		{
+			HybridCalibration c;
+			if (c.read(file.c_str()))
+				return c;
+			commentator().start("Calibration of the hybrid cost model", "HybridCalibration");
+			c.measure();
+			c.write(commentator().report(Commentator::LEVEL_NORMAL, PARTIAL_RESULT)) << std::endl;
+			c.write(file.c_str());
+			commentator().stop("done", NULL, "HybridCalibration");
+			return c;
+		}
+
+		/// The calibration of defaultFile(), the nominal one if none; fixed on the first call.
+		static const HybridCalibration &get ()
+		{
+			static const HybridCalibration calibration =
+				defaultFile().empty() ? HybridCalibration() : calibrate(defaultFile());
+			return calibration;
+		}
+	};
+
+	/// What the cost model knows of a matrix.
+	struct MatrixProfile {
+		size_t rowdim, coldim;
+		double nnz;          //!< number of non zero entries (estimated if not stored)
+		double rowMean;      //!< mean number of entries of the rows
+		double rowVariance;  //!< variance of the number of entries of the rows
+		bool   sparseStorage;//!< true for SparseMatrix (Elimination is then sparse)
+		bool   blas;         //!< true if elimination can go through BLAS
+		double fieldFactor;  //!< cost of a field operation, in word operations
+
+		MatrixProfile () :
+			rowdim(0), coldim(0), nnz(0), rowMean(0), rowVariance(0)
+			, sparseStorage(false), blas(false), fieldFactor(1)
+		{}
+	};
+
+	/// Choice of the cost model, with the predicted times in seconds.
+	struct HybridDecision {
+		enum Choice { BLACKBOX, ELIMINATION };
+
+		Choice        choice;
+		double        wiedemann;         //!< Method::Blackbox
+		double        sparseElimination; //!< Method::SparseElimination
+		double        blasElimination;   //!< Method::BlasElimination, infinite if not available
+		double        prediction;        //!< predicted time of the choice
+		MatrixProfile profile;
+
+		std::ostream &write (std::ostream &os) const
+		{
+			os << "Hybrid: " << (choice == BLACKBOX ? "Blackbox" : "Elimination")
+			<< " on " << profile.rowdim << "x" << profile.coldim
+			<< ", " << profile.nnz << " nnz (row variance " << profile.rowVariance << ")"
+			<< ", predicted Wiedemann " << wiedemann << " s, sparse elimination "
+			<< sparseElimination << " s, BLAS elimination ";
+			if (blasElimination < std::numeric_limits<double>::infinity())
+				os << blasElimination << " s";
+			else
+				os << "n/a";
+			return os;
+		}
+	};
+
+	/** Cost model of Method::Hybrid.
+	 *
+	 * Wiedemann is 2r steps (r = min(m,n)) of a few applies and vector
+	 * operations, then Berlekamp/Massey in (2r)^2.
+	 * Dense elimination is mnr - (m+n)r^2/2 + r^3/3 operations, after a
+	 * conversion of n applies for a general blackbox.
+	 * Sparse elimination follows the mean row length along the pivots:
+	 * each pivot row is merged into the rows of its column, longer than
+	 * the mean when the row lengths spread (size biased by the variance),
+	 * and the fill-in makes the remaining rows grow; over a BLAS field,
+	 * the elimination turns dense past the density of
+	 * __LINBOX_GAUSS_DENSE_SWITCH__, as GaussDomain does.
+	 \ingroup solutions
+	 */
+	class HybridCostModel {
+	public:
+		enum Operation { RANK, DET, MINPOLY };
+
+		HybridCostModel (const HybridCalibration &c = HybridCalibration::get ()) : _speed(c) {}
+
+		const HybridCalibration &calibration () const { return _speed; }
+
+		/// Dense elimination operations on a m x n matrix.
+		static double denseOps (double m, double n)
+		{
+			const double r = std::min(m, n);
+			return m*n*r - (m+n)*r*r/2 + r*r*r/3;
+		}
+
+		/** Entry updates of sparse elimination; \p dense gets the dense
+		 * operations of the part left to BLAS (0 if none).
+		 */
+		static double sparseOps (const MatrixProfile &p, double &dense)
+		{
+			dense = 0;
+			const double m = (double)p.rowdim, n = (double)p.coldim;
+			const size_t r = std::min(p.rowdim, p.coldim);
+			double L = (m > 0) ? p.nnz / m : 0;
+			// square of the coefficient of variation of the row lengths
+			const double cv2 = (L > 0) ? p.rowVariance / (L*L) : 0;
+			double ops = 0;
+			for (size_t k = 0 ; k + 1 < r && L > 0 ; ++k) {
+				const double R = m - (double)k, C = n - (double)k;
+				if (p.blas && L >= __LINBOX_GAUSS_DENSE_SWITCH__ * C) {
+					dense = denseOps(R, C);
+					break;
+				}
+				// rows met by the pivot column, and their length
+				const double hits = std::max(0.0, L * R / C - 1);
+				const double hitLength = std::min(C, L * (1 + cv2));
+				ops += hits * (L + hitLength);
+				const double fill = hits * std::max(0.0, (L - 1) * (1 - hitLength / C) - 1);
+				L = std::min(C - 1, std::max(0.0, (L * R - L + fill) / (R - 1)));
+			}
+			return ops;
+		}
+
+		double wiedemannTime (const MatrixProfile &p, Operation op) const
+		{
+			const double m = (double)p.rowdim, n = (double)p.coldim;
+			const double steps = 2 * std::min(m, n);
+			// rank: A and its transpose, with diagonal preconditioners
+			const double applies = (op == RANK) ? 2 : 1;
+			const double step = applies * (p.nnz * _speed.spmv + (m + n) * _speed.vector)
+				+ n * _speed.vector;
+			return p.fieldFactor * (steps * step + steps * steps * _speed.vector);
+		}
+
+		double blasEliminationTime (const MatrixProfile &p, Operation op) const
+		{
+			if (! p.blas)
+				return std::numeric_limits<double>::infinity();
+			const double m = (double)p.rowdim, n = (double)p.coldim;
+			// conversion: entries for a sparse matrix, n applies otherwise
+			const double conversion = p.sparseStorage
+				? (m * n + p.nnz) * _speed.vector
+				: n * (p.nnz * _speed.spmv + m * _speed.vector);
+			// Krylov iterates then elimination for the minimal polynomial
+			const double factor = (op == MINPOLY) ? 3 : 1;
+			return conversion + factor * denseOps(m, n) * _speed.dense;
+		}
+
+		double sparseEliminationTime (const MatrixProfile &p) const
+		{
+			double dense;
+			const double ops = sparseOps(p, dense);
+			// a general blackbox is copied entry by entry
+			const double conversion = p.sparseStorage ? p.nnz * _speed.vector
+				: (double)p.coldim * (p.nnz * _speed.spmv + (double)p.rowdim * _speed.vector);
+			return conversion + p.fieldFactor * ops * _speed.sparse + dense * _speed.dense;
+		}
+
+		HybridDecision decide (const MatrixProfile &p, Operation op) const
+		{
+			HybridDecision d;
+			d.profile           = p;
+			d.wiedemann         = wiedemannTime(p, op);
+			d.blasElimination   = blasEliminationTime(p, op);
+			d.sparseElimination = sparseEliminationTime(p);
+			// what Method::Elimination runs
+			double elimination;
+			if (op == MINPOLY)
+				elimination = d.blasElimination;
+			else if (p.sparseStorage || ! p.blas)
+				elimination = d.sparseElimination;
+			else
+				elimination = d.blasElimination;
+			d.choice = (d.wiedemann < elimination) ? HybridDecision::BLACKBOX : HybridDecision::ELIMINATION;
+			d.prediction = std::min(d.wiedemann, elimination);
+			return d;
+		}
+
+		template <class Blackbox>
+		HybridDecision decide (const Blackbox &A, Operation op) const
+		{
+			return decide(profile(A), op);
+		}
+
+		/// A blackbox: its number of entries is estimated by the time of an apply.
+		template <class Blackbox>
+		MatrixProfile profile (const Blackbox &A) const
+		{
+			MatrixProfile p;
+			fieldProfile(p, A);
+			typedef typename Blackbox::Field Field;
+			const Field &F = A.field();
+			typename Field::RandIter G(F);
+			BlasVector<Field> x(F, A.coldim()), y(F, A.rowdim());
+			for (size_t j = 0 ; j < x.size() ; ++j)
+				G.random(x[j]);
+			Timer chrono;
+			chrono.clear();
+			chrono.start();
+			A.apply(y, x);
+			chrono.stop();
+			p.nnz = std::max((double)A.rowdim(), chrono.realtime() / _speed.spmv / p.fieldFactor);
+			p.rowMean = p.nnz / (double)std::max(A.rowdim(), (size_t)1);
+			return p;
+		}
+
+		template <class Field, class Storage>
+		MatrixProfile profile (const SparseMatrix<Field, Storage> &A) const
+		{
+			MatrixProfile p;
+			fieldProfile(p, A);
+			p.sparseStorage = true;
+			p.nnz = (double)A.size();
+			p.rowMean = p.nnz / (double)std::max(A.rowdim(), (size_t)1);
+			rowSpread(p, A);
+			return p;
+		}
+
+		template <class Field, class Rep>
+		MatrixProfile profile (const BlasMatrix<Field, Rep> &A) const
+		{
+			MatrixProfile p;
+			fieldProfile(p, A);
+			p.nnz = (double)A.rowdim() * (double)A.coldim();
+			p.rowMean = (double)A.coldim();
+			return p;
+		}
+
+	private:
+		template <class Blackbox>
+		static void fieldProfile (MatrixProfile &p, const Blackbox &A)
+		{
+			typedef typename Blackbox::Field::Element Element;
+			p.rowdim = A.rowdim();
+			p.coldim = A.coldim();
+			integer c, q;
+			A.field().characteristic(c);
+			A.field().cardinality(q);
+			p.blas = (c == q && c < LinBox::BlasBound);
+			if (std::is_arithmetic<Element>::value)
+				p.fieldFactor = 1;
+			else {
+				const double words = std::ceil((double)c.bitsize() / 64);
+				p.fieldFactor = __LINBOX_HYBRID_MP_COST__ * std::pow(std::max(words, 1.0), 1.6);
+			}
+		}
+
+		template <class Matrix>
+		static void rowSpread (MatrixProfile &, const Matrix &) {}
+
+		template <class Field>
+		static void rowSpread (MatrixProfile &p, const SparseMatrix<Field, SparseMatrixFormat::SparseSeq> &A)
+		{
+			double s = 0;
+			for (size_t i = 0 ; i < A.rowdim() ; ++i)
+				s += ((double)A[i].size() - p.rowMean) * ((double)A[i].size() - p.rowMean);
+			p.rowVariance = s / (double)std::max(A.rowdim(), (size_t)1);
+		}
+
+		template <class Field>
+		static void rowSpread (MatrixProfile &p, const SparseMatrix<Field, SparseMatrixFormat::CSR> &A)
+		{
+			double s = 0;
+			for (size_t i = 0 ; i < A.rowdim() ; ++i) {
+				const double l = (double)(A.getEnd(i) - A.getStart(i));
+				s += (l - p.rowMean) * (l - p.rowMean);
+			}
+			p.rowVariance = s / (double)std::max(A.rowdim(), (size_t)1);
+		}
+
+		HybridCalibration _speed;
+	};
+
+	inline void HybridCalibration::measure ()
+	{
+		typedef Givaro::Modular<double> Field;
+		typedef Field::Element Element;
+		const Field F(65521);
+		Field::RandIter G(F, 0, 1);
+		std::mt19937 gen(1);
+		Timer chrono;
+
+		// sparse apply, larger than the caches
+		{
+			const size_t n = 1 << 16, w = 8;
+			SparseMatrix<Field, SparseMatrixFormat::SparseSeq> S(F, n, n);
+			Element a;
+			for (size_t i = 0 ; i < n ; ++i)
+				for (size_t k = 0 ; k < w ; ++k) {
+					do G.random(a); while (F.isZero(a));
+					S.setEntry(i, (size_t)(gen() % n), a);
+				}
+			SparseMatrix<Field, SparseMatrixFormat::CSR> A(S);
+			BlasVector<Field> x(F, n), y(F, n);
+			for (size_t j = 0 ; j < n ; ++j)
+				G.random(x[j]);
+			size_t k = 0;
+			chrono.clear();
+			chrono.start();
+			do {
+				A.apply(y, x);
+				++k;
+				chrono.stop();
+			} while (chrono.realtime() < 0.05);
+			spmv = chrono.realtime() / ((double)k * (double)A.size());
+		}
+
+		// vector operations
+		{
+			const size_t n = 1 << 16;
+			BlasVector<Field> x(F, n), y(F, n);
+			Element a;
+			G.random(a);
+			for (size_t j = 0 ; j < n ; ++j)
+				G.random(x[j]);
+			size_t k = 0;
+			chrono.clear();
+			chrono.start();
+			do {
+				for (size_t j = 0 ; j < n ; ++j)
+					F.axpyin(y[j], a, x[j]);
+				++k;
+				chrono.stop();
+			} while (chrono.realtime() < 0.02);
+			vector = chrono.realtime() / ((double)k * (double)n);
+		}
+
+		// dense elimination
+		{
+			const size_t n = 512;
+			BlasMatrix<Field> A(F, n, n);
+			A.random();
+			BlasMatrixDomain<Field> BMD(F);
+			chrono.clear();
+			chrono.start();
+			BMD.rankin(A);
+			chrono.stop();
+			dense = chrono.realtime() / HybridCostModel::denseOps((double)n, (double)n);
+		}
+
+		// sparse elimination, the dense part left to BLAS taken out, on
+		// matrices doubling in size until one takes long enough
+		for (size_t n = 500 ; ; n *= 2) {
+			const size_t w = 4;
+			SparseMatrix<Field, SparseMatrixFormat::SparseSeq> S(F, n, n);
+			Element a;
+			for (size_t i = 0 ; i < n ; ++i)
+				for (size_t k = 0 ; k < w ; ++k) {
+					do G.random(a); while (F.isZero(a));
+					S.setEntry(i, (size_t)(gen() % n), a);
+				}
+			MatrixProfile p;
+			p.rowdim = p.coldim = n;
+			p.blas = true;
+			p.nnz = (double)S.size();
+			p.rowMean = p.nnz / (double)n;
+			for (size_t i = 0 ; i < n ; ++i)
+				p.rowVariance += ((double)S[i].size() - p.rowMean) * ((double)S[i].size() - p.rowMean);
+			p.rowVariance /= (double)n;
+			double denseLeft;
+			const double ops = HybridCostModel::sparseOps(p, denseLeft);
+			GaussDomain<Field> GD(F);
+			unsigned long r;
+			chrono.clear();
+			chrono.start();
+			GD.rankin(r, S);
+			chrono.stop();
+			sparse = (chrono.realtime() - denseLeft * dense) / std::max(ops, 1.0);
+			if (chrono.realtime() >= 0.05 || n >= 4000)
+				break;
+		}
+
+		// a timer too coarse leaves zeros
+		spmv   = std::max(spmv, 1e-12);
+		vector = std::max(vector, 1e-12);
+		dense  = std::max(dense, 1e-14);
+		sparse = std::max(sparse, 1e-12);
+	}
+
+	/** The decision of the cost model for \p A, reported to the commentator.
+	 *
+	 * Small matrices are decided with the nominal speeds, so that they
+	 * never wait for the calibration.
+	 */
+	template <class Blackbox>
+	HybridDecision hybridDecision (const Blackbox &A, HybridCostModel::Operation op)
+	{
+		const bool small = std::min(A.rowdim(), A.coldim()) < __LINBOX_HYBRID_MIN_DIM__;
+		HybridCostModel model(small ? HybridCalibration() : HybridCalibration::get());
+		HybridDecision d = model.decide(A, op);
+		d.write(commentator().report(Commentator::LEVEL_NORMAL, PARTIAL_RESULT)) << std::endl;
+		return d;
+	}
+
+} // namespace LinBox
+
+#endif // __LINBOX_solutions_hybrid_cost_model_H
+
+// vim:sts=8:sw=8:ts=8:noet:sr:cino=>s,f0,{0,g0,(0,:0,t0,+0,=s
+// Local Variables:
+// mode: C++
+// tab-width: 8
+// indent-tabs-mode: nil
+// c-basic-offset: 8
+// End:
@@ -147,9 +147,13 @@ namespace LinBox
 			CERTIFY = true, DONT_CERTIFY = false
 		};
 
-		/** Linear-time pivoting or not for eliminations */
+		/** Linear-time pivoting or not for eliminations.
+		 * PIVOT_STRUCTURED runs a StructuredElimination pass
+		 * before linear pivoting, PIVOT_PARALLEL eliminates
+		 * batches of independent pivots in parallel.
+		 */
 		enum PivotStrategy {
-			PIVOT_LINEAR, PIVOT_NONE
+			PIVOT_LINEAR, PIVOT_NONE, PIVOT_STRUCTURED, PIVOT_PARALLEL
 		};
 
 		Specifier ( ) :
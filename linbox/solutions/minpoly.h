@@ -28,6 +28,7 @@
 #include <string>
 #include "linbox/linbox-config.h"
 #include "linbox/solutions/methods.h"
+#include "linbox/solutions/hybrid-cost-model.h"
 #include "linbox/util/commentator.h"
 
 #include "linbox/blackbox/squarize.h"
@@ -106,8 +107,10 @@ namespace LinBox
 			     const RingCategories::ModularTag & tag,
 			     const Method::Hybrid             & M)
 	{
-		// not yet a hybrid
-		return minpoly(P, A, tag, Method::Blackbox(M));
+		if (hybridDecision(A, HybridCostModel::MINPOLY).choice == HybridDecision::BLACKBOX)
+			return minpoly(P, A, tag, Method::Blackbox(M));
+		else
+			return minpoly(P, A, tag, Method::Elimination(M));
 	}
 
 	//! @internal The minpoly with Hybrid Method on BlasMatrix
@@ -49,6 +49,7 @@
 #include "linbox/vector/vector-traits.h"
 #include "linbox/solutions/trace.h"
 #include "linbox/solutions/methods.h"
+#include "linbox/solutions/hybrid-cost-model.h"
 
 
 #include "linbox/util/debug.h"
@@ -34,6 +34,7 @@
 #include "linbox/field/field-traits.h"
 
 #include <givaro/extension.h>
+#include <utility>
 
 // Namespace in which all LinBox library code resides
 namespace LinBox
@@ -60,9 +61,8 @@ namespace LinBox
 				    const Blackbox                   &A,
 				    const RingCategories::ModularTag &tag,
 				    const Method::Hybrid             &m)
-	{ // this should become a BB/Blas hybrid in the style of Duran/Saunders/Wan.
-		//! @bug choose (benchmark) better cuttoff (size, nbnz, sparse rep)
-		if (useBB(A)) {
+	{
+		if (hybridDecision(A, HybridCostModel::RANK).choice == HybridDecision::BLACKBOX) {
 			return rank(r, A, tag, Method::Blackbox(m ));
 		}
 		else {
@@ -434,10 +434,17 @@ namespace LinBox
 				    const RingCategories::ModularTag   &tag,
 				    const Method::BlasElimination      &M)
 	{
+		return rankBlas(r, A, A.field(), M);
+	}
+
+	template <class Blackbox, class Field>
+	inline unsigned long &rankBlas (unsigned long                      &r,
+					const Blackbox                     &A,
+					const Field                        &F,
+					const Method::BlasElimination      &M)
+	{
 
 		commentator().start ("Blas Rank", "blasrank");
-		typedef typename Blackbox::Field Field;
-		const Field F = A.field();
 		integer a, b; F.characteristic(a); F.cardinality(b);
 		linbox_check( a == b );
 		linbox_check( a < LinBox::BlasBound);
@@ -449,6 +456,64 @@ namespace LinBox
 	}
 
 
+	/*! over \f$ \mathbf{F}_2 \f$ a matrix with \c getEntry is packed and
+	 * eliminated by the method of four Russians. This is reached from
+	 * BlasElimination, and from Elimination or Hybrid (when the cost model
+	 * chooses elimination) on any matrix but a SparseMatrix, which goes to
+	 * the sparse elimination.
+	 */
+	template <class Blackbox>
+	inline auto rankBlasGF2 (unsigned long                      &r,
+				 const Blackbox                     &A,
+				 const GF2                          &F,
+				 const Method::BlasElimination      &M,
+				 int)
+	-> decltype(A.getEntry(std::declval<GF2::Element&>(), size_t(0), size_t(0)), std::declval<unsigned long&>())
+	{
+		commentator().start ("M4RI Rank", "m4rirank");
+		PackedGF2Matrix B(A);
+		MatrixDomain<GF2> MD(F);
+		r = MD.rankin(B);
+		commentator().stop ("done", NULL, "m4rirank");
+		return r;
+	}
+
+	/// the other blackboxes over \f$ \mathbf{F}_2 \f$ take the generic dense path.
+	template <class Blackbox>
+	inline unsigned long &rankBlasGF2 (unsigned long                      &r,
+					   const Blackbox                     &A,
+					   const GF2                          &F,
+					   const Method::BlasElimination      &M,
+					   long)
+	{
+		return rankBlas<Blackbox,GF2>(r, A, F, M);
+	}
+
+	template <class Blackbox>
+	inline unsigned long &rankBlas (unsigned long                      &r,
+					const Blackbox                     &A,
+					const GF2                          &F,
+					const Method::BlasElimination      &M)
+	{
+		return rankBlasGF2(r, A, F, M, 0);
+	}
+
+	/// a packed dense matrix over \f$ \mathbf{F}_2 \f$ is always eliminated.
+	inline unsigned long &rank (unsigned long                      &r,
+				    const PackedGF2Matrix              &A,
+				    const RingCategories::ModularTag   &tag,
+				    const Method::Hybrid               &M)
+	{
+		return rank(r, A, tag, Method::BlasElimination(M));
+	}
+
+	inline unsigned long &rank (unsigned long                      &r,
+				    const PackedGF2Matrix              &A,
+				    const RingCategories::ModularTag   &tag,
+				    const Method::Elimination          &M)
+	{
+		return rank(r, A, tag, Method::BlasElimination(M));
+	}
 
 	template <class Blackbox, class MyMethod>
 	inline unsigned long &rank (unsigned long                     &r,
@@ -622,6 +687,28 @@ namespace LinBox { /*  rankin */
 		return r;
 	}
 
+	/// A is modified, method of four Russians.
+	inline unsigned long &rankin (unsigned long                     &r,
+				      PackedGF2Matrix                   &A,
+				      const RingCategories::ModularTag  &tag,
+				      const Method::BlasElimination     &M)
+	{
+		commentator().start ("M4RI Rank inplace", "m4rirankin");
+		MatrixDomain<GF2> MD(A.field());
+		r = MD.rankin(A);
+		commentator().stop ("done", NULL, "m4rirankin");
+		return r;
+	}
+
+	/// a packed matrix is dense: the method of four Russians is used.
+	inline unsigned long &rankin (unsigned long                     &r,
+				      PackedGF2Matrix                   &A,
+				      const RingCategories::ModularTag  &tag,
+				      const Method::SparseElimination   &M)
+	{
+		return rankin(r, A, tag, Method::BlasElimination(M));
+	}
+
 	/// A is modified.
 	template <class Field>
 	inline unsigned long &rankin (unsigned long                     &r,
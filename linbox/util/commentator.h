@@ -40,12 +40,17 @@
 #include <deque>
 #include <stack>
 #include <map>
+#include <set>
 #include <list>
 #include <string>
 #include <iostream>
 #include <streambuf>
+#include <sstream>
 #include <fstream>
 #include <cstring>
+#include <atomic>
+#include <mutex>
+#include <thread>
 
 //#include "linbox/util/timer.h"
 #include "givaro/givtimer.h"
@@ -148,6 +153,15 @@ namespace LinBox
 	 *
 	 * The commentator allows very precise control over what gets
 	 * printed. See the Configuration section below.
+	 *
+	 * Each thread has its own activity stack, so start () and stop () may
+	 * be called from parallel code. The thread that constructed the
+	 * commentator owns the brief report. Activities of other threads are
+	 * counted from the top level (the owner's current activity may change
+	 * while they run), go to the detailed report one whole line at a time, and their number and total time are
+	 * summed up at the end of the report. Configuration calls (message
+	 * classes, streams, print parameters) are not thread safe and should
+	 * be done by the owner before the parallel parts.
 	 */
 	class Commentator {
 	public:
@@ -260,6 +274,12 @@ namespace LinBox
 		*/
 		void indent (std::ostream &stream) const;
 
+		/** @internal
+		 * Activity depth of the calling thread, that is the number of
+		 * activities it started and did not stop yet.
+		 */
+		unsigned long depth () const;
+
 		//@} Reporting facilities
 
 
@@ -291,7 +311,7 @@ namespace LinBox
 
 		ActivityState saveActivityState () const
 		{
-		       	return ActivityState (_activities.top ());
+		       	return ActivityState (activities ().top ());
 		}
 
 		/** @internal
@@ -460,7 +480,7 @@ namespace LinBox
 				const char *msg_class,
 				const char *fn = (const char *) 0)
 		{
-		       	return isPrinted (_activities.size (), level, msg_class, fn);
+		       	return isPrinted (depth (), level, msg_class, fn);
 		}
 
 		/** @internal
@@ -576,7 +596,7 @@ namespace LinBox
 		 */
 		bool printed (long msglevel, const char *msgclass)
 		{
-			return isPrinted (_activities.size (), (MessageLevel) msglevel, msgclass);
+			return isPrinted (depth (), (MessageLevel) msglevel, msgclass);
 		}
 
 		//@} Legacy commentator interface
@@ -638,7 +658,41 @@ namespace LinBox
 			Estimator                _estimate;
 		};
 
-		std::stack<Activity *>           _activities;      // Stack of activity structures
+		// Report buffer of one thread: whole lines are written to the
+		// detailed report.
+		class lineStreambuf : public std::stringbuf {
+		public:
+			lineStreambuf (const Commentator *comm) :
+				_comm (comm)
+			{}
+			int sync ();
+			std::atomic<const Commentator *> _comm;
+		};
+
+		// What a thread knows about this commentator
+		struct ThreadState {
+			ThreadState (const Commentator *comm) :
+				_buf (comm), _stream (&_buf)
+			{}
+			~ThreadState ();
+
+			std::stack<Activity *>   _activities;      // Stack of activity structures
+			lineStreambuf            _buf;
+			std::ostream             _stream;
+			std::string              _iteration_str;   // String referring to current iteration -- HACK
+		};
+
+		ThreadState &threadState () const;
+		std::stack<Activity *> &activities () const
+		{
+			return threadState ()._activities;
+		}
+		bool isOwner () const
+		{
+			return std::this_thread::get_id () == _owner;
+		}
+		void writeLine (const std::string &line) const;
+		static std::mutex &registryLock ();
 
 		struct C_str_Less {
 			bool operator() (const char* x, const char * y) const {
@@ -660,7 +714,13 @@ namespace LinBox
 
 		std::ofstream                    _report;
 
-		std::string                      _iteration_str;     // String referring to current iteration -- HACK
+		std::thread::id                  _owner;
+		ThreadState                     *_ownerState;
+		std::atomic<unsigned long>       _threadActivities;    // activities completed by the other threads
+		std::atomic<unsigned long long>  _threadMicroseconds;  // and their total time
+		mutable std::mutex               _reportLock;
+		std::set<ThreadState *>          _states;              // guarded by registryLock ()
+
 
 		// Functions for the brief report
 		virtual void printActivityReport  (Activity &activity);
@@ -93,7 +93,11 @@ namespace LinBox
 		, _estimationMethod (BEST_ESTIMATE), _format (OUTPUT_CONSOLE),
 		_show_timing (true), _show_progress (true), _show_est_time (true)
 		,_last_line_len(0)
+		,_owner (std::this_thread::get_id ()), _ownerState ((ThreadState *) 0)
+		,_threadActivities (0), _threadMicroseconds (0)
 	{
+		registryLock (); // so that it outlives the commentator
+		_ownerState = new ThreadState (this);
 		//registerMessageClass (BRIEF_REPORT,         std::clog, 1, LEVEL_IMPORTANT);
 		registerMessageClass (BRIEF_REPORT,         _report, 1, LEVEL_IMPORTANT);
 		registerMessageClass (PROGRESS_REPORT,      _report);
@@ -111,7 +115,11 @@ namespace LinBox
 		, _estimationMethod (BEST_ESTIMATE), _format (OUTPUT_CONSOLE),
 		_show_timing (true), _show_progress (true), _show_est_time (true)
 		,_last_line_len(0)
+		,_owner (std::this_thread::get_id ()), _ownerState ((ThreadState *) 0)
+		,_threadActivities (0), _threadMicroseconds (0)
 	{
+		registryLock (); // so that it outlives the commentator
+		_ownerState = new ThreadState (this);
 		//registerMessageClass (BRIEF_REPORT,         out, 1, LEVEL_IMPORTANT);
 		registerMessageClass (BRIEF_REPORT,         out, 1, LEVEL_IMPORTANT);
 		registerMessageClass (PROGRESS_REPORT,      out);
@@ -125,31 +133,114 @@ namespace LinBox
 
 	Commentator::~Commentator()
 	{
+		{
+			// threads still alive stop reporting here.
+			std::lock_guard<std::mutex> guard (registryLock ());
+			std::set<ThreadState *>::iterator s;
+			for (s = _states.begin (); s != _states.end (); ++s)
+				(*s)->_buf._comm = (const Commentator *) 0;
+			_states.clear ();
+		}
+		_ownerState->_stream.flush ();
+		if (_threadActivities.load () > 0)
+			_report << "Activities of other threads: " << _threadActivities.load ()
+			<< " (" << (double) _threadMicroseconds.load () * 1e-6 << "s)" << std::endl;
 	    _report << "That's all, Folks!" << std::endl;
 		std::map <const char *, MessageClass *, C_str_Less >::iterator i;
 		for (i = _messageClasses.begin (); i != _messageClasses.end (); ++i)
 			delete i->second;
-		while (!_activities.empty()){
-			delete _activities.top();
-			_activities.pop();
+		delete _ownerState;
+	}
+
+	std::mutex &Commentator::registryLock ()
+	{
+		static std::mutex lock;
+		return lock;
+	}
+
+	// The owner's state belongs to the commentator, the states of the other
+	// threads are deleted at thread exit.
+	Commentator::ThreadState &Commentator::threadState () const
+	{
+		struct States {
+			std::map<const Commentator *, ThreadState *> _map;
+			~States ()
+			{
+				std::map<const Commentator *, ThreadState *>::iterator i;
+				for (i = _map.begin (); i != _map.end (); ++i)
+					delete i->second;
+			}
+		};
+		if (isOwner ())
+			return *_ownerState;
+
+		static thread_local States states;
+
+		ThreadState *&state = states._map[this];
+		if (state != (ThreadState *) 0 && state->_buf._comm.load () == this)
+			return *state;
+
+		// first call from this thread, or a commentator that was
+		// destroyed had the same address.
+		delete state;
+		state = new ThreadState (this);
+		std::lock_guard<std::mutex> guard (registryLock ());
+		const_cast<Commentator *> (this)->_states.insert (state);
+		return *state;
+	}
+
+	Commentator::ThreadState::~ThreadState ()
+	{
+		std::lock_guard<std::mutex> guard (registryLock ());
+		const Commentator *comm = _buf._comm.load ();
+		if (comm != (const Commentator *) 0) {
+			_stream.flush ();
+			const_cast<Commentator *> (comm)->_states.erase (this);
+		}
+		while (!_activities.empty ()) {
+			delete _activities.top ();
+			_activities.pop ();
 		}
 	}
 
+	int Commentator::lineStreambuf::sync ()
+	{
+		const Commentator *comm = _comm.load ();
+		if (comm != (const Commentator *) 0 && !str ().empty ())
+			comm->writeLine (str ());
+		str (std::string ());
+		return 0;
+	}
+
+	void Commentator::writeLine (const std::string &line) const
+	{
+		std::lock_guard<std::mutex> guard (_reportLock);
+		const_cast<std::ofstream &> (_report) << line;
+		const_cast<std::ofstream &> (_report).flush ();
+	}
+
+	unsigned long Commentator::depth () const
+	{
+		return (unsigned long) activities ().size ();
+	}
+
 	void Commentator::start (const char *description, const char *fn, unsigned long len)
 	{
-		if (fn == (const char *) 0 && _activities.size () > 0)
-			fn = _activities.top ()->_fn;
+		std::stack<Activity *> &acts = activities ();
 
-		if (isPrinted (_activities.size () + 1, LEVEL_IMPORTANT, INTERNAL_DESCRIPTION, fn))
+		if (fn == (const char *) 0 && acts.size () > 0)
+			fn = acts.top ()->_fn;
+
+		if (isPrinted (depth () + 1, LEVEL_IMPORTANT, INTERNAL_DESCRIPTION, fn))
 			report (LEVEL_IMPORTANT, INTERNAL_DESCRIPTION) //<< "Starting activity: "
 			<< description << std::endl;
 
 		Activity *new_act = new Activity (description, fn, len);
 
-		if (isPrinted (_activities.size (), LEVEL_IMPORTANT, BRIEF_REPORT, fn))
+		if (isOwner () && isPrinted (depth (), LEVEL_IMPORTANT, BRIEF_REPORT, fn))
 			printActivityReport (*new_act);
 
-		_activities.push (new_act);
+		acts.push (new_act);
 
 		new_act->_timer.start ();
 	}
@@ -165,8 +256,9 @@ namespace LinBox
 
 		str << "Iteration " << iter << std::ends;
 
-		_iteration_str = str.str ();
-		start (_iteration_str.c_str (), (const char *) 0, len);
+		std::string &iteration_str = threadState ()._iteration_str;
+		iteration_str = str.str ();
+		start (iteration_str.c_str (), (const char *) 0, len);
 	}
 
 	void Commentator::stop (const char *msg, const char *long_msg, const char *fn)
@@ -174,13 +266,15 @@ namespace LinBox
 		double realtime; //, usertime, systime;
 		Activity *top_act;
 
-		linbox_check (_activities.top () != (Activity *) 0);
+		std::stack<Activity *> &acts = activities ();
+
+		linbox_check (acts.top () != (Activity *) 0);
 		linbox_check (msg != (const char *) 0);
 
 		if (long_msg == (const char *) 0)
 			long_msg = msg;
 
-		top_act = _activities.top ();
+		top_act = acts.top ();
 
 		top_act->_timer.stop ();
 
@@ -193,7 +287,7 @@ namespace LinBox
 		//if (systime < 0) systime = 0;
 
 		if (fn != (const char *) 0 &&
-		    _activities.size () > 0 &&
+		    acts.size () > 0 &&
 		    top_act->_fn != (const char *) 0 &&
 		    strcmp (fn, top_act->_fn) != 0)
 		{
@@ -203,14 +297,19 @@ namespace LinBox
 
 		fn = top_act->_fn;
 
-		_activities.pop ();
+		acts.pop ();
+
+		if (!isOwner ()) {
+			++_threadActivities;
+			_threadMicroseconds += (unsigned long long) (realtime * 1e6);
+		}
 
-		if (isPrinted (_activities.size (), LEVEL_IMPORTANT, BRIEF_REPORT, fn))
+		if (isOwner () && isPrinted (depth (), LEVEL_IMPORTANT, BRIEF_REPORT, fn))
 		{
 			finishActivityReport (*top_act, msg);
 		}
 
-		if (isPrinted (_activities.size () + 1, LEVEL_IMPORTANT, INTERNAL_DESCRIPTION, fn)) {
+		if (isPrinted (depth () + 1, LEVEL_IMPORTANT, INTERNAL_DESCRIPTION, fn)) {
 			std::ostream &output = report (LEVEL_IMPORTANT, INTERNAL_DESCRIPTION);
 			output.precision (4);
 			output << "Finished activity (rea: " << realtime << "s, cpu: ";
@@ -219,7 +318,7 @@ namespace LinBox
 			//output.precision (4);
 			//output << systime << "s): " << long_msg << std::endl;
 		}
-		else if (isPrinted (_activities.size (), LEVEL_IMPORTANT, INTERNAL_DESCRIPTION, fn)) {
+		else if (isPrinted (depth (), LEVEL_IMPORTANT, INTERNAL_DESCRIPTION, fn)) {
 			std::ostream &output = report (LEVEL_IMPORTANT, INTERNAL_DESCRIPTION);
 			output.precision (4);
 			output << "Completed activity: " << top_act->_desc << " (r: " << realtime << "s, u: ";
@@ -234,9 +333,9 @@ namespace LinBox
 
 	void Commentator::progress (long k, long len)
 	{
-		linbox_check (_activities.top () != (Activity *) 0);
+		linbox_check (activities ().top () != (Activity *) 0);
 
-		Activity *act = _activities.top ();
+		Activity *act = activities ().top ();
 		Givaro::RealTimer tmp = act->_timer;
 		act->_timer.stop ();
 
@@ -257,7 +356,7 @@ namespace LinBox
 		rep << "Progress: " << act->_progress << " out of " << act->_len
 		<< " (" << act->_timer.time () << "s elapsed)" << std::endl;
 
-		if (_show_progress && isPrinted (_activities.size () - 1, LEVEL_IMPORTANT, BRIEF_REPORT, act->_fn))
+		if (_show_progress && isOwner () && isPrinted (depth () - 1, LEVEL_IMPORTANT, BRIEF_REPORT, act->_fn))
 			updateActivityReport (*act);
 		act->_timer = tmp;
 	}
@@ -266,41 +365,43 @@ namespace LinBox
 	{
 		linbox_check (msg_class != (const char *) 0);
 
-	    _report << "$$(" << _activities.size () << ", " << level << ", " << msg_class << ")";
+		std::ostream &out = threadState ()._stream;
+	    out << "$$(" << depth () << ", " << level << ", " << msg_class << ")";
 #if 0
-	    if (!isPrinted (_activities.size (), level, msg_class,
-				    (_activities.size () > 0) ? _activities.top ()->_fn : (const char *) 0))
+	    if (!isPrinted (depth (), level, msg_class,
+				    (activities ().size () > 0) ? activities ().top ()->_fn : (const char *) 0))
 		    return cnull;
 
 	    MessageClass &messageClass = getMessageClass (msg_class);
 
 	    return messageClass._stream;
 #endif
-		return _report;
+		return out;
 	}
 
 	void Commentator::indent (std::ostream &stream) const
 	{
 		unsigned int i;
 
-		for (i = 0; i < _activities.size (); ++i)
+		for (i = 0; i < depth (); ++i)
 			stream << "  ";
 	}
 
 	void Commentator::restoreActivityState (ActivityState state)
 	{
 		std::stack<Activity *> backup;
+		std::stack<Activity *> &acts = activities ();
 
-		while (!_activities.empty () && _activities.top () != state._act) {
-			backup.push (_activities.top ());
-			_activities.pop ();
+		while (!acts.empty () && acts.top () != state._act) {
+			backup.push (acts.top ());
+			acts.pop ();
 		}
 
-		if (_activities.empty ()) {
+		if (acts.empty ()) {
 			// Uh oh -- the state didn't give a valid activity
 
 			while (!backup.empty ()) {
-				_activities.push (backup.top ());
+				acts.push (backup.top ());
 				backup.pop ();
 			}
 		}
@@ -427,7 +528,7 @@ namespace LinBox
 		if (_format == OUTPUT_CONSOLE) {
 			messageClass._stream << activity._desc << "...";
 
-			if (messageClass.isPrinted (_activities.size () + 1, LEVEL_IMPORTANT, activity._fn))
+			if (messageClass.isPrinted (depth () + 1, LEVEL_IMPORTANT, activity._fn))
 				messageClass._stream << std::endl;
 			else if (_show_progress && activity._len > 0) {
 				messageClass._stream << "  0%";
@@ -440,7 +541,7 @@ namespace LinBox
 		}
 		else if (_format == OUTPUT_PIPE &&
 			 (((_show_progress || _show_est_time) && activity._len > 0) ||
-			  messageClass.isPrinted (_activities.size () + 1, LEVEL_IMPORTANT, activity._fn)))
+			  messageClass.isPrinted (depth () + 1, LEVEL_IMPORTANT, activity._fn)))
 		{
 			messageClass._stream << activity._desc << "...";
 
@@ -456,7 +557,7 @@ namespace LinBox
 		double percent = (double) activity._progress / (double) activity._len * 100.0;
 
 		if (_format == OUTPUT_CONSOLE) {
-			if (!messageClass.isPrinted (_activities.size (), LEVEL_IMPORTANT, activity._fn)) {
+			if (!messageClass.isPrinted (depth (), LEVEL_IMPORTANT, activity._fn)) {
 				if (_show_progress) {
 			unsigned int i,  old_len;
 					for (i = 0; i < _last_line_len; ++i)
@@ -470,7 +571,7 @@ namespace LinBox
 						messageClass._stream << ' ';
 				}
 			}
-			else if (messageClass.isPrinted (_activities.size () - 1, LEVEL_UNIMPORTANT, activity._fn)) {
+			else if (messageClass.isPrinted (depth () - 1, LEVEL_UNIMPORTANT, activity._fn)) {
 #if 0
 				if (_show_est_time)
 					messageClass._stream << activity._estimate.front ()._time
@@ -504,7 +605,7 @@ namespace LinBox
 		unsigned int i;
 
 		if (_format == OUTPUT_CONSOLE) {
-			if (!messageClass.isPrinted (_activities.size () + 1, LEVEL_UNIMPORTANT, activity._fn)) {
+			if (!messageClass.isPrinted (depth () + 1, LEVEL_UNIMPORTANT, activity._fn)) {
 				if (_show_progress)
 					for (i = 0; i < _last_line_len; ++i)
 						messageClass._stream << '\b';
@@ -516,8 +617,8 @@ namespace LinBox
 				else
 					messageClass._stream << std::endl;
 			}
-			else if (messageClass.isPrinted (_activities.size (), LEVEL_UNIMPORTANT, activity._fn)) {
-				for (i = 0; i < _activities.size (); ++i)
+			else if (messageClass.isPrinted (depth (), LEVEL_UNIMPORTANT, activity._fn)) {
+				for (i = 0; i < depth (); ++i)
 					messageClass._stream << "  ";
 
 				messageClass._stream << msg;
@@ -532,11 +633,11 @@ namespace LinBox
 			messageClass._smart_streambuf.stream ().flush ();
 		}
 		else if (_format == OUTPUT_PIPE) {
-			for (i = 0; i < _activities.size (); ++i)
+			for (i = 0; i < depth (); ++i)
 				messageClass._stream << "  ";
 
 			if (((_show_progress || _show_est_time) && activity._len > 0) ||
-			    messageClass.isPrinted (_activities.size () + 1, LEVEL_IMPORTANT, activity._fn))
+			    messageClass.isPrinted (depth () + 1, LEVEL_IMPORTANT, activity._fn))
 				messageClass._stream << "Done: " << msg << std::endl;
 			else
 				messageClass._stream << activity._desc << ": " << msg << std::endl;
@@ -613,13 +714,14 @@ namespace LinBox
 
 	bool MessageClass::isPrinted (unsigned long depth, unsigned long level, const char *fn)
 	{
-		return
-		checkConfig (_configuration[""], depth, level)
-		||
-		(	fn != (const char *) 0
-			&&
-			checkConfig (_configuration[fn], depth, level)
-		);
+		// find, not operator[], as this is called concurrently.
+		Configuration::iterator c = _configuration.find ("");
+		if (c != _configuration.end () && checkConfig (c->second, depth, level))
+			return true;
+		if (fn == (const char *) 0)
+			return false;
+		c = _configuration.find (fn);
+		return c != _configuration.end () && checkConfig (c->second, depth, level);
 #if 0
 
 		if (checkConfig (_configuration[""], depth, level))
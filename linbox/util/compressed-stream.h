@@ -0,0 +1,419 @@
+/* linbox/util/compressed-stream.h
+ * Copyright (C) the LinBox group
+ *
+ * ========LICENCE========
+ * This file is part of the library LinBox.
+ *
+ * LinBox is free software: you can redistribute it and/or modify
+ * it under the terms of the  GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ * ========LICENCE========
+ *.
+ */
+
+/*! @file util/compressed-stream.h
+ * @ingroup util
+ * @brief Input file stream reading gzip and zstd files transparently.
+ *
+ * The compression is recognised by the first bytes of the file.  The file
+ * is decompressed by a thread of its own into a few blocks, consumed by
+ * the reader while the next ones are produced.
+ * gzip needs zlib (__LINBOX_HAVE_ZLIB), zstd needs libzstd
+ * (__LINBOX_HAVE_ZSTD).
+ */
+
+#ifndef __LINBOX_util_compressed_stream_H
+#define __LINBOX_util_compressed_stream_H
+
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <fstream>
+#include <istream>
+#include <mutex>
+#include <streambuf>
+#include <thread>
+#include <vector>
+
+#include "linbox/linbox-config.h"
+
+#ifdef __LINBOX_HAVE_ZLIB
+#include <zlib.h>
+#endif
+#ifdef __LINBOX_HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+#ifndef __LINBOX_DECOMPRESS_BLOCK__
+/// Bytes of a decompressed block.
+#define __LINBOX_DECOMPRESS_BLOCK__ (size_t(1) << 18)
+#endif
+
+#ifndef __LINBOX_DECOMPRESS_BLOCKS__
+/// Decompressed blocks ready ahead of the reader.
+#define __LINBOX_DECOMPRESS_BLOCKS__ 4
+#endif
+
+namespace LinBox
+{
+	/// Compression of a file.
+	enum FileCompression {
+		COMPRESSION_NONE,
+		COMPRESSION_GZIP,
+		COMPRESSION_ZSTD
+	};
+
+	/// The compression announced by the first (at most 4) bytes of a file.
+	inline FileCompression fileCompression (const unsigned char *p, size_t n)
+	{
+		if (n >= 2 && p[0] == 0x1f && p[1] == 0x8b)
+			return COMPRESSION_GZIP;
+		if (n >= 4 && p[0] == 0x28 && p[1] == 0xb5 && p[2] == 0x2f && p[3] == 0xfd)
+			return COMPRESSION_ZSTD;
+		return COMPRESSION_NONE;
+	}
+
+	/// true if this build can read files compressed by \p c.
+	inline bool compressionSupported (FileCompression c)
+	{
+		switch (c) {
+		case COMPRESSION_NONE :
+			return true;
+		case COMPRESSION_GZIP :
+#ifdef __LINBOX_HAVE_ZLIB
+			return true;
+#else
+			return false;
+#endif
+		case COMPRESSION_ZSTD :
+#ifdef __LINBOX_HAVE_ZSTD
+			return true;
+#else
+			return false;
+#endif
+		}
+		return false;
+	}
+
+	/** Stream buffer on a compressed file.
+	 *
+	 * A producer thread reads and decompresses the file into blocks of
+	 * __LINBOX_DECOMPRESS_BLOCK__ bytes, at most
+	 * __LINBOX_DECOMPRESS_BLOCKS__ of them waiting to be read; the
+	 * buffers go back to the producer once read.
+	 * The thread is not taken from the thread pool: it blocks on the
+	 * file and on the reader, which could be a task of the pool.
+	 * Concatenated gzip (or zstd) members are read in sequence.
+	 * A corrupted file ends the stream early, with error() set.
+	 \ingroup util
+	 */
+	class DecompressingStreambuf : public std::streambuf {
+	public:
+		DecompressingStreambuf () :
+			_file(NULL), _compression(COMPRESSION_NONE), _done(false), _stop(false), _error(false)
+		{}
+
+		~DecompressingStreambuf () { close(); }
+
+		/// false if the file cannot be opened or its compression is not supported.
+		bool open (const char *filename)
+		{
+			close();
+			_file = std::fopen(filename, "rb");
+			if (_file == NULL)
+				return false;
+			unsigned char magic[4];
+			const size_t n = std::fread(magic, 1, 4, _file);
+			_compression = fileCompression(magic, n);
+			if (_compression == COMPRESSION_NONE || ! compressionSupported(_compression)) {
+				close();
+				return false;
+			}
+			std::rewind(_file);
+			_done = _stop = _error = false;
+			_thread = std::thread(&DecompressingStreambuf::produce, this);
+			return true;
+		}
+
+		void close ()
+		{
+			if (_thread.joinable()) {
+				{
+					std::lock_guard<std::mutex> lock(_mutex);
+					_stop = true;
+				}
+				_cond.notify_all();
+				_thread.join();
+			}
+			if (_file)
+				std::fclose(_file);
+			_file = NULL;
+			_full.clear();
+			_current.clear();
+			setg(NULL, NULL, NULL);
+		}
+
+		FileCompression compression () const { return _compression; }
+
+		/// true if the file was found corrupted.
+		bool error () const
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			return _error;
+		}
+
+	protected:
+		int_type underflow ()
+		{
+			if (gptr() < egptr())
+				return traits_type::to_int_type(*gptr());
+			std::unique_lock<std::mutex> lock(_mutex);
+			if (_current.capacity())
+				_free.push_back(std::move(_current));
+			_cond.wait(lock, [this] { return ! _full.empty() || _done; });
+			if (_full.empty()) {
+				_current.clear();
+				setg(NULL, NULL, NULL);
+				return traits_type::eof();
+			}
+			_current = std::move(_full.front());
+			_full.pop_front();
+			lock.unlock();
+			_cond.notify_all();
+			setg(_current.data(), _current.data(), _current.data() + _current.size());
+			return traits_type::to_int_type(*gptr());
+		}
+
+	private:
+		DecompressingStreambuf (const DecompressingStreambuf &);
+		DecompressingStreambuf &operator= (const DecompressingStreambuf &);
+
+		/// Waits for room in the queue, false when stopped.
+		bool takeBlock (std::vector<char> &out)
+		{
+			std::unique_lock<std::mutex> lock(_mutex);
+			_cond.wait(lock, [this] { return _stop || _full.size() < __LINBOX_DECOMPRESS_BLOCKS__; });
+			if (_stop)
+				return false;
+			if (! _free.empty()) {
+				out = std::move(_free.back());
+				_free.pop_back();
+			}
+			return true;
+		}
+
+		void pushBlock (std::vector<char> &out)
+		{
+			{
+				std::lock_guard<std::mutex> lock(_mutex);
+				_full.push_back(std::move(out));
+			}
+			_cond.notify_all();
+		}
+
+		void finish (bool error)
+		{
+			{
+				std::lock_guard<std::mutex> lock(_mutex);
+				_done  = true;
+				_error = error;
+			}
+			_cond.notify_all();
+		}
+
+		void produce ()
+		{
+			switch (_compression) {
+#ifdef __LINBOX_HAVE_ZLIB
+			case COMPRESSION_GZIP :
+				return produceGzip();
+#endif
+#ifdef __LINBOX_HAVE_ZSTD
+			case COMPRESSION_ZSTD :
+				return produceZstd();
+#endif
+			default :
+				return finish(true);
+			}
+		}
+
+#ifdef __LINBOX_HAVE_ZLIB
+		void produceGzip ()
+		{
+			std::vector<unsigned char> in(__LINBOX_DECOMPRESS_BLOCK__);
+			std::vector<char> out;
+			z_stream z;
+			z.zalloc = Z_NULL;
+			z.zfree = Z_NULL;
+			z.opaque = Z_NULL;
+			z.next_in = Z_NULL;
+			z.avail_in = 0;
+			// 15+32: gzip or zlib header, detected
+			if (inflateInit2(&z, 15 + 32) != Z_OK)
+				return finish(true);
+			bool error = false, end = false;
+			while (! end && takeBlock(out)) {
+				out.resize(__LINBOX_DECOMPRESS_BLOCK__);
+				z.next_out = (Bytef *)out.data();
+				z.avail_out = (uInt)out.size();
+				while (z.avail_out > 0) {
+					if (z.avail_in == 0) {
+						z.avail_in = (uInt)std::fread(in.data(), 1, in.size(), _file);
+						z.next_in = in.data();
+						if (z.avail_in == 0) {
+							// the stream ended in the middle of a member
+							error = (z.total_in > 0);
+							end = true;
+							break;
+						}
+					}
+					const int r = inflate(&z, Z_NO_FLUSH);
+					if (r == Z_STREAM_END) {
+						// next member, if any
+						if (z.avail_in == 0 && std::feof(_file)) {
+							end = true;
+							break;
+						}
+						inflateReset(&z);
+					}
+					else if (r != Z_OK && r != Z_BUF_ERROR) {
+						error = end = true;
+						break;
+					}
+				}
+				out.resize(out.size() - z.avail_out);
+				if (out.size())
+					pushBlock(out);
+			}
+			inflateEnd(&z);
+			finish(error);
+		}
+#endif
+
+#ifdef __LINBOX_HAVE_ZSTD
+		void produceZstd ()
+		{
+			std::vector<char> in(ZSTD_DStreamInSize());
+			std::vector<char> out;
+			ZSTD_DStream *z = ZSTD_createDStream();
+			if (z == NULL || ZSTD_isError(ZSTD_initDStream(z)))
+				return finish(true);
+			ZSTD_inBuffer zin = { in.data(), 0, 0 };
+			size_t last = 0;
+			bool error = false, end = false;
+			while (! end && takeBlock(out)) {
+				out.resize(__LINBOX_DECOMPRESS_BLOCK__);
+				ZSTD_outBuffer zout = { out.data(), out.size(), 0 };
+				while (zout.pos < zout.size) {
+					if (zin.pos == zin.size) {
+						zin.size = std::fread(in.data(), 1, in.size(), _file);
+						zin.pos = 0;
+						if (zin.size == 0) {
+							// 0 once a frame is complete
+							error = (last != 0);
+							end = true;
+							break;
+						}
+					}
+					last = ZSTD_decompressStream(z, &zout, &zin);
+					if (ZSTD_isError(last)) {
+						error = end = true;
+						break;
+					}
+				}
+				out.resize(zout.pos);
+				if (out.size())
+					pushBlock(out);
+			}
+			ZSTD_freeDStream(z);
+			finish(error);
+		}
+#endif
+
+		std::FILE                     *_file;
+		FileCompression                _compression;
+		std::thread                    _thread;
+		mutable std::mutex             _mutex;
+		std::condition_variable        _cond;
+		std::deque<std::vector<char> > _full;
+		std::vector<std::vector<char> > _free;
+		std::vector<char>              _current;
+		bool                           _done, _stop, _error;
+	};
+
+	/** Input file stream, decompressed if the file is compressed.
+	 *
+	 * A plain file is read as by std::ifstream.  The stream fails to open
+	 * if the file cannot be read or if its compression is not supported
+	 * by this build.
+	 * @code
+	 * CompressedInputStream in("matrix.sms.gz");
+	 * MatrixStream<Field> ms(F, in);
+	 * @endcode
+	 \ingroup util
+	 */
+	class CompressedInputStream : public std::istream {
+	public:
+		CompressedInputStream () : std::istream(NULL), _compression(COMPRESSION_NONE) {}
+
+		explicit CompressedInputStream (const char *filename) :
+			std::istream(NULL), _compression(COMPRESSION_NONE)
+		{
+			open(filename);
+		}
+
+		void open (const char *filename)
+		{
+			_compression = COMPRESSION_NONE;
+			{
+				std::ifstream probe(filename, std::ios::binary);
+				unsigned char magic[4];
+				probe.read((char *)magic, 4);
+				_compression = fileCompression(magic, (size_t)probe.gcount());
+			}
+			if (_compression == COMPRESSION_NONE) {
+				_plain.close();
+				if (_plain.open(filename, std::ios::in | std::ios::binary))
+					rdbuf(&_plain);
+				else
+					setstate(std::ios::failbit);
+			}
+			else if (_zipped.open(filename))
+				rdbuf(&_zipped);
+			else
+				setstate(std::ios::failbit);
+		}
+
+		FileCompression compression () const { return _compression; }
+		bool isCompressed () const { return _compression != COMPRESSION_NONE; }
+
+		/// true if the compressed data was found corrupted.
+		bool corrupted () const { return isCompressed() && _zipped.error(); }
+
+	private:
+		FileCompression        _compression;
+		std::filebuf           _plain;
+		DecompressingStreambuf _zipped;
+	};
+
+} // namespace LinBox
+
+#endif // __LINBOX_util_compressed_stream_H
+
+// vim:sts=8:sw=8:ts=8:noet:sr:cino=>s,f0,{0,g0,(0,:0,t0,+0,=s
+// Local Variables:
+// mode: C++
+// tab-width: 8
+// indent-tabs-mode: nil
+// c-basic-offset: 8
+// End:
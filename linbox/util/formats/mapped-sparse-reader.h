@@ -0,0 +1,482 @@
+/* Copyright (C) the LinBox group
+ *
+ * ========LICENCE========
+ * This file is part of the library LinBox.
+ *
+ * LinBox is free software: you can redistribute it and/or modify
+ * it under the terms of the  GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ * ========LICENCE========
+ */
+
+/*! @file util/formats/mapped-sparse-reader.h
+ * @brief Parallel loader of sms and MatrixMarket coordinate files
+ *
+ * The file is mapped in memory and cut, at line breaks, into chunks that
+ * are parsed in parallel.  A first pass counts the entries of each row, a
+ * second one stores them at their place in a CSR or ELL matrix, whose
+ * rows are then sorted by column.  Other formats go through MatrixStream.
+ */
+
+#ifndef __LINBOX_util_formats_mapped_sparse_reader_H
+#define __LINBOX_util_formats_mapped_sparse_reader_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "linbox/util/mapped-file.h"
+#include "linbox/util/matrix-stream.h"
+#include "linbox/util/thread-pool.h"
+#include "linbox/matrix/sparse-matrix.h"
+
+#ifndef __LINBOX_MAPPED_READER_CHUNK__
+/// Smallest number of bytes parsed by a thread.
+#define __LINBOX_MAPPED_READER_CHUNK__ (size_t(1) << 20)
+#endif
+
+namespace LinBox
+{
+
+	/** Fast loader for the sparse matrix files.
+	 *
+	 * The format is recognised by MatrixStream, with the same errors
+	 * thrown; sms and MatrixMarket coordinate files are then read from
+	 * the mapped file, with integer entries scanned without the streams
+	 * (other entries are given to Field::read).
+	 * Compressed files are read by MatrixStream, decompressed on the fly.
+	 * The dimensions are the ones of the header.
+	 * A position given twice is stored twice in its row, so that the
+	 * matrix applies as the sum of both entries; the sparse matrices
+	 * read through MatrixStream keep the last one only.
+	 * Errors are thrown as by the MatrixStream constructors of the
+	 * sparse matrices, after a call to reportError.
+	 \ingroup util
+	 */
+	template <class Field>
+	class MappedSparseReader {
+	public:
+		typedef typename Field::Element Element;
+		typedef SparseMatrix<Field, SparseMatrixFormat::CSR> CSRMatrix;
+		typedef SparseMatrix<Field, SparseMatrixFormat::ELL> ELLMatrix;
+
+		/** Recognises the format of \p filename.
+		 * @throws MatrixStreamError as MatrixStream does.
+		 */
+		MappedSparseReader (const Field &F, const char *filename) :
+			_field(F), _filename(filename), _data(NULL), _size(0)
+			, _mapped(false), _sms(false), _pattern(false), _symmetric(false)
+			, _m(0), _n(0), _nnz(0), _error(GOOD), _line(0)
+		{
+			bool compressed;
+			{
+				CompressedInputStream in(filename);
+				MatrixStream<Field> ms(F, in);
+				_name  = ms.getFormat();
+				_short = ms.getShortFormat();
+				compressed = in.isCompressed();
+			}
+			if (compressed || (_short != "sms" && _short != "mm"))
+				return;
+			if (_file.open(filename)) {
+				_data = _file.data();
+				_size = _file.size();
+				readHeader();
+			}
+		}
+
+		/// true if the file is read from memory, false if it goes through MatrixStream.
+		bool isMapped () const { return _mapped; }
+
+		const char *getFormat () const { return _name.c_str(); }
+		const char *getShortFormat () const { return _short.c_str(); }
+		const Field &field () const { return _field; }
+
+		size_t rowdim () const { return _m; }
+		size_t coldim () const { return _n; }
+
+		/// The error met, GOOD or END_OF_MATRIX if none.
+		MatrixStreamError getError () const { return _error; }
+
+		/// The line on which the error occurred.
+		int getLineNumber () const { return _line; }
+
+		/// Report the error to the error stream and return it.
+		MatrixStreamError reportError (const char *func, int line) const
+		{
+			writeMatrixStreamError(std::cerr, _error, func, line, _line, getFormat());
+			return _error;
+		}
+
+		/// Read the matrix into \p A.
+		void read (CSRMatrix &A)
+		{
+			if (_mapped) fill(A); else streamRead(A);
+		}
+
+		/// Read the matrix into \p A, built empty from the field.
+		void read (ELLMatrix &A)
+		{
+			if (_mapped) fill(A); else streamRead(A);
+		}
+
+	private:
+		// [beg,end) is parsed, up to limit triples, first ones excluded
+		struct Chunk {
+			const char       *beg, *end;
+			size_t            triples, counted, limit;
+			MatrixStreamError error;
+			const char       *errpos;
+		};
+
+		static bool isBlank (char c)
+		{
+			return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\v' || c == '\f';
+		}
+
+		static const char *skipBlank (const char *p, const char *e)
+		{
+			while (p < e && isBlank(*p)) ++p;
+			return p;
+		}
+
+		static const char *nextLine (const char *p, const char *e)
+		{
+			while (p < e && *p != '\n') ++p;
+			return (p < e) ? p+1 : e;
+		}
+
+		// decimal index, NULL if the token is not one
+		static const char *scanIndex (const char *p, const char *e, size_t &x)
+		{
+			const char *q = p;
+			x = 0;
+			while (q < e && *q >= '0' && *q <= '9' && q-p < 19)
+				x = 10*x + (size_t)(*q++ - '0');
+			if (q == p || (q < e && ! isBlank(*q)))
+				return NULL;
+			return q;
+		}
+
+		// integers of at most 18 digits are scanned here, the other
+		// tokens are given to the field.
+		const char *scanValue (const char *p, const char *e, Element &x) const
+		{
+			const char *q = p;
+			bool neg = false;
+			if (q < e && (*q == '-' || *q == '+'))
+				neg = (*q++ == '-');
+			const char *d = q;
+			int64_t v = 0;
+			while (q < e && *q >= '0' && *q <= '9' && q-d < 18)
+				v = 10*v + (*q++ - '0');
+			if (q > d && (q == e || isBlank(*q))) {
+				_field.init(x, neg ? -v : v);
+				return q;
+			}
+			q = p;
+			while (q < e && ! isBlank(*q)) ++q;
+			std::istringstream is(std::string(p, q));
+			_field.read(is, x);
+			if (is.fail() || is.peek() != std::char_traits<char>::eof())
+				return NULL;
+			return q;
+		}
+
+		int lineOf (const char *p) const
+		{
+			return 1 + (int)std::count(_data, p, '\n');
+		}
+
+		void readHeader ()
+		{
+			const char *e = _data + _size;
+			const char *p = skipBlank(_data, e);
+			while (p < e && *p == '#')
+				p = skipBlank(nextLine(p, e), e);
+			const char *first = p;
+			p = nextLine(p, e);
+
+			if (_short == "sms") {
+				const char *q = scanIndex(skipBlank(first, e), e, _m);
+				if (q) q = scanIndex(skipBlank(q, e), e, _n);
+				if (! q) return;
+				_sms = true;
+			}
+			else {
+				std::istringstream hs(std::string(first, p));
+				std::string s[5];
+				for (size_t k = 0 ; k < 5 ; ++k)
+					hs >> s[k];
+				if (! equalCaseInsensitive(s[2], "coordinate"))
+					return;
+				_pattern   = equalCaseInsensitive(s[3], "pattern");
+				_symmetric = equalCaseInsensitive(s[4], "symmetric");
+				p = skipBlank(p, e);
+				while (p < e && *p == '%')
+					p = skipBlank(nextLine(p, e), e);
+				const char *q = scanIndex(p, e, _m);
+				if (q) q = scanIndex(skipBlank(q, e), e, _n);
+				if (q) q = scanIndex(skipBlank(q, e), e, _nnz);
+				if (! q || (_symmetric && _m != _n) || _m < 1 || _n < 1 || _nnz > _m*_n) {
+					_error = (p == e) ? END_OF_FILE : BAD_FORMAT;
+					_line  = lineOf(p);
+				}
+				else
+					p = q;
+			}
+			_body = p;
+			_mapped = true;
+		}
+
+		// The triples of C.  f is called on the nonzero ones, from the
+		// first-th one on.
+		template <class Func>
+		void scan (Chunk &C, size_t first, Func f) const
+		{
+			const char *p = C.beg;
+			size_t i, j;
+			Element x;
+			_field.init(x);
+			C.triples = 0;
+			C.error = GOOD;
+			while (C.triples < C.limit) {
+				const char *t = skipBlank(p, C.end);
+				if (t == C.end)
+					return;
+				p = scanIndex(t, C.end, i);
+				if (p) p = skipBlank(p, C.end);
+				if (p && p == C.end) { C.error = END_OF_FILE; C.errpos = t; return; }
+				if (p) p = scanIndex(p, C.end, j);
+				if (p && ! _pattern) {
+					p = skipBlank(p, C.end);
+					if (p == C.end) { C.error = END_OF_FILE; C.errpos = t; return; }
+					p = scanValue(p, C.end, x);
+				}
+				else if (p)
+					_field.assign(x, _field.one);
+				if (! p) { C.error = BAD_FORMAT; C.errpos = t; return; }
+
+				if (_sms && i == 0 && j == 0) { C.error = END_OF_MATRIX; C.errpos = t; return; }
+				if (i == 0 || j == 0 || i > _m || j > _n) { C.error = BAD_FORMAT; C.errpos = t; return; }
+				if (C.triples++ >= first && ! _field.isZero(x)) {
+					f(i-1, j-1, x);
+					if (_symmetric && i != j)
+						f(j-1, i-1, x);
+				}
+			}
+		}
+
+		// Chunks cut at line breaks
+		void cut (std::vector<Chunk> &chunks, size_t nb) const
+		{
+			const char *e = _data + _size;
+			const size_t len = (size_t)(e - _body);
+			chunks.resize(nb);
+			const char *p = _body;
+			for (size_t c = 0 ; c < nb ; ++c) {
+				chunks[c].beg = p;
+				p = (c+1 == nb) ? e : std::max(p, nextLine(_body + len*(c+1)/nb - 1, e));
+				chunks[c].end = p;
+				chunks[c].limit = std::numeric_limits<size_t>::max();
+			}
+		}
+
+		template <class Matrix>
+		void fill (Matrix &A)
+		{
+			if (_error > END_OF_MATRIX)
+				throw reportError(__func__,__LINE__);
+
+			const size_t len = (size_t)(_data + _size - _body);
+			size_t nb = std::min(4*threadPool().size(), len / __LINBOX_MAPPED_READER_CHUNK__);
+			nb = std::max(nb, (size_t)1);
+
+			std::unique_ptr<std::atomic<size_t>[]> count(new std::atomic<size_t>[_m]);
+			std::vector<Chunk> chunks;
+			size_t used;
+			for (;;) {
+				for (size_t i = 0 ; i < _m ; ++i)
+					count[i].store(0, std::memory_order_relaxed);
+				cut(chunks, nb);
+				// count pass
+				threadPool().parallelFor(0, nb, [&](size_t c) {
+					scan(chunks[c], 0, [&](size_t i, size_t, const Element &) {
+						count[i].fetch_add(1, std::memory_order_relaxed);
+					});
+				});
+				used = last(chunks);
+				if (used <= nb)
+					break;
+				// a triple runs over two chunks
+				nb = 1;
+			}
+			if (_error > END_OF_MATRIX)
+				throw reportError(__func__,__LINE__);
+
+			// the triples after the end of the matrix are uncounted
+			threadPool().parallelFor(used-1, nb, [&](size_t c) {
+				Chunk C = chunks[c];
+				const size_t first = (c+1 == used) ? C.limit : 0;
+				if (first >= C.counted)
+					return;
+				C.limit = C.counted;
+				scan(C, first, [&](size_t i, size_t, const Element &) {
+					count[i].fetch_sub(1, std::memory_order_relaxed);
+				});
+			});
+
+			size_t nnz = 0, maxc = 0;
+			_start.resize(_m+1);
+			_start[0] = 0;
+			for (size_t i = 0 ; i < _m ; ++i) {
+				const size_t ci = count[i].exchange(0, std::memory_order_relaxed);
+				_start[i+1] = _start[i] + ci;
+				maxc = std::max(maxc, ci);
+			}
+			nnz = _start[_m];
+			shape(A, nnz, maxc);
+
+			// fill pass
+			threadPool().parallelFor(0, used, [&](size_t c) {
+				scan(chunks[c], 0, [&](size_t i, size_t j, const Element &x) {
+					place(A, i, count[i].fetch_add(1, std::memory_order_relaxed), j, x);
+				});
+			});
+
+			// rows sorted by column
+			const size_t rc = std::min(_m, 4*threadPool().size());
+			threadPool().parallelFor(0, rc, [&](size_t t) {
+				std::vector<std::pair<size_t, Element> > row;
+				for (size_t i = t*_m/rc ; i < (t+1)*_m/rc ; ++i) {
+					const size_t l = _start[i+1] - _start[i];
+					size_t k = 1;
+					while (k < l && colid(A, i, k-1) <= colid(A, i, k)) ++k;
+					if (k >= l)
+						continue;
+					row.resize(l);
+					for (k = 0 ; k < l ; ++k)
+						row[k] = std::pair<size_t, Element>(colid(A, i, k), data(A, i, k));
+					std::sort(row.begin(), row.end(),
+						  [](const std::pair<size_t, Element> &a, const std::pair<size_t, Element> &b)
+						  { return a.first < b.first; });
+					for (k = 0 ; k < l ; ++k)
+						place(A, i, k, row[k].first, row[k].second);
+				}
+			});
+			A.finalize();
+		}
+
+		// Number of chunks holding the matrix, the last one being cut
+		// by its limit; nb+1 if a triple runs over two chunks.
+		size_t last (std::vector<Chunk> &chunks)
+		{
+			const size_t nb = chunks.size();
+			size_t total = 0;
+			for (size_t c = 0 ; c < nb ; ++c)
+				chunks[c].counted = chunks[c].triples;
+			for (size_t c = 0 ; c < nb ; ++c) {
+				Chunk &C = chunks[c];
+				if (! _sms && total + C.triples >= _nnz) {
+					C.limit = _nnz - total;
+					C.error = GOOD;
+					return c+1;
+				}
+				if (C.error == END_OF_FILE && c+1 < nb)
+					return nb+1;
+				if (C.error == END_OF_MATRIX) {
+					C.limit = C.triples;
+					return c+1;
+				}
+				if (C.error > END_OF_MATRIX) {
+					_error = C.error;
+					_line  = lineOf(C.errpos);
+					return nb;
+				}
+				C.limit = C.triples;
+				total += C.triples;
+			}
+			// no end of matrix, or not enough entries
+			_error = END_OF_FILE;
+			_line  = lineOf(_data + _size);
+			return nb;
+		}
+
+		void shape (CSRMatrix &A, size_t nnz, size_t)
+		{
+			A.resize(_m, _n, nnz);
+			std::vector<index_t> start(_m+1);
+			for (size_t i = 0 ; i <= _m ; ++i)
+				start[i] = (index_t)_start[i];
+			A.setStart(start);
+		}
+
+		void shape (ELLMatrix &A, size_t nnz, size_t maxc)
+		{
+			A.resize(_m, _n, nnz, maxc);
+		}
+
+		void place (CSRMatrix &A, size_t i, size_t k, size_t j, const Element &x) const
+		{
+			A.setColid(_start[i]+k, j);
+			A.setData(_start[i]+k, x);
+		}
+
+		void place (ELLMatrix &A, size_t i, size_t k, size_t j, const Element &x) const
+		{
+			A.setColid(i, k, j);
+			A.setData(i, k, x);
+		}
+
+		size_t colid (const CSRMatrix &A, size_t i, size_t k) const { return A.getColid(_start[i]+k); }
+		size_t colid (const ELLMatrix &A, size_t i, size_t k) const { return A.getColid(i, k); }
+		const Element &data (const CSRMatrix &A, size_t i, size_t k) const { return A.getData(_start[i]+k); }
+		const Element &data (const ELLMatrix &A, size_t i, size_t k) const { return A.getData(i, k); }
+
+		template <class Matrix>
+		void streamRead (Matrix &A) const
+		{
+			MatrixStream<Field> ms(_field, _filename.c_str());
+			Matrix T(ms);
+			A.importe(T);
+		}
+
+		const Field         &_field;
+		std::string          _filename, _name, _short;
+		MappedFile           _file;
+		const char          *_data, *_body;
+		size_t               _size;
+		bool                 _mapped, _sms, _pattern, _symmetric;
+		size_t               _m, _n, _nnz;
+		std::vector<size_t>  _start;
+		MatrixStreamError    _error;
+		int                  _line;
+	};
+
+} // namespace LinBox
+
+#endif // __LINBOX_util_formats_mapped_sparse_reader_H
+
+// Local Variables:
+// mode: C++
+// tab-width: 8
+// indent-tabs-mode: nil
+// c-basic-offset: 8
+// End:
+// vim:sts=8:sw=8:ts=8:noet:sr:cino=>s,f0,{0,g0,(0,\:0,t0,+0,=s
@@ -0,0 +1,141 @@
+/* linbox/util/mapped-file.h
+ * Copyright (C) the LinBox group
+ *
+ * ========LICENCE========
+ * This file is part of the library LinBox.
+ *
+ * LinBox is free software: you can redistribute it and/or modify
+ * it under the terms of the  GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ * ========LICENCE========
+ *.
+ */
+
+/*! @file util/mapped-file.h
+ * @ingroup util
+ * @brief Read only view of a whole file in memory.
+ */
+
+#ifndef __LINBOX_util_mapped_file_H
+#define __LINBOX_util_mapped_file_H
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <vector>
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define __LINBOX_HAVE_MMAP
+#endif
+
+namespace LinBox
+{
+	/** A file mapped read only in memory.
+	 *
+	 * Without mmap, the file is read in a buffer instead.
+	 * The data is aligned on 8 bytes in both cases.
+	 \ingroup util
+	 */
+	class MappedFile {
+	public:
+		MappedFile () : _data(NULL), _size(0), _mapped(false) {}
+
+		explicit MappedFile (const char *filename) : _data(NULL), _size(0), _mapped(false)
+		{
+			open(filename);
+		}
+
+		~MappedFile () { close(); }
+
+		/// false if the file cannot be read or is empty.
+		bool open (const char *filename)
+		{
+			close();
+#ifdef __LINBOX_HAVE_MMAP
+			int fd = ::open(filename, O_RDONLY);
+			if (fd < 0)
+				return false;
+			struct stat st;
+			if (fstat(fd, &st) == 0 && st.st_size > 0) {
+				void *p = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+				if (p != MAP_FAILED) {
+					_data   = (const char *)p;
+					_size   = (size_t)st.st_size;
+					_mapped = true;
+				}
+			}
+			::close(fd);
+			if (_mapped)
+				return true;
+#endif
+			std::ifstream in(filename, std::ios::binary);
+			if (! in)
+				return false;
+			in.seekg(0, std::ios::end);
+			const std::streamoff len = in.tellg();
+			if (len <= 0)
+				return false;
+			in.seekg(0, std::ios::beg);
+			_buffer.resize(((size_t)len + 7) / 8);
+			if (! in.read((char *)_buffer.data(), len)) {
+				std::vector<uint64_t>().swap(_buffer);
+				return false;
+			}
+			_data = (const char *)_buffer.data();
+			_size = (size_t)len;
+			return true;
+		}
+
+		void close ()
+		{
+#ifdef __LINBOX_HAVE_MMAP
+			if (_mapped)
+				munmap((void *)_data, _size);
+#endif
+			std::vector<uint64_t>().swap(_buffer);
+			_data   = NULL;
+			_size   = 0;
+			_mapped = false;
+		}
+
+		const char *data () const { return _data; }
+		size_t size () const { return _size; }
+		bool isOpen () const { return _data != NULL; }
+
+		/// true if the pages are the ones of the file, false if it was copied.
+		bool isMapped () const { return _mapped; }
+
+	private:
+		MappedFile (const MappedFile &);
+		MappedFile &operator= (const MappedFile &);
+
+		const char           *_data;
+		size_t                _size;
+		bool                  _mapped;
+		std::vector<uint64_t> _buffer;
+	};
+
+} // namespace LinBox
+
+#endif // __LINBOX_util_mapped_file_H
+
+// vim:sts=8:sw=8:ts=8:noet:sr:cino=>s,f0,{0,g0,(0,:0,t0,+0,=s
+// Local Variables:
+// mode: C++
+// tab-width: 8
+// indent-tabs-mode: nil
+// c-basic-offset: 8
+// End:
@@ -44,6 +44,7 @@
 #include <vector>
 #include "linbox/linbox-config.h"
 #include "linbox/integer.h"
+#include "linbox/util/compressed-stream.h"
 
 namespace LinBox
 {
@@ -62,6 +63,13 @@ enum MatrixStreamError {
 
 template <class Field> class MatrixStream;
 
+/** Write the description of an error met at line \p lineNumber of a
+ * matrix in format \p format, as reported by MatrixStream::reportError.
+ */
+inline void writeMatrixStreamError( std::ostream&, MatrixStreamError,
+				    const char* func, int line,
+				    int lineNumber, const char* format );
+
 /** An abstract base class to represent readers for specific formats.
  *
  * For each format that is to be supported, make an extension of this class
@@ -210,6 +218,9 @@ class MatrixStream {
      */
 	static const int FIRST_LINE_LIMIT = 160;
 
+    /** The file opened by the constructor from a file name, NULL otherwise. */
+	CompressedInputStream* file;
+
     /** The underlying input stream from which data is being read. */
     	std::istream& in;
 
@@ -252,11 +263,21 @@ class MatrixStream {
      */
     	MatrixStream( const Field& fld, std::istream& in );
 
+    /** Constructor from a file, read through a CompressedInputStream:
+     * gzip and zstd files are decompressed on the fly.
+     * @param fld The Field used to read Elements from the matrix.
+     * @param filename The file from which to read
+     * @throws MatrixStreamError as the constructor from a stream.
+     */
+	MatrixStream( const Field& fld, const char* filename );
+
     /** Destructor */
 	~MatrixStream()
 	{
 		if (reader != NULL)
 			delete reader;
+		if (file != NULL)
+			delete file;
 	}
 
     /** Re initiliaze after one matrix has been read. */
@@ -214,7 +214,7 @@ namespace LinBox
 
 	template<class Field>
 	MatrixStream<Field>::MatrixStream(const Field& fld, std::istream& i ) :
-		reader(NULL),in(i),readAnythingYet(false),f(fld)
+		reader(NULL),file(NULL),in(i),readAnythingYet(false),f(fld)
 	{
 		init();
 		if( currentError > GOOD ){
@@ -225,6 +225,22 @@ namespace LinBox
 		}
 	}
 
+	template<class Field>
+	MatrixStream<Field>::MatrixStream(const Field& fld, const char* filename ) :
+		reader(NULL),file(new CompressedInputStream(filename)),in(*file),readAnythingYet(false),f(fld)
+	{
+		init();
+		if( currentError > GOOD ){
+#ifndef NDEBUG
+			reportError(__func__,__LINE__);
+#endif
+			if (reader != NULL)
+				delete reader;
+			delete file;
+			throw currentError;
+		}
+	}
+
 	template<class Field>
 	void MatrixStream<Field>::newmatrix()
 	{
@@ -306,31 +322,39 @@ namespace LinBox
 		return( r && c );
 	}
 
-	template<class Field>
-	MatrixStreamError MatrixStream<Field>::reportError
-	( const char* func, int line ) const
+	inline void writeMatrixStreamError
+	( std::ostream& os, MatrixStreamError error, const char* func, int line,
+	  int lineNumber, const char* format )
 	{
-		std::cerr << std::endl
+		os << std::endl
 		<< "ERROR (" << func << ":" << line << "): "
 			<< "Problem reading matrix:" << std::endl;
-		switch( getError() ) {
+		switch( error ) {
 		case END_OF_MATRIX:
-			std::cerr << "There is no more data in the matrix file.";
+			os << "There is no more data in the matrix file.";
 			break;
 		case END_OF_FILE:
-			std::cerr << "An EOF was encountered unexpectedly in reading the data.";
+			os << "An EOF was encountered unexpectedly in reading the data.";
 			break;
 		case BAD_FORMAT:
-			std::cerr << "There is a formatting error in the matrix.";
+			os << "There is a formatting error in the matrix.";
 			break;
 		case NO_FORMAT:
-			std::cerr << "The matrix format is not recognized or supported.";
+			os << "The matrix format is not recognized or supported.";
 			break;
 		case GOOD: break;
 		default: break;
 		}
-		std::cerr << std::endl << "At line number: " << lineNumber << std::endl
-		<< "Matrix format is " << getFormat() << std::endl;
+		os << std::endl << "At line number: " << lineNumber << std::endl
+		<< "Matrix format is " << format << std::endl;
+	}
+
+	template<class Field>
+	MatrixStreamError MatrixStream<Field>::reportError
+	( const char* func, int line ) const
+	{
+		writeMatrixStreamError(std::cerr, getError(), func, line,
+				       lineNumber, getFormat());
 		return currentError;
 	}
 
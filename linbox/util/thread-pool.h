@@ -0,0 +1,332 @@
+/* linbox/util/thread-pool.h
+ * Copyright (C) 2016 the LinBox group
+ *
+ * ========LICENCE========
+ * This file is part of the library LinBox.
+ *
+ * LinBox is free software: you can redistribute it and/or modify
+ * it under the terms of the  GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ * ========LICENCE========
+ */
+
+/*! @file util/thread-pool.h
+ * @ingroup util
+ * @brief Library wide work-stealing thread pool.
+ *
+ * A fixed set of persistent workers, each owning a task deque. A worker
+ * pops its own tasks in LIFO order and steals the oldest task of another
+ * worker when it runs dry. A thread waiting for a TaskGroup executes
+ * pending tasks instead of blocking, so tasks may themselves submit and
+ * wait for tasks (nested parallelism) without creating more threads than
+ * the pool has.
+ *
+ * The global pool is created on the first call to threadPool(). Its size
+ * is read from the environment variable \c LINBOX_NUM_THREADS, and
+ * defaults to the number of hardware threads. A size of 1 runs every task
+ * in the submitting thread.
+ *
+ * @code
+ * ThreadPool::TaskGroup G;
+ * for (size_t t = 0 ; t < nt ; ++t)
+ *         threadPool().run(G, [&,t]() { work(t); });
+ * threadPool().wait(G);
+ * @endcode
+ */
+
+#ifndef __LINBOX_util_thread_pool_H
+#define __LINBOX_util_thread_pool_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace LinBox
+{
+
+	/*! Work-stealing pool of persistent threads.
+	 * @ingroup util
+	 */
+	class ThreadPool {
+	public:
+		typedef std::function<void()> Task ;
+
+		/*! A set of tasks one can wait for.
+		 * The first exception thrown by a task of the group is rethrown
+		 * by ThreadPool::wait.
+		 */
+		class TaskGroup {
+		public:
+			TaskGroup() :
+				_pending(0)
+			{}
+
+			//! number of tasks not yet completed.
+			size_t pending() const
+			{
+				return _pending.load();
+			}
+
+		private:
+			friend class ThreadPool ;
+			TaskGroup(const TaskGroup&);
+			TaskGroup& operator=(const TaskGroup&);
+
+			std::atomic<size_t> _pending ;
+			std::mutex          _lock ;
+			std::exception_ptr  _error ;
+		};
+
+		/*! Pool with \p n threads of execution.
+		 * The thread calling wait() counts as one of them, so \c n-1
+		 * workers are started. \p n=0 reads \c LINBOX_NUM_THREADS.
+		 */
+		ThreadPool(size_t n = 0) :
+			_queues(0), _queued(0), _next(0), _stop(false)
+		{
+			if (n == 0)
+				n = defaultSize();
+			_size = (n == 0) ? 1 : n ;
+			_queues.resize(_size);
+			for (size_t i = 0 ; i < _size ; ++i)
+				_queues[i] = new Queue ;
+			for (size_t i = 1 ; i < _size ; ++i)
+				_workers.push_back(std::thread(&ThreadPool::work, this, i));
+		}
+
+		~ThreadPool()
+		{
+			{
+				std::lock_guard<std::mutex> guard(_sleep);
+				_stop = true ;
+			}
+			_wake.notify_all();
+			for (size_t i = 0 ; i < _workers.size() ; ++i)
+				_workers[i].join();
+			for (size_t i = 0 ; i < _queues.size() ; ++i)
+				delete _queues[i];
+		}
+
+		//! number of threads executing tasks (workers and the waiting thread).
+		size_t size() const
+		{
+			return _size ;
+		}
+
+		//! true when the calling thread is a worker of this pool.
+		bool inWorker() const
+		{
+			return self().pool == this ;
+		}
+
+		/*! Submits \p f as a task of the group \p G.
+		 * Without workers, \p f is run immediately.
+		 */
+		void run(TaskGroup & G, const Task & f)
+		{
+			if (_size == 1) {
+				execute(G,f);
+				return ;
+			}
+			++G._pending ;
+			size_t q = inWorker() ? self().index : (_next++ % _size) ;
+			{
+				std::lock_guard<std::mutex> guard(_queues[q]->lock);
+				_queues[q]->tasks.push_back(Job(&G,f));
+			}
+			++_queued ;
+			{
+				std::lock_guard<std::mutex> guard(_sleep);
+			}
+			_wake.notify_one();
+		}
+
+		/*! Waits for all the tasks of \p G.
+		 * The calling thread runs queued tasks meanwhile.
+		 */
+		void wait(TaskGroup & G)
+		{
+			size_t me = inWorker() ? self().index : 0 ;
+			while (G._pending.load() != 0) {
+				if (runOne(me))
+					continue ;
+				std::unique_lock<std::mutex> guard(_sleep);
+				if (G._pending.load() != 0 && _queued.load() == 0)
+					_wake.wait_for(guard, std::chrono::microseconds(200));
+			}
+			if (G._error) {
+				std::exception_ptr e = G._error ;
+				G._error = std::exception_ptr();
+				std::rethrow_exception(e);
+			}
+		}
+
+		/*! Runs one queued task in the calling thread, if there is one.
+		 * A thread waiting for something else than a TaskGroup calls it
+		 * to help the pool instead of blocking a worker.
+		 * @return false when no task was queued.
+		 */
+		bool runPending()
+		{
+			return runOne(inWorker() ? self().index : 0);
+		}
+
+		/*! Calls \p f(i) for \p i in <code>[begin,end)</code>, one task per index.
+		 * The last index is run by the calling thread.
+		 */
+		template<class Func>
+		void parallelFor(size_t begin, size_t end, const Func & f)
+		{
+			if (begin >= end)
+				return ;
+			TaskGroup G ;
+			for (size_t i = begin ; i+1 < end ; ++i)
+				run(G, [&f,i]() { f(i); });
+			execute(G, [&f,end]() { f(end-1); });
+			wait(G);
+		}
+
+	private:
+		struct Job {
+			TaskGroup * group ;
+			Task        task ;
+			Job(TaskGroup * g, const Task & t) :
+				group(g), task(t)
+			{}
+		};
+
+		struct Queue {
+			std::mutex       lock ;
+			std::deque<Job>  tasks ;
+		};
+
+		struct Self {
+			const ThreadPool * pool ;
+			size_t             index ;
+		};
+
+		static Self & self()
+		{
+			static thread_local Self s = { NULL, 0 };
+			return s ;
+		}
+
+		static size_t defaultSize()
+		{
+			const char * env = std::getenv("LINBOX_NUM_THREADS");
+			if (env != NULL) {
+				long n = std::atol(env);
+				if (n > 0)
+					return (size_t)n ;
+			}
+			return std::thread::hardware_concurrency();
+		}
+
+		void execute(TaskGroup & G, const Task & f)
+		{
+			try {
+				f();
+			}
+			catch (...) {
+				std::lock_guard<std::mutex> guard(G._lock);
+				if (!G._error)
+					G._error = std::current_exception();
+			}
+		}
+
+		//! pops from \p me first, then steals from the others.
+		bool runOne(size_t me)
+		{
+			if (_queued.load() == 0)
+				return false ;
+			for (size_t k = 0 ; k < _size ; ++k) {
+				Queue & Q = *_queues[(me+k) % _size] ;
+				std::unique_lock<std::mutex> guard(Q.lock);
+				if (Q.tasks.empty())
+					continue ;
+				Job J(NULL,Task());
+				if (k == 0) {
+					J = Q.tasks.back();
+					Q.tasks.pop_back();
+				}
+				else {
+					J = Q.tasks.front();
+					Q.tasks.pop_front();
+				}
+				guard.unlock();
+				--_queued ;
+				execute(*J.group, J.task);
+				if (--J.group->_pending == 0) {
+					{
+						std::lock_guard<std::mutex> sleeper(_sleep);
+					}
+					_wake.notify_all();
+				}
+				return true ;
+			}
+			return false ;
+		}
+
+		void work(size_t index)
+		{
+			self().pool  = this ;
+			self().index = index ;
+			for (;;) {
+				if (runOne(index))
+					continue ;
+				std::unique_lock<std::mutex> guard(_sleep);
+				if (_stop)
+					return ;
+				if (_queued.load() == 0)
+					_wake.wait(guard);
+			}
+		}
+
+		ThreadPool(const ThreadPool&);
+		ThreadPool& operator=(const ThreadPool&);
+
+		size_t                    _size ;
+		std::vector<Queue*>       _queues ;
+		std::vector<std::thread>  _workers ;
+		std::atomic<size_t>       _queued ;
+		std::atomic<size_t>       _next ;
+		std::mutex                _sleep ;
+		std::condition_variable   _wake ;
+		bool                      _stop ;
+	};
+
+	//! The library wide pool.
+	inline ThreadPool & threadPool()
+	{
+		static ThreadPool internal_static_pool ;
+		return internal_static_pool ;
+	}
+
+}
+
+#endif // __LINBOX_util_thread_pool_H
+
+// vim:sts=8:sw=8:ts=8:noet:sr:cino=>s,f0,{0,g0,(0,:0,t0,+0,=s
+// Local Variables:
+// mode: C++
+// tab-width: 8
+// indent-tabs-mode: nil
+// c-basic-offset: 8
+// End:
@@ -0,0 +1,198 @@
+/* linbox/vector/sparse-row-pool.h
+ * Copyright (C) the LinBox group
+ *
+ * ========LICENCE========
+ * This file is part of the library LinBox.
+ *
+ * LinBox is free software: you can redistribute it and/or modify
+ * it under the terms of the  GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ * ========LICENCE========
+ *.
+ */
+
+/*! @file vector/sparse-row-pool.h
+ * @ingroup vector
+ * @brief Recycling of the storage of sparse rows during elimination.
+ */
+
+#ifndef __LINBOX_sparse_row_pool_H
+#define __LINBOX_sparse_row_pool_H
+
+#include <vector>
+#include <utility>
+#include <ostream>
+#include <cstddef>
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+
+#ifndef __LINBOX_SPARSE_ROW_POOL_MAX_BYTES__
+/// Bytes kept by a row pool before released rows are freed.
+#define __LINBOX_SPARSE_ROW_POOL_MAX_BYTES__ (size_t(1) << 26)
+#endif
+
+namespace LinBox
+{
+	/** Pool of row buffers, sorted by size classes.
+	 *
+	 * A row of capacity c lies in class floor(log2(c)); a request for n
+	 * entries is served by the classes ceil(log2(n)) and the next one,
+	 * so that a recycled row is less than eight times too large.
+	 * Each elimination step builds its new row in an acquired buffer,
+	 * swaps it with the old row and releases the old storage, which the
+	 * next steps reuse instead of allocating.
+	 * \p Vector is a std::vector like container (capacity, reserve, swap).
+	 */
+	template <class Vector>
+	class SparseRowPool {
+	public:
+		typedef typename Vector::value_type value_type;
+
+		SparseRowPool (size_t maxBytes = __LINBOX_SPARSE_ROW_POOL_MAX_BYTES__) :
+			_maxBytes(maxBytes), _bytes(0)
+		{
+			resetCounts();
+		}
+
+		/// \p v gets a buffer of at least \p n entries, resized to \p n.
+		void acquire (Vector &v, size_t n)
+		{
+			const size_t c = ceilLog2(n);
+			for (size_t d = c ; d < c+2 && d < _free.size() ; ++d)
+				if (! _free[d].empty()) {
+					std::swap(v, _free[d].back());
+					_free[d].pop_back();
+					_bytes -= v.capacity() * sizeof(value_type);
+					++_reuses;
+					v.resize(n);
+					return;
+				}
+			++_allocations;
+			Vector w;
+			w.reserve(size_t(1) << c);
+			std::swap(v, w);
+			v.resize(n);
+		}
+
+		/// The storage of \p v goes back to the pool, \p v is left empty.
+		void release (Vector &v)
+		{
+			const size_t cap = v.capacity();
+			Vector w;
+			std::swap(v, w);
+			if (cap == 0)
+				return;
+			const size_t bytes = cap * sizeof(value_type);
+			if (_bytes + bytes > _maxBytes) {
+				++_dropped;
+				return;
+			}
+			const size_t c = floorLog2(cap);
+			if (c >= _free.size())
+				_free.resize(c+1);
+			w.clear();
+			_free[c].push_back(Vector());
+			std::swap(_free[c].back(), w);
+			_bytes += bytes;
+			if (_bytes > _peakBytes)
+				_peakBytes = _bytes;
+		}
+
+		/// \p row takes the content of \p buf, its old storage is released.
+		void replace (Vector &row, Vector &buf)
+		{
+			std::swap(row, buf);
+			release(buf);
+		}
+
+		/// Frees all the pooled rows.
+		void trim ()
+		{
+			_free.clear();
+			_bytes = 0;
+		}
+
+		void resetCounts ()
+		{
+			_allocations = _reuses = _dropped = 0;
+			_peakBytes = _bytes;
+		}
+
+		size_t allocations () const { return _allocations; }
+		size_t reuses () const { return _reuses; }
+		size_t dropped () const { return _dropped; }
+		size_t pooledBytes () const { return _bytes; }
+		size_t peakPooledBytes () const { return _peakBytes; }
+
+		std::ostream &write (std::ostream &os) const
+		{
+			return os << "Row pool : " << _allocations << " allocations, "
+			<< _reuses << " reuses, " << _dropped << " dropped, peak "
+			<< (_peakBytes >> 10) << " kB pooled";
+		}
+
+	private:
+		static size_t floorLog2 (size_t n)
+		{
+			size_t c = 0;
+			while (n >>= 1) ++c;
+			return c;
+		}
+
+		static size_t ceilLog2 (size_t n)
+		{
+			return (n <= 1) ? 0 : floorLog2(n-1) + 1;
+		}
+
+		std::vector<std::vector<Vector> > _free;
+		size_t _maxBytes, _bytes, _peakBytes;
+		size_t _allocations, _reuses, _dropped;
+	};
+
+	/// The row pool of the calling thread.
+	template <class Vector>
+	SparseRowPool<Vector> &sparseRowPool ()
+	{
+		static thread_local SparseRowPool<Vector> pool;
+		return pool;
+	}
+
+	/// Peak resident set size of the process in kB, 0 when unknown.
+	inline size_t peakResidentSetSize ()
+	{
+#if defined(__unix__) || defined(__APPLE__)
+		struct rusage ru;
+		if (getrusage(RUSAGE_SELF, &ru) != 0)
+			return 0;
+#ifdef __APPLE__
+		return (size_t)ru.ru_maxrss >> 10;
+#else
+		return (size_t)ru.ru_maxrss;
+#endif
+#else
+		return 0;
+#endif
+	}
+
+} // namespace LinBox
+
+#endif // __LINBOX_sparse_row_pool_H
+
+// vim:sts=8:sw=8:ts=8:noet:sr:cino=>s,f0,{0,g0,(0,:0,t0,+0,=s
+// Local Variables:
+// mode: C++
+// tab-width: 8
+// indent-tabs-mode: nil
+// c-basic-offset: 8
+// End: